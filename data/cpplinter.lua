@@ -36,7 +36,7 @@ DBTransaction = {}
 ---@field query fun(query: string): any
 ---@field storeQuery fun(query: string): any
 ---@field escapeString fun(value: string): string
----@field asyncQuery fun(query: string): boolean
+---@field asyncQuery fun(query: string, callback?: function, key?: number): boolean
 db = {}
 
 ---@class result
@@ -94,6 +94,9 @@ configManager = {}
 ---@field createMonsterType fun(name: string): MonsterType
 ---@field startEvent fun(eventName: string): boolean
 ---@field getClientVersion fun(): string
+---@field getProfile fun(): table<string, boolean|table<string|integer, table<string, number>>>
+---@field resetProfile fun(): boolean
+---@field setProfilerEnabled fun(enabled: boolean): boolean
 ---@field reload fun(reloadType: number): boolean
 Game = {}
 
@@ -450,7 +453,7 @@ Creature = {}
 ---@field hasLearnedSpell fun(self: Player, spellId: number): boolean
 ---@field sendTutorial fun(self: Player, tutorialId: number)
 ---@field addMapMark fun(self: Player, position: Position, type: number, description?: string)
----@field save fun(self: Player)
+---@field save fun(self: Player, callback?: fun(saved: boolean)): boolean
 ---@field popupFYI fun(self: Player, message: string)
 ---@field isPzLocked fun(self: Player): boolean
 ---@field getClient fun(self: Player): table
@@ -0,0 +1,71 @@
+local talk = TalkAction("/profile")
+
+local scrollId = 1949
+local maxEvents = 15
+
+local function sortByTotal(statsByName)
+	local entries = {}
+	for name, stats in pairs(statsByName) do
+		if stats.count > 0 then
+			entries[#entries + 1] = {name = name, stats = stats}
+		end
+	end
+	table.sort(entries, function(a, b) return a.stats.total > b.stats.total end)
+	return entries
+end
+
+local function formatEntry(entry)
+	local stats = entry.stats
+	return string.format("%s: %d x %.3f ms = %.0f ms, p99 %.3f ms, max %.1f ms",
+		entry.name, stats.count, stats.average, stats.total, stats.p99, stats.max)
+end
+
+function talk.onSay(player, words, param)
+	if not player:getGroup():getAccess() then
+		return true
+	end
+
+	if player:getAccountType() < ACCOUNT_TYPE_GOD then
+		return false
+	end
+
+	logCommand(player, words, param)
+
+	param = param:trim():lower()
+	if param == "on" or param == "off" then
+		Game.setProfilerEnabled(param == "on")
+		player:sendTextMessage(MESSAGE_INFO_DESCR, "Profiler " .. (param == "on" and "enabled." or "disabled."))
+		return false
+	elseif param == "reset" then
+		Game.resetProfile()
+		player:sendTextMessage(MESSAGE_INFO_DESCR, "Profile reset.")
+		return false
+	end
+
+	local profile = Game.getProfile()
+	local lines = {"Sections" .. (profile.enabled and "" or " (profiler disabled)") .. ":"}
+	for _, entry in ipairs(sortByTotal(profile.sections)) do
+		lines[#lines + 1] = formatEntry(entry)
+	end
+
+	lines[#lines + 1] = ""
+	lines[#lines + 1] = "Lua events:"
+	for i, entry in ipairs(sortByTotal(profile.events)) do
+		if i > maxEvents then
+			break
+		end
+		lines[#lines + 1] = formatEntry(entry)
+	end
+
+	lines[#lines + 1] = ""
+	lines[#lines + 1] = "Creature buckets:"
+	for i, stats in ipairs(profile.creatureBuckets) do
+		lines[#lines + 1] = formatEntry({name = string.format("%d (%d creatures)", i, stats.creatures), stats = stats})
+	end
+
+	player:showTextDialog(scrollId, table.concat(lines, "\n"))
+	return false
+end
+
+talk:separator(" ")
+talk:register()
@@ -25,11 +25,14 @@ const std::optional<BanInfo> getAccountBanInfo(uint32_t accountId)
 	time_t expiresAt = result->getNumber<time_t>("expires_at");
 	if (expiresAt != 0 && std::chrono::system_clock::now() > std::chrono::system_clock::from_time_t(expiresAt)) {
 		// Move the ban to history if it has expired
-		g_databaseTasks.addTask(fmt::format(
-		    "INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})",
-		    accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt,
-		    result->getNumber<uint32_t>("banned_by")));
-		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+		g_databaseTasks.addTask(
+		    fmt::format(
+		        "INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})",
+		        accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"),
+		        expiresAt, result->getNumber<uint32_t>("banned_by")),
+		    nullptr, false, accountId);
+		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId), nullptr,
+		                        false, accountId);
 		return std::nullopt;
 	}
 
@@ -0,0 +1,1160 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Headless bots that log in to a running server through the login and game protocols the way the client does, then
+// walk, talk and attack until the time is up. Reports how long logging in took and the round trip of everything the
+// bots say, from sending it until the server broadcasts it back, which covers the network threads, the dispatcher and
+// the output flush. How long the server ticks took meanwhile is read from its tick histogram at GET /metrics, before
+// and after the bots play.
+//   bench_bots run [bots] [seconds] [trace]   plays, and records the packets every bot sends to trace
+//   bench_bots replay <trace> [bots]          sends the recorded packets again, with the recorded timing
+//   bench_bots sql [bots]                     prints the accounts and characters the bots log in with
+//
+// Start a server on this machine with ip = "127.0.0.1" and a database created from schema.sql, any MariaDB will do
+// (docker run -e MARIADB_ROOT_PASSWORD=... -p 3306:3306 mariadb), and import the output of bench_bots sql into it.
+// The bots read key.pem from the working directory. Every bot connects from its own 127.x.y.z address, so the
+// connection flood protection does not turn them away, and maxMessageBuffer = 0 keeps the server from muting them.
+// Tick times are only reported with profiler = true, httpMetrics = true and the default httpPort.
+
+#include "../otpch.h"
+
+#include "../enums.h"
+#include "../profiler.h"
+#include "../tools.h"
+#include "../xtea.h"
+
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/empty_body.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/http/write.hpp>
+#include <fstream>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <span>
+#include <zlib.h>
+
+namespace {
+
+constexpr uint16_t LOGIN_PORT = 7171;
+constexpr uint16_t METRICS_PORT = 8080;
+constexpr uint16_t CLIENT_VERSION = CLIENT_VERSION_MAX;
+// a QT client, the server numbers its packets to it and compresses the large ones
+constexpr uint16_t CLIENT_OS = CLIENTOS_QT_WINDOWS;
+constexpr std::string_view BOT_PASSWORD = "bot";
+constexpr size_t RSA_BLOCK_LENGTH = 128;
+
+// bots do one thing at a time, every ACTION_INTERVAL, and start LOGIN_SPACING after each other
+constexpr auto ACTION_INTERVAL = std::chrono::milliseconds(250);
+constexpr auto LOGIN_SPACING = std::chrono::milliseconds(10);
+constexpr uint32_t WALK_TICKS = 4;
+constexpr uint32_t SAY_TICKS = 12;
+constexpr uint32_t ATTACK_TICKS = 20;
+constexpr uint32_t PONG_TICKS = 20;
+
+// what a bot said and did not hear back within this long is counted as lost
+constexpr auto TOKEN_TIMEOUT = std::chrono::seconds(10);
+
+constexpr std::string_view TRACE_MAGIC = "TFSTRACE";
+
+using Clock = std::chrono::steady_clock;
+using boost::asio::ip::tcp;
+
+struct Deleter
+{
+	void operator()(BIO* bio) const { BIO_free(bio); }
+	void operator()(EVP_PKEY* pkey) const { EVP_PKEY_free(pkey); }
+	void operator()(EVP_PKEY_CTX* ctx) const { EVP_PKEY_CTX_free(ctx); }
+};
+
+template <class T>
+using C_ptr = std::unique_ptr<T, Deleter>;
+
+// the public half of key.pem, the client encrypts the first packet with it
+class ServerKey
+{
+public:
+	explicit ServerKey(const std::string& path)
+	{
+		std::ifstream file{path};
+		const std::string pem{std::istreambuf_iterator<char>{file}, {}};
+
+		C_ptr<BIO> bio{BIO_new_mem_buf(pem.data(), static_cast<int>(pem.size()))};
+		pkey.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+	}
+
+	bool isLoaded() const { return pkey != nullptr; }
+
+	// raw RSA, every block starts with a zero byte so it is smaller than the modulus
+	void encrypt(uint8_t* block) const
+	{
+		C_ptr<EVP_PKEY_CTX> ctx{EVP_PKEY_CTX_new(pkey.get(), nullptr)};
+		EVP_PKEY_encrypt_init(ctx.get());
+		EVP_PKEY_CTX_set_rsa_padding(ctx.get(), RSA_NO_PADDING);
+
+		std::array<uint8_t, RSA_BLOCK_LENGTH> encrypted;
+		size_t length = encrypted.size();
+		EVP_PKEY_encrypt(ctx.get(), encrypted.data(), &length, block, RSA_BLOCK_LENGTH);
+		std::copy(encrypted.begin(), encrypted.end(), block);
+	}
+
+private:
+	C_ptr<EVP_PKEY> pkey;
+};
+
+struct PacketWriter
+{
+	void addByte(uint8_t value) { bytes.push_back(value); }
+
+	template <typename T>
+	void add(T value)
+	{
+		const auto* data = reinterpret_cast<const uint8_t*>(&value);
+		bytes.insert(bytes.end(), data, data + sizeof(T));
+	}
+
+	void addString(std::string_view value)
+	{
+		add<uint16_t>(value.size());
+		bytes.insert(bytes.end(), value.begin(), value.end());
+	}
+
+	// zero bytes up to size, to fill RSA blocks
+	void padTo(size_t size) { bytes.resize(size, 0); }
+
+	std::vector<uint8_t> bytes;
+};
+
+class PacketReader
+{
+public:
+	explicit PacketReader(std::span<const uint8_t> data) : data(data) {}
+
+	uint8_t getByte() { return canRead(1) ? data[position++] : 0; }
+
+	template <typename T>
+	T get()
+	{
+		T value{};
+		if (canRead(sizeof(T))) {
+			std::memcpy(&value, data.data() + position, sizeof(T));
+			position += sizeof(T);
+		}
+		return value;
+	}
+
+	std::string_view getString()
+	{
+		const uint16_t length = get<uint16_t>();
+		if (!canRead(length)) {
+			return {};
+		}
+
+		const std::string_view value{reinterpret_cast<const char*>(data.data() + position), length};
+		position += length;
+		return value;
+	}
+
+	bool isOverrun() const { return overrun; }
+
+private:
+	bool canRead(size_t size)
+	{
+		if (position + size > data.size()) {
+			overrun = true;
+		}
+		return !overrun;
+	}
+
+	std::span<const uint8_t> data;
+	size_t position = 0;
+	bool overrun = false;
+};
+
+class Inflater
+{
+public:
+	Inflater() { inflateInit2(&stream, -MAX_WBITS); }
+	~Inflater() { inflateEnd(&stream); }
+
+	// non-copyable
+	Inflater(const Inflater&) = delete;
+	Inflater& operator=(const Inflater&) = delete;
+
+	// every packet is deflated on its own, raw, the way the server compresses them
+	bool inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+	{
+		inflateReset(&stream);
+		stream.next_in = const_cast<uint8_t*>(data);
+		stream.avail_in = size;
+
+		out.resize(NETWORKMESSAGE_MAXSIZE);
+		size_t produced = 0;
+		while (true) {
+			stream.next_out = out.data() + produced;
+			stream.avail_out = out.size() - produced;
+
+			const int result = ::inflate(&stream, Z_FINISH);
+			produced = out.size() - stream.avail_out;
+			if (result == Z_STREAM_END) {
+				out.resize(produced);
+				return true;
+			}
+
+			if ((result != Z_OK && result != Z_BUF_ERROR) || stream.avail_out != 0) {
+				return false;
+			}
+			out.resize(out.size() * 2);
+		}
+	}
+
+private:
+	z_stream stream{};
+};
+
+struct TraceRecord
+{
+	uint32_t bot;
+	// milliseconds since the bot entered the game
+	uint32_t time;
+	std::vector<uint8_t> payload;
+};
+
+using Script = std::vector<TraceRecord>;
+
+std::vector<Script> loadTrace(const std::string& path)
+{
+	std::ifstream file{path, std::ios::binary};
+	std::string magic(TRACE_MAGIC.size(), '\0');
+	if (!file.read(magic.data(), magic.size()) || magic != TRACE_MAGIC) {
+		return {};
+	}
+
+	std::map<uint32_t, Script> scripts;
+	TraceRecord record;
+	uint16_t size;
+	while (file.read(reinterpret_cast<char*>(&record.bot), sizeof(record.bot)) &&
+	       file.read(reinterpret_cast<char*>(&record.time), sizeof(record.time)) &&
+	       file.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+		record.payload.resize(size);
+		if (!file.read(reinterpret_cast<char*>(record.payload.data()), size)) {
+			break;
+		}
+		scripts[record.bot].push_back(record);
+	}
+
+	std::vector<Script> result;
+	for (auto& [bot, script] : scripts) {
+		result.push_back(std::move(script));
+	}
+	return result;
+}
+
+bool saveTrace(const std::string& path, const std::vector<TraceRecord>& records)
+{
+	std::ofstream file{path, std::ios::binary};
+	file.write(TRACE_MAGIC.data(), TRACE_MAGIC.size());
+	for (const TraceRecord& record : records) {
+		const uint16_t size = record.payload.size();
+		file.write(reinterpret_cast<const char*>(&record.bot), sizeof(record.bot));
+		file.write(reinterpret_cast<const char*>(&record.time), sizeof(record.time));
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(reinterpret_cast<const char*>(record.payload.data()), size);
+	}
+	return static_cast<bool>(file);
+}
+
+class Bot;
+
+// what the bots share, and what they report when they are done
+class Swarm
+{
+public:
+	Swarm(const ServerKey& key, size_t bots, Clock::time_point deadline, bool recording, std::vector<Script> scripts) :
+	    key(key), deadline(deadline), recording(recording), scripts(std::move(scripts)), creatureIds(bots)
+	{}
+
+	const ServerKey& key;
+	const Clock::time_point deadline;
+	const bool recording;
+	const std::vector<Script> scripts;
+
+	void setCreatureId(size_t bot, uint32_t id) { creatureIds[bot].store(id, std::memory_order_relaxed); }
+
+	// another bot to attack, 0 if none has entered the game yet
+	uint32_t getTarget(size_t bot, uint32_t random) const
+	{
+		const uint32_t id = creatureIds[random % creatureIds.size()].load(std::memory_order_relaxed);
+		return random % creatureIds.size() == bot ? 0 : id;
+	}
+
+	void fail(size_t bot, std::string_view reason)
+	{
+		std::lock_guard lock{mutex};
+		if (++failed <= 10) {
+			fmt::print(stderr, "bot {:d}: {:s}\n", bot, reason);
+		}
+	}
+
+	void report(const Bot& bot);
+	void print(double elapsed);
+
+	const std::vector<TraceRecord>& getTrace() const { return trace; }
+
+private:
+	std::vector<std::atomic<uint32_t>> creatureIds;
+
+	std::mutex mutex;
+	size_t failed = 0;
+	size_t entered = 0;
+	uint64_t packetsSent = 0;
+	uint64_t framesReceived = 0;
+	uint64_t bytesReceived = 0;
+	uint64_t lostTokens = 0;
+	std::vector<uint32_t> loginTimes;
+	std::vector<uint32_t> roundTrips;
+	std::vector<TraceRecord> trace;
+};
+
+class Bot : public std::enable_shared_from_this<Bot>
+{
+public:
+	Bot(boost::asio::io_context& io_context, Swarm& swarm, size_t index) :
+	    strand(boost::asio::make_strand(io_context)),
+	    socket(strand),
+	    timer(strand),
+	    swarm(swarm),
+	    index(index),
+	    generator(static_cast<uint32_t>(index)),
+	    script(swarm.scripts.empty() ? nullptr : &swarm.scripts[index % swarm.scripts.size()])
+	{
+		for (uint32_t& part : key) {
+			part = generator();
+		}
+		roundKeys = xtea::expand_key(key);
+
+		// 127.0.0.0/8 is loopback, a distinct address per bot keeps every address under the flood protection
+		const auto block = static_cast<uint32_t>(index / 250);
+		address = boost::asio::ip::address_v4{(127u << 24) | (block / 256 % 256) << 16 | (block % 256) << 8 |
+		                                      static_cast<uint32_t>(index % 250 + 1)};
+	}
+
+	void start()
+	{
+		timer.expires_after(LOGIN_SPACING * index);
+		timer.async_wait([thisPtr = shared_from_this()](const boost::system::error_code& error) {
+			if (!error) {
+				thisPtr->startedAt = Clock::now();
+				thisPtr->connect({boost::asio::ip::address_v4::loopback(), LOGIN_PORT}, &Bot::sendLogin);
+			}
+		});
+	}
+
+private:
+	enum class State
+	{
+		LOGIN,
+		CHALLENGE,
+		ENTERING,
+		PLAYING,
+		LOGOUT,
+		DONE,
+	};
+
+	friend class Swarm;
+
+	void connect(const tcp::endpoint& endpoint, void (Bot::*onConnected)())
+	{
+		boost::system::error_code error;
+		socket.close(error);
+		socket.open(tcp::v4(), error);
+		if (!error) {
+			socket.bind({address, 0}, error);
+		}
+		if (error) {
+			fail(fmt::format("could not bind {:s}: {:s}", address.to_string(), error.message()));
+			return;
+		}
+
+		socket.async_connect(endpoint, [thisPtr = shared_from_this(), onConnected](const boost::system::error_code& error) {
+			if (error) {
+				thisPtr->fail(fmt::format("could not connect: {:s}", error.message()));
+				return;
+			}
+			((*thisPtr).*onConnected)();
+			thisPtr->readFrame();
+		});
+	}
+
+	// the first packet to the login server, [length][checksum][protocol][client][RSA: key, account][RSA: token]
+	void sendLogin()
+	{
+		PacketWriter packet;
+		packet.add<uint16_t>(0);
+		packet.add<uint32_t>(0);
+		packet.addByte(0x01);
+		packet.add<uint16_t>(CLIENT_OS);
+		packet.add<uint16_t>(CLIENT_VERSION);
+		packet.add<uint32_t>(CLIENT_VERSION);
+		packet.add<uint32_t>(0); // dat signature
+		packet.add<uint32_t>(0); // spr signature
+		packet.add<uint32_t>(0); // pic signature
+		packet.addByte(0);
+
+		const size_t rsaStart = packet.bytes.size();
+		packet.addByte(0);
+		for (uint32_t part : key) {
+			packet.add<uint32_t>(part);
+		}
+		packet.addString(fmt::format("bot{:d}", index));
+		packet.addString(BOT_PASSWORD);
+		packet.padTo(rsaStart + RSA_BLOCK_LENGTH);
+
+		packet.addByte(0);
+		packet.addString(""); // authenticator token
+		packet.padTo(rsaStart + 2 * RSA_BLOCK_LENGTH);
+
+		swarm.key.encrypt(packet.bytes.data() + rsaStart);
+		swarm.key.encrypt(packet.bytes.data() + rsaStart + RSA_BLOCK_LENGTH);
+		writeRaw(std::move(packet.bytes));
+	}
+
+	void onLoginReply(const std::vector<uint8_t>& payload)
+	{
+		PacketReader reader{payload};
+		std::string session;
+		std::map<uint8_t, tcp::endpoint> worlds;
+		while (!reader.isOverrun()) {
+			switch (reader.getByte()) {
+				case 0x0A:
+				case 0x0B:
+					fail(fmt::format("login refused: {:s}", reader.getString()));
+					return;
+				case 0x0C:
+					reader.getByte();
+					break;
+				case 0x0D:
+					fail("the account has an authenticator");
+					return;
+				case 0x28:
+					session = reader.getString();
+					break;
+				case 0x64: {
+					for (uint8_t i = 0, count = reader.getByte(); i < count; ++i) {
+						const uint8_t world = reader.getByte();
+						reader.getString(); // name
+						const std::string ip{reader.getString()};
+						const uint16_t port = reader.getByte() | reader.getByte() << 8;
+						reader.getByte(); // preview state
+
+						boost::system::error_code error;
+						const auto worldAddress = boost::asio::ip::make_address(ip, error);
+						if (!error) {
+							worlds.emplace(world, tcp::endpoint{worldAddress, port});
+						}
+					}
+
+					if (reader.getByte() == 0) {
+						fail("the account has no character");
+						return;
+					}
+
+					const uint8_t world = reader.getByte();
+					characterName = reader.getString();
+					auto it = worlds.find(world);
+					if (session.empty() || it == worlds.end()) {
+						fail("incomplete character list");
+						return;
+					}
+
+					sessionKey = std::move(session);
+					state = State::CHALLENGE;
+					connect(it->second, &Bot::waitForChallenge);
+					return;
+				}
+				default:
+					fail("unexpected character list");
+					return;
+			}
+		}
+		fail("incomplete character list");
+	}
+
+	void waitForChallenge() {}
+
+	// [length][checksum][0x0006][0x1F][timestamp][random], unencrypted
+	void onChallenge(const std::vector<uint8_t>& frame)
+	{
+		if (frame.size() < 12 || frame[6] != 0x1F) {
+			fail("no login challenge");
+			return;
+		}
+
+		uint32_t timestamp;
+		std::memcpy(&timestamp, frame.data() + 7, sizeof(timestamp));
+		const uint8_t random = frame[11];
+
+		PacketWriter packet;
+		packet.add<uint16_t>(0);
+		packet.add<uint32_t>(0);
+		packet.addByte(0x0A);
+		packet.add<uint16_t>(CLIENT_OS);
+		packet.add<uint16_t>(CLIENT_VERSION);
+		packet.add<uint32_t>(CLIENT_VERSION);
+		packet.addString(CLIENT_VERSION_STR);
+		packet.add<uint16_t>(0); // dat revision
+		packet.addByte(0);       // preview state
+
+		const size_t rsaStart = packet.bytes.size();
+		packet.addByte(0);
+		for (uint32_t part : key) {
+			packet.add<uint32_t>(part);
+		}
+		packet.addByte(0); // gamemaster flag
+		packet.addString(sessionKey);
+		packet.addString(characterName);
+		packet.add<uint32_t>(timestamp);
+		packet.addByte(random);
+		packet.padTo(rsaStart + RSA_BLOCK_LENGTH);
+
+		swarm.key.encrypt(packet.bytes.data() + rsaStart);
+		writeRaw(std::move(packet.bytes));
+		state = State::ENTERING;
+	}
+
+	void onGameFrame(const std::vector<uint8_t>& payload)
+	{
+		const auto now = Clock::now();
+		if (state == State::ENTERING) {
+			if (!payload.empty() && payload[0] == 0x14) {
+				PacketReader reader{std::span{payload}.subspan(1)};
+				fail(fmt::format("game login refused: {:s}", reader.getString()));
+				return;
+			}
+			if (!payload.empty() && payload[0] == 0x16) {
+				fail("sent to the waiting list");
+				return;
+			}
+
+			state = State::PLAYING;
+			enteredAt = now;
+			loginTime = std::chrono::duration_cast<std::chrono::microseconds>(now - startedAt).count();
+			if (script) {
+				replayNext();
+			} else {
+				act();
+			}
+		}
+
+		++framesReceived;
+		bytesReceived += payload.size();
+
+		if (creatureId == 0) {
+			findCreatureId(payload);
+		}
+
+		const std::string_view text{reinterpret_cast<const char*>(payload.data()), payload.size()};
+		for (auto it = pendingTokens.begin(); it != pendingTokens.end();) {
+			if (text.find(it->first) != std::string_view::npos) {
+				roundTrips.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - it->second).count());
+				it = pendingTokens.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	// the client features message, [0x17][id][beat duration 50], comes with the first packets of the game
+	void findCreatureId(const std::vector<uint8_t>& payload)
+	{
+		for (size_t i = 0; i + 7 <= payload.size(); ++i) {
+			if (payload[i] == 0x17 && (payload[i + 4] & 0xF0) == 0x10 && payload[i + 5] == 50 &&
+			    payload[i + 6] == 0) {
+				std::memcpy(&creatureId, payload.data() + i + 1, sizeof(creatureId));
+				swarm.setCreatureId(index, creatureId);
+				return;
+			}
+		}
+	}
+
+	void act()
+	{
+		if (Clock::now() >= swarm.deadline) {
+			logout();
+			return;
+		}
+
+		++ticks;
+		if ((ticks + index) % WALK_TICKS == 0) {
+			sendAction({static_cast<uint8_t>(0x65 + generator() % 4)});
+		} else if ((ticks + index) % SAY_TICKS == 1) {
+			sendAction(makeSay());
+		} else if ((ticks + index) % ATTACK_TICKS == 2) {
+			if (auto attack = makeAttack(); !attack.empty()) {
+				sendAction(std::move(attack));
+			}
+		} else if ((ticks + index) % PONG_TICKS == 3) {
+			// answers the pings of the server, it logs out players that stay silent
+			sendAction({0x1E});
+		}
+
+		expireTokens();
+		timer.expires_after(ACTION_INTERVAL);
+		timer.async_wait([thisPtr = shared_from_this()](const boost::system::error_code& error) {
+			if (!error) {
+				thisPtr->act();
+			}
+		});
+	}
+
+	void replayNext()
+	{
+		if (replayed == script->size() || Clock::now() >= swarm.deadline) {
+			logout();
+			return;
+		}
+
+		const TraceRecord& record = (*script)[replayed];
+		timer.expires_at(enteredAt + std::chrono::milliseconds(record.time));
+		timer.async_wait([thisPtr = shared_from_this()](const boost::system::error_code& error) {
+			if (error) {
+				return;
+			}
+
+			// what the bots say and whom they attack changes with every run, the rest is sent as it was
+			const auto& payload = (*thisPtr->script)[thisPtr->replayed++].payload;
+			if (payload.size() > 1 && payload[0] == 0x96 && payload[1] == TALKTYPE_SAY) {
+				thisPtr->sendAction(thisPtr->makeSay());
+			} else if (!payload.empty() && payload[0] == 0xA1) {
+				if (auto attack = thisPtr->makeAttack(); !attack.empty()) {
+					thisPtr->sendAction(std::move(attack));
+				}
+			} else {
+				thisPtr->sendAction(payload);
+			}
+
+			thisPtr->expireTokens();
+			thisPtr->replayNext();
+		});
+	}
+
+	std::vector<uint8_t> makeSay()
+	{
+		std::string token = fmt::format("bot{:d}x{:d}", index, ++tokenSequence);
+
+		PacketWriter packet;
+		packet.addByte(0x96);
+		packet.addByte(TALKTYPE_SAY);
+		packet.addString(token);
+
+		pendingTokens.emplace_back(std::move(token), Clock::now());
+		return std::move(packet.bytes);
+	}
+
+	std::vector<uint8_t> makeAttack()
+	{
+		const uint32_t target = swarm.getTarget(index, generator());
+		if (target == 0) {
+			return {};
+		}
+
+		PacketWriter packet;
+		packet.addByte(0xA1);
+		packet.add<uint32_t>(target);
+		packet.add<uint32_t>(target);
+		return std::move(packet.bytes);
+	}
+
+	void expireTokens()
+	{
+		const auto expired = Clock::now() - TOKEN_TIMEOUT;
+		while (!pendingTokens.empty() && pendingTokens.front().second < expired) {
+			pendingTokens.pop_front();
+			++lostTokens;
+		}
+	}
+
+	void logout()
+	{
+		sendAction({0x14});
+		state = State::LOGOUT;
+
+		// give the server a moment to remove the player before the connection goes away
+		timer.expires_after(std::chrono::seconds(1));
+		timer.async_wait([thisPtr = shared_from_this()](const boost::system::error_code&) { thisPtr->finish(); });
+	}
+
+	void sendAction(std::vector<uint8_t> payload)
+	{
+		if (swarm.recording) {
+			const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - enteredAt).count();
+			trace.push_back({static_cast<uint32_t>(index), static_cast<uint32_t>(time), payload});
+		}
+		send(payload);
+	}
+
+	// [length][sequence][XTEA: [payload length][payload][padding]]
+	void send(const std::vector<uint8_t>& payload)
+	{
+		const size_t encryptedLength = (sizeof(uint16_t) + payload.size() + 7) & ~size_t{7};
+		std::vector<uint8_t> frame(sizeof(uint16_t) + sizeof(uint32_t) + encryptedLength);
+
+		const uint16_t length = frame.size() - sizeof(uint16_t);
+		const uint32_t sequence = ++sequenceNumber;
+		const uint16_t payloadLength = payload.size();
+		std::memcpy(frame.data(), &length, sizeof(length));
+		std::memcpy(frame.data() + 2, &sequence, sizeof(sequence));
+		std::memcpy(frame.data() + 6, &payloadLength, sizeof(payloadLength));
+		std::copy(payload.begin(), payload.end(), frame.begin() + 8);
+		xtea::encrypt(frame.data() + 6, encryptedLength, roundKeys);
+
+		++packetsSent;
+		write(std::move(frame));
+	}
+
+	// the first packets are not encrypted with XTEA, only their length and checksum are filled in here
+	void writeRaw(std::vector<uint8_t> frame)
+	{
+		const uint16_t length = frame.size() - sizeof(uint16_t);
+		const uint32_t checksum = adlerChecksum(frame.data() + 6, frame.size() - 6);
+		std::memcpy(frame.data(), &length, sizeof(length));
+		std::memcpy(frame.data() + 2, &checksum, sizeof(checksum));
+		write(std::move(frame));
+	}
+
+	void write(std::vector<uint8_t> frame)
+	{
+		writeQueue.push_back(std::move(frame));
+		if (writeQueue.size() == 1) {
+			writeNext();
+		}
+	}
+
+	void writeNext()
+	{
+		boost::asio::async_write(socket, boost::asio::buffer(writeQueue.front()),
+		                         [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) {
+			                         if (error) {
+				                         thisPtr->fail(fmt::format("write failed: {:s}", error.message()));
+				                         return;
+			                         }
+
+			                         thisPtr->writeQueue.pop_front();
+			                         if (!thisPtr->writeQueue.empty()) {
+				                         thisPtr->writeNext();
+			                         }
+		                         });
+	}
+
+	void readFrame()
+	{
+		boost::asio::async_read(socket, boost::asio::buffer(header),
+		                        [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) {
+			                        if (error) {
+				                        thisPtr->onReadError(error);
+				                        return;
+			                        }
+
+			                        thisPtr->frame.resize(thisPtr->header[0] | thisPtr->header[1] << 8);
+			                        boost::asio::async_read(
+			                            thisPtr->socket, boost::asio::buffer(thisPtr->frame),
+			                            [thisPtr](const boost::system::error_code& error, size_t) {
+				                            if (error) {
+					                            thisPtr->onReadError(error);
+					                            return;
+				                            }
+				                            thisPtr->onFrame();
+			                            });
+		                        });
+	}
+
+	void onReadError(const boost::system::error_code& error)
+	{
+		// the login server closes the connection after the character list, and the socket is reused for the game
+		if (state == State::DONE || error == boost::asio::error::operation_aborted) {
+			return;
+		}
+		if (state == State::CHALLENGE && error == boost::asio::error::eof) {
+			return;
+		}
+		fail(fmt::format("connection lost: {:s}", error.message()));
+	}
+
+	void onFrame()
+	{
+		if (state == State::CHALLENGE) {
+			onChallenge(frame);
+		} else if (!decode()) {
+			fail("undecodable packet");
+		} else if (state == State::LOGIN) {
+			onLoginReply(payload);
+			return;
+		} else {
+			onGameFrame(payload);
+		}
+
+		if (state != State::DONE) {
+			readFrame();
+		}
+	}
+
+	// [checksum or sequence][XTEA: [payload length][payload][padding]], the payload deflated if the sequence says so
+	bool decode()
+	{
+		if (frame.size() < 12 || (frame.size() - 4) % 8 != 0) {
+			return false;
+		}
+
+		xtea::decrypt(frame.data() + 4, frame.size() - 4, roundKeys);
+
+		uint32_t sequence;
+		uint16_t length;
+		std::memcpy(&sequence, frame.data(), sizeof(sequence));
+		std::memcpy(&length, frame.data() + 4, sizeof(length));
+		if (length + 6u > frame.size()) {
+			return false;
+		}
+
+		const uint8_t* data = frame.data() + 6;
+		if (state != State::LOGIN && (sequence & 0x80000000) != 0) {
+			return inflater.inflate(data, length, payload);
+		}
+
+		payload.assign(data, data + length);
+		return true;
+	}
+
+	void fail(std::string_view reason)
+	{
+		if (state == State::DONE) {
+			return;
+		}
+
+		// the server closes the connection once the player is gone
+		if (state == State::LOGOUT) {
+			finish();
+			return;
+		}
+
+		swarm.fail(index, reason);
+		finish();
+	}
+
+	void finish()
+	{
+		if (state == State::DONE) {
+			return;
+		}
+
+		state = State::DONE;
+		boost::system::error_code error;
+		timer.cancel();
+		socket.close(error);
+		swarm.report(*this);
+	}
+
+	boost::asio::strand<boost::asio::io_context::executor_type> strand;
+	tcp::socket socket;
+	boost::asio::steady_timer timer;
+
+	Swarm& swarm;
+	size_t index;
+	std::mt19937 generator;
+	const Script* script;
+	size_t replayed = 0;
+
+	boost::asio::ip::address_v4 address;
+	xtea::key key;
+	xtea::round_keys roundKeys;
+	uint32_t sequenceNumber = 0;
+	std::string sessionKey;
+	std::string characterName;
+	uint32_t creatureId = 0;
+
+	State state = State::LOGIN;
+	Clock::time_point startedAt;
+	Clock::time_point enteredAt;
+	uint32_t ticks = 0;
+
+	std::array<uint8_t, 2> header;
+	std::vector<uint8_t> frame;
+	std::vector<uint8_t> payload;
+	std::deque<std::vector<uint8_t>> writeQueue;
+	Inflater inflater;
+
+	uint32_t tokenSequence = 0;
+	std::deque<std::pair<std::string, Clock::time_point>> pendingTokens;
+
+	uint32_t loginTime = 0;
+	uint64_t packetsSent = 0;
+	uint64_t framesReceived = 0;
+	uint64_t bytesReceived = 0;
+	uint64_t lostTokens = 0;
+	std::vector<uint32_t> roundTrips;
+	std::vector<TraceRecord> trace;
+};
+
+void Swarm::report(const Bot& bot)
+{
+	std::lock_guard lock{mutex};
+	if (bot.loginTime != 0) {
+		++entered;
+		loginTimes.push_back(bot.loginTime);
+	}
+	packetsSent += bot.packetsSent;
+	framesReceived += bot.framesReceived;
+	bytesReceived += bot.bytesReceived;
+	lostTokens += bot.lostTokens + bot.pendingTokens.size();
+	roundTrips.insert(roundTrips.end(), bot.roundTrips.begin(), bot.roundTrips.end());
+	trace.insert(trace.end(), bot.trace.begin(), bot.trace.end());
+}
+
+void printPercentiles(std::string_view name, std::vector<uint32_t>& values)
+{
+	if (values.empty()) {
+		fmt::print("{:<12s} no samples\n", name);
+		return;
+	}
+
+	std::sort(values.begin(), values.end());
+	const auto percentile = [&values](double p) {
+		return values[std::min(values.size() - 1, static_cast<size_t>(values.size() * p))] / 1000.0;
+	};
+	fmt::print("{:<12s} p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms ({:d} samples)\n", name,
+	           percentile(0.5), percentile(0.9), percentile(0.99), values.back() / 1000.0, values.size());
+}
+
+// the tick histogram out of the metrics of the server, buckets are written cumulative and in order
+std::optional<tfs::profiler::Stats> parseTickStats(std::string_view metrics)
+{
+	constexpr std::string_view BUCKET = "tfs_section_duration_seconds_bucket{section=\"tick\",";
+	constexpr std::string_view SUM = "tfs_section_duration_seconds_sum{section=\"tick\"}";
+	constexpr std::string_view COUNT = "tfs_section_duration_seconds_count{section=\"tick\"}";
+
+	tfs::profiler::Stats stats;
+	size_t bucket = 0;
+	uint64_t cumulative = 0;
+	bool counted = false;
+	while (!metrics.empty()) {
+		const auto line = metrics.substr(0, metrics.find('\n'));
+		metrics.remove_prefix(std::min(line.size() + 1, metrics.size()));
+
+		const auto space = line.rfind(' ');
+		if (space == std::string_view::npos) {
+			continue;
+		}
+
+		const auto value = line.substr(space + 1);
+		if (line.starts_with(BUCKET)) {
+			// the last bucket is le="+Inf", which is the count again
+			uint64_t total = 0;
+			if (bucket < tfs::profiler::BUCKETS - 1 &&
+			    std::from_chars(value.data(), value.data() + value.size(), total).ec == std::errc{}) {
+				stats.buckets[bucket++] = total - cumulative;
+				cumulative = total;
+			}
+		} else if (line.starts_with(SUM)) {
+			double seconds = 0;
+			std::from_chars(value.data(), value.data() + value.size(), seconds);
+			stats.totalMicroseconds = static_cast<uint64_t>(seconds * 1e6);
+		} else if (line.starts_with(COUNT)) {
+			counted = std::from_chars(value.data(), value.data() + value.size(), stats.count).ec == std::errc{};
+		}
+	}
+
+	if (!counted || bucket != tfs::profiler::BUCKETS - 1 || stats.count < cumulative) {
+		return std::nullopt;
+	}
+	stats.buckets.back() = stats.count - cumulative;
+	return stats;
+}
+
+// the tick histogram of the server, std::nullopt if it does not serve its metrics
+std::optional<tfs::profiler::Stats> getTickStats()
+{
+	namespace http = boost::beast::http;
+
+	try {
+		boost::asio::io_context io_context;
+		boost::beast::tcp_stream stream{io_context};
+		stream.connect(tcp::endpoint{boost::asio::ip::address_v4::loopback(), METRICS_PORT});
+
+		http::request<http::empty_body> request{http::verb::get, "/metrics", 11};
+		request.set(http::field::host, "127.0.0.1");
+		http::write(stream, request);
+
+		boost::beast::flat_buffer buffer;
+		http::response<http::string_body> response;
+		http::read(stream, buffer, response);
+		if (response.result() != http::status::ok) {
+			return std::nullopt;
+		}
+		return parseTickStats(response.body());
+	} catch (const boost::system::system_error&) {
+		return std::nullopt;
+	}
+}
+
+// the ticks between two reads of the histogram, a profiler reset in between leaves only what came after it
+tfs::profiler::Stats getTicksBetween(const tfs::profiler::Stats& before, const tfs::profiler::Stats& after)
+{
+	tfs::profiler::Stats ticks = after;
+	if (after.count >= before.count) {
+		ticks.count -= before.count;
+		ticks.totalMicroseconds -= std::min(before.totalMicroseconds, ticks.totalMicroseconds);
+		for (size_t i = 0; i < tfs::profiler::BUCKETS; ++i) {
+			ticks.buckets[i] -= std::min(before.buckets[i], ticks.buckets[i]);
+		}
+	}
+
+	// the metrics have no maximum, the end of the highest bucket in use stands in for it, or the start of the last one
+	for (size_t i = tfs::profiler::BUCKETS; i-- > 0;) {
+		if (ticks.buckets[i] != 0) {
+			ticks.maxMicroseconds = uint64_t{1} << std::min(i, tfs::profiler::BUCKETS - 2);
+			break;
+		}
+	}
+	return ticks;
+}
+
+void printTicks(const tfs::profiler::Stats& ticks)
+{
+	if (ticks.count == 0) {
+		fmt::print("{:<12s} no samples\n", "tick");
+		return;
+	}
+
+	// the histogram only knows powers of two, these are the ends of the buckets the percentiles fall in
+	const auto percentile = [&ticks](double p) {
+		const uint64_t microseconds = ticks.getPercentile(p);
+		const bool last = microseconds >= uint64_t{1} << (tfs::profiler::BUCKETS - 2);
+		return fmt::format("{:s} {:.2f} ms", last ? ">=" : "<", microseconds / 1000.0);
+	};
+	fmt::print("{:<12s} p50 {:s}, p90 {:s}, p99 {:s}, mean {:.2f} ms ({:d} samples)\n", "tick", percentile(0.5),
+	           percentile(0.9), percentile(0.99), ticks.totalMicroseconds / 1000.0 / ticks.count, ticks.count);
+}
+
+void Swarm::print(double elapsed)
+{
+	std::lock_guard lock{mutex};
+	fmt::print("{:d} bots entered the game, {:d} failed, {:.1f} s\n", entered, failed, elapsed);
+	fmt::print("{:.0f} packets/s sent, {:.0f} packets/s and {:.0f} KB/s received\n", packetsSent / elapsed,
+	           framesReceived / elapsed, bytesReceived / elapsed / 1024);
+	printPercentiles("login", loginTimes);
+	printPercentiles("round trip", roundTrips);
+	fmt::print("{:d} said tokens never came back\n", lostTokens);
+}
+
+void printSql(size_t bots)
+{
+	std::string password;
+	for (uint8_t byte : transformToSHA1(BOT_PASSWORD)) {
+		password += fmt::format("{:02x}", byte);
+	}
+
+	for (size_t i = 0; i < bots; ++i) {
+		fmt::print("INSERT INTO `accounts` (`name`, `password`) VALUES ('bot{:d}', '{:s}');\n", i, password);
+		fmt::print("INSERT INTO `players` (`name`, `account_id`) "
+		           "SELECT 'Bot {:d}', `id` FROM `accounts` WHERE `name` = 'bot{:d}';\n",
+		           i, i);
+	}
+}
+
+size_t getArgument(int argc, char* argv[], int index, size_t defaultValue)
+{
+	if (argc <= index) {
+		return defaultValue;
+	}
+
+	size_t value = defaultValue;
+	std::from_chars(argv[index], argv[index] + std::strlen(argv[index]), value);
+	return value;
+}
+
+int usage()
+{
+	fmt::print(stderr, "usage: bench_bots run [bots] [seconds] [trace]\n"
+	                   "       bench_bots replay <trace> [bots]\n"
+	                   "       bench_bots sql [bots]\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const std::string_view command = argc > 1 ? argv[1] : "";
+	if (command == "sql") {
+		printSql(getArgument(argc, argv, 2, 100));
+		return 0;
+	}
+
+	size_t bots;
+	size_t seconds;
+	std::string tracePath;
+	std::vector<Script> scripts;
+	if (command == "run") {
+		bots = std::max<size_t>(getArgument(argc, argv, 2, 100), 1);
+		seconds = getArgument(argc, argv, 3, 60);
+		tracePath = argc > 4 ? argv[4] : "";
+	} else if (command == "replay" && argc > 2) {
+		scripts = loadTrace(argv[2]);
+		if (scripts.empty()) {
+			fmt::print(stderr, "{:s} is not a trace or is empty.\n", argv[2]);
+			return 1;
+		}
+		bots = std::max<size_t>(getArgument(argc, argv, 3, scripts.size()), 1);
+		// the scripts end the replay, this only bounds it
+		seconds = 24 * 60 * 60;
+	} else {
+		return usage();
+	}
+
+	const ServerKey key{"key.pem"};
+	if (!key.isLoaded()) {
+		fmt::print(stderr, "Could not read key.pem: {:s}\n", ERR_error_string(ERR_get_error(), nullptr));
+		return 1;
+	}
+
+	const auto ticksBefore = getTickStats();
+	if (!ticksBefore) {
+		fmt::print(stderr, "No tick histogram at 127.0.0.1:{:d}/metrics, tick times are not reported.\n", METRICS_PORT);
+	}
+
+	boost::asio::io_context io_context;
+	const auto start = Clock::now();
+	Swarm swarm{key, bots, start + LOGIN_SPACING * bots + std::chrono::seconds(seconds), !tracePath.empty(),
+	            std::move(scripts)};
+
+	for (size_t i = 0; i < bots; ++i) {
+		std::make_shared<Bot>(io_context, swarm, i)->start();
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0, count = std::max(std::thread::hardware_concurrency(), 1u); i < count; ++i) {
+		threads.emplace_back([&io_context]() { io_context.run(); });
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	swarm.print(std::chrono::duration<double>(Clock::now() - start).count());
+	if (ticksBefore) {
+		if (const auto ticksAfter = getTickStats()) {
+			printTicks(getTicksBetween(*ticksBefore, *ticksAfter));
+		} else {
+			fmt::print("{:<12s} the server stopped serving its metrics\n", "tick");
+		}
+	}
+
+	if (!tracePath.empty()) {
+		if (!saveTrace(tracePath, swarm.getTrace())) {
+			fmt::print(stderr, "Could not write {:s}.\n", tracePath);
+			return 1;
+		}
+		fmt::print("{:d} packets recorded to {:s}\n", swarm.getTrace().size(), tracePath);
+	}
+	return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Sends the messages of a busy fight to the output buffers of the players watching it, once building every message per
+// player the way the ProtocolGame::send* methods do and once building it a single time and appending it to every
+// buffer the way Game::broadcastMessage does.
+//   bench_broadcast [players] [rounds]
+
+#include "../otpch.h"
+
+#include "../creature.h"
+#include "../outputmessage.h"
+#include "../protocolgame.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class Fighter final : public Creature
+{
+public:
+	explicit Fighter(std::string name) : name(std::move(name)) { setID(); }
+
+	const std::string& getName() const override { return name; }
+	const std::string& getNameDescription() const override { return name; }
+	std::string getDescription(int32_t) const override { return name; }
+	CreatureType_t getType() const override { return CREATURETYPE_MONSTER; }
+
+	void setID() override { id = 0x40000001; }
+	void addList() override {}
+	void removeList() override {}
+	void goToFollowCreature() override {}
+
+private:
+	std::string name;
+};
+
+// one turn of a fight next to the spectators
+template <typename Send>
+void fight(const Creature& fighter, const Position& from, const Position& to, Send&& send)
+{
+	send([&](NetworkMessage& msg) { ProtocolGame::AddDistanceShoot(msg, from, to, CONST_ANI_FIRE); });
+	send([&](NetworkMessage& msg) { ProtocolGame::AddMagicEffect(msg, to, CONST_ME_HITBYFIRE); });
+	send([&](NetworkMessage& msg) { ProtocolGame::AddCreatureHealth(msg, &fighter); });
+	send([&](NetworkMessage& msg) { ProtocolGame::AddChangeSpeed(msg, &fighter, 220); });
+	send([&](NetworkMessage& msg) {
+		ProtocolGame::AddCreatureSay(msg, &fighter, TALKTYPE_MONSTER_SAY, "Feel the heat of the dragon!", &from);
+	});
+}
+
+// the same as Protocol::getOutputBuffer, except that full buffers are emptied instead of sent
+void append(OutputMessage& output, const NetworkMessage& msg)
+{
+	if (output.getLength() + msg.getLength() > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
+		output.reset();
+	}
+	output.append(msg);
+}
+
+template <typename Run>
+double benchmark(size_t rounds, Run&& run)
+{
+	const auto start = Clock::now();
+	for (size_t round = 0; round < rounds; ++round) {
+		run();
+	}
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+size_t getArgument(int argc, char* argv[], int index, size_t defaultValue)
+{
+	if (argc <= index) {
+		return defaultValue;
+	}
+
+	size_t value = defaultValue;
+	std::from_chars(argv[index], argv[index] + std::strlen(argv[index]), value);
+	return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const size_t players = std::max<size_t>(getArgument(argc, argv, 1, 200), 1);
+	const size_t rounds = std::max<size_t>(getArgument(argc, argv, 2, 20000), 1);
+
+	const Fighter fighter{"Dragon Lord"};
+	const Position from{1000, 1000, 7};
+	const Position to{1003, 998, 7};
+
+	std::vector<OutputMessage_ptr> outputs;
+	outputs.reserve(players);
+	for (size_t i = 0; i < players; ++i) {
+		outputs.push_back(tfs::net::make_output_message());
+	}
+
+	const double perPlayer = benchmark(rounds, [&]() {
+		fight(fighter, from, to, [&](auto&& build) {
+			for (const auto& output : outputs) {
+				NetworkMessage msg;
+				build(msg);
+				append(*output, msg);
+			}
+		});
+	});
+
+	const double broadcast = benchmark(rounds, [&]() {
+		fight(fighter, from, to, [&](auto&& build) {
+			NetworkMessage msg;
+			build(msg);
+			for (const auto& output : outputs) {
+				append(*output, msg);
+			}
+		});
+	});
+
+	// five messages per round and player
+	const double messages = 5.0 * rounds * players;
+	fmt::print("{:d} players, {:d} rounds\n", players, rounds);
+	fmt::print("{:<12s} {:>8.1f} ns per message\n", "per player", perPlayer / messages * 1e9);
+	fmt::print("{:<12s} {:>8.1f} ns per message ({:.2f}x)\n", "broadcast", broadcast / messages * 1e9,
+	           perPlayer / broadcast);
+	return 0;
+}
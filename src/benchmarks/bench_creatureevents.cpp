@@ -0,0 +1,143 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Looks up the creature events of a creature with the scripts a player usually has registered, once copying the
+// matching events into a std::list the way Creature::getCreatureEvents did before and once taking the view it returns
+// now, then measures the throughput of Game::combatChangeHealth hitting that creature.
+//   bench_creatureevents [hits]
+
+#include "../otpch.h"
+
+#include "../creature.h"
+#include "../game.h"
+
+extern Game g_game;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// none of them runs during a hit, so no script has to be loaded
+constexpr std::array REGISTERED_TYPES = {
+    CREATURE_EVENT_LOGIN,
+    CREATURE_EVENT_LOGOUT,
+    CREATURE_EVENT_THINK,
+    CREATURE_EVENT_DEATH,
+    CREATURE_EVENT_KILL,
+    CREATURE_EVENT_ADVANCE,
+    CREATURE_EVENT_MODALWINDOW,
+    CREATURE_EVENT_TEXTEDIT,
+    CREATURE_EVENT_EXTENDED_OPCODE,
+};
+
+class Fighter final : public Creature
+{
+public:
+	explicit Fighter(std::string name) : name(std::move(name)) { setID(); }
+
+	const std::string& getName() const override { return name; }
+	const std::string& getNameDescription() const override { return name; }
+	std::string getDescription(int32_t) const override { return name; }
+	CreatureType_t getType() const override { return CREATURETYPE_MONSTER; }
+
+	void setID() override { id = 0x40000001; }
+	void addList() override {}
+	void removeList() override {}
+	void goToFollowCreature() override {}
+
+	void setEvents(const std::vector<CreatureEvent*>& events)
+	{
+		auto table = std::make_shared<CreatureEventTable>();
+		for (size_t type = 0; type < CREATURE_EVENT_TYPES; ++type) {
+			table->offsets[type] = static_cast<uint16_t>(table->events.size());
+			for (CreatureEvent* event : events) {
+				if (event->getEventType() == type) {
+					table->events.push_back(event);
+				}
+			}
+		}
+		table->offsets[CREATURE_EVENT_TYPES] = static_cast<uint16_t>(table->events.size());
+		eventTable = std::move(table);
+	}
+
+	void heal() { health = healthMax; }
+
+	using Creature::getCreatureEvents;
+
+private:
+	std::string name;
+};
+
+// what Creature::getCreatureEvents did before, a registered type cost a list node per event
+std::list<CreatureEvent*> copyEvents(const std::vector<CreatureEvent*>& events, CreatureEventType_t type)
+{
+	std::list<CreatureEvent*> result;
+	for (CreatureEvent* event : events) {
+		if (event->isLoaded() && event->getEventType() == type) {
+			result.push_back(event);
+		}
+	}
+	return result;
+}
+
+template <typename Run>
+void benchmark(std::string_view name, size_t operations, Run&& run)
+{
+	const auto start = Clock::now();
+	for (size_t i = 0; i < operations; ++i) {
+		run();
+	}
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	fmt::print("{:<36s} {:>12.0f} ops/s ({:.1f} ns each)\n", name, operations / elapsed, elapsed / operations * 1e9);
+}
+
+size_t getArgument(int argc, char* argv[], int index, size_t defaultValue)
+{
+	if (argc <= index) {
+		return defaultValue;
+	}
+
+	size_t value = defaultValue;
+	std::from_chars(argv[index], argv[index] + std::strlen(argv[index]), value);
+	return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const size_t hits = std::max<size_t>(getArgument(argc, argv, 1, 5'000'000), 1);
+
+	std::deque<CreatureEvent> scripts;
+	std::vector<CreatureEvent*> events;
+	for (CreatureEventType_t type : REGISTERED_TYPES) {
+		CreatureEvent& event = scripts.emplace_back(nullptr);
+		event.setEventType(type);
+		event.setLoaded(true);
+		events.push_back(&event);
+	}
+
+	Fighter fighter{"Dragon Lord"};
+	fighter.setEvents(events);
+
+	size_t found = 0;
+	benchmark("list copy: registered type", hits,
+	          [&]() { found += copyEvents(events, CREATURE_EVENT_THINK).size(); });
+	benchmark("view: registered type", hits,
+	          [&]() { found += fighter.getCreatureEvents(CREATURE_EVENT_THINK).size(); });
+	benchmark("view: unregistered type", hits,
+	          [&]() { found += fighter.getCreatureEvents(CREATURE_EVENT_HEALTHCHANGE).size(); });
+
+	benchmark("combatChangeHealth", hits, [&]() {
+		CombatDamage damage;
+		damage.origin = ORIGIN_SPELL;
+		damage.primary.type = COMBAT_ENERGYDAMAGE;
+		damage.primary.value = -10;
+		g_game.combatChangeHealth(nullptr, &fighter, damage);
+		fighter.heal();
+	});
+
+	// keeps the lookups from being optimized away
+	fmt::print("{:d} events found\n", found);
+	return 0;
+}
@@ -0,0 +1,302 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Opens thousands of fake clients against a local ServiceManager and reports how many packets per second it echoes
+// back and the round trip latency. The echo protocol decrypts packets with XTEA on the network threads and answers from
+// the dispatcher, and the answers are deflated and encrypted again, the same path game packets take.
+//   bench_network [clients] [networkThreads] [seconds] [payload bytes]
+// Every client connects from its own 127.x.y.z address, so the connection flood protection does not turn them away.
+// Both ends of every connection live in this process, raise the open files limit (ulimit -n) to twice the clients.
+
+#include "../otpch.h"
+
+#include "../configmanager.h"
+#include "../outputmessage.h"
+#include "../protocol.h"
+#include "../server.h"
+#include "../tasks.h"
+
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+constexpr uint16_t PORT = 17171;
+constexpr uint8_t ECHO_PROTOCOL_IDENTIFIER = 0xFE;
+
+using Clock = std::chrono::steady_clock;
+using boost::asio::ip::tcp;
+
+class ProtocolEcho final : public Protocol
+{
+public:
+	// static protocol information
+	enum
+	{
+		server_sends_first = false
+	};
+	enum
+	{
+		protocol_identifier = ECHO_PROTOCOL_IDENTIFIER
+	};
+	enum
+	{
+		use_checksum = false
+	};
+	static const char* protocol_name() { return "echo protocol"; }
+
+	explicit ProtocolEcho(Connection_ptr connection) : Protocol(connection) {}
+
+	void onRecvFirstMessage(NetworkMessage& msg) override
+	{
+		xtea::key key;
+		for (uint32_t& part : key) {
+			part = msg.get<uint32_t>();
+		}
+
+		setXTEAKey(key);
+		enableXTEAEncryption();
+		setChecksumMode(CHECKSUM_SEQUENCE);
+		reply({});
+	}
+
+	void parsePacket(NetworkMessage& msg) override
+	{
+		// after decryption the length is the one of the payload
+		const uint8_t* payload = msg.getRemainingBuffer();
+		reply({payload, payload + msg.getLength()});
+	}
+
+private:
+	void reply(std::vector<uint8_t> payload)
+	{
+		g_dispatcher.addTask(
+		    [thisPtr = std::static_pointer_cast<ProtocolEcho>(shared_from_this()), payload = std::move(payload)]() {
+			    auto output = tfs::net::make_output_message();
+			    output->addBytes(reinterpret_cast<const char*>(payload.data()), payload.size());
+			    thisPtr->send(output);
+		    });
+	}
+};
+
+class Client : public std::enable_shared_from_this<Client>
+{
+public:
+	Client(boost::asio::io_context& io_context, size_t index, size_t payloadSize, Clock::time_point deadline) :
+	    socket(io_context), index(index), deadline(deadline)
+	{
+		const xtea::key key = {static_cast<uint32_t>(index), 0x9E3779B9, 0x7F4A7C15, 0xF39CC060};
+
+		// [length][protocol][key]
+		login.resize(NetworkMessage::HEADER_LENGTH + 1 + sizeof(key));
+		const uint16_t loginLength = login.size() - NetworkMessage::HEADER_LENGTH;
+		std::memcpy(login.data(), &loginLength, sizeof(loginLength));
+		login[NetworkMessage::HEADER_LENGTH] = ECHO_PROTOCOL_IDENTIFIER;
+		std::memcpy(login.data() + NetworkMessage::HEADER_LENGTH + 1, key.data(), sizeof(key));
+
+		// [length][checksum][xtea: [payload length][payload][padding]], the checksum is not checked
+		const size_t encryptedLength = (sizeof(uint16_t) + payloadSize + 7) & ~size_t{7};
+		const size_t encryptedStart = size_t{NetworkMessage::HEADER_LENGTH} + NetworkMessage::CHECKSUM_LENGTH;
+		packet.resize(encryptedStart + encryptedLength);
+		const uint16_t packetLength = packet.size() - NetworkMessage::HEADER_LENGTH;
+		const uint16_t innerLength = payloadSize;
+		std::memcpy(packet.data(), &packetLength, sizeof(packetLength));
+		std::memcpy(packet.data() + encryptedStart, &innerLength, sizeof(innerLength));
+		for (size_t i = 0; i < payloadSize; ++i) {
+			// compresses about as well as map descriptions do
+			packet[encryptedStart + sizeof(innerLength) + i] = static_cast<uint8_t>(i % 16 == 0 ? i : 0x66);
+		}
+		xtea::encrypt(packet.data() + encryptedStart, encryptedLength, xtea::expand_key(key));
+
+		latencies.reserve(1024);
+	}
+
+	void start(uint16_t port)
+	{
+		boost::system::error_code error;
+		socket.open(tcp::v4(), error);
+		if (!error) {
+			// 127.0.0.0/8 is loopback, a distinct address per client keeps every address under the flood protection
+			const auto block = static_cast<uint32_t>(index / 250);
+			const boost::asio::ip::address_v4 address{(127u << 24) | (block / 256 % 256) << 16 | (block % 256) << 8 |
+			                                          static_cast<uint32_t>(index % 250 + 1)};
+			socket.bind({address, 0}, error);
+		}
+		if (error) {
+			failed = true;
+			return;
+		}
+
+		socket.async_connect({boost::asio::ip::address_v4::loopback(), port},
+		                     [thisPtr = shared_from_this()](const boost::system::error_code& error) {
+			                     if (error) {
+				                     thisPtr->fail();
+				                     return;
+			                     }
+			                     thisPtr->write(thisPtr->login);
+		                     });
+	}
+
+	const std::vector<uint32_t>& getLatencies() const { return latencies; }
+	bool hasFailed() const { return failed; }
+
+private:
+	void write(const std::vector<uint8_t>& data)
+	{
+		sentAt = Clock::now();
+		boost::asio::async_write(socket, boost::asio::buffer(data),
+		                         [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) {
+			                         if (error) {
+				                         thisPtr->fail();
+				                         return;
+			                         }
+			                         thisPtr->readHeader();
+		                         });
+	}
+
+	void readHeader()
+	{
+		boost::asio::async_read(socket, boost::asio::buffer(header),
+		                        [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) {
+			                        if (error) {
+				                        thisPtr->fail();
+				                        return;
+			                        }
+			                        thisPtr->readBody();
+		                        });
+	}
+
+	void readBody()
+	{
+		body.resize(header[0] | header[1] << 8);
+		boost::asio::async_read(socket, boost::asio::buffer(body),
+		                        [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) {
+			                        if (error) {
+				                        thisPtr->fail();
+				                        return;
+			                        }
+			                        thisPtr->onReply();
+		                        });
+	}
+
+	void onReply()
+	{
+		const auto now = Clock::now();
+		if (loggedIn) {
+			latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(now - sentAt).count());
+		}
+		loggedIn = true;
+
+		if (now >= deadline) {
+			boost::system::error_code error;
+			socket.close(error);
+			return;
+		}
+		write(packet);
+	}
+
+	void fail()
+	{
+		failed = true;
+		boost::system::error_code error;
+		socket.close(error);
+	}
+
+	tcp::socket socket;
+	size_t index;
+	Clock::time_point deadline;
+	Clock::time_point sentAt;
+
+	std::vector<uint8_t> login;
+	std::vector<uint8_t> packet;
+	std::array<uint8_t, NetworkMessage::HEADER_LENGTH> header;
+	std::vector<uint8_t> body;
+
+	std::vector<uint32_t> latencies;
+	bool loggedIn = false;
+	bool failed = false;
+};
+
+size_t getArgument(int argc, char* argv[], int index, size_t defaultValue)
+{
+	if (argc <= index) {
+		return defaultValue;
+	}
+
+	size_t value = defaultValue;
+	std::from_chars(argv[index], argv[index] + std::strlen(argv[index]), value);
+	return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	const size_t clients = getArgument(argc, argv, 1, 2000);
+	const size_t networkThreads = getArgument(argc, argv, 2, 0);
+	const size_t seconds = getArgument(argc, argv, 3, 10);
+	const size_t payloadSize = std::min<size_t>(getArgument(argc, argv, 4, 256), 8192);
+
+	ConfigManager::setString(ConfigManager::IP, "127.0.0.1");
+	ConfigManager::setBoolean(ConfigManager::BIND_ONLY_GLOBAL_ADDRESS, true);
+	ConfigManager::setNumber(ConfigManager::MAX_PACKETS_PER_SECOND, std::numeric_limits<int32_t>::max());
+	ConfigManager::setNumber(ConfigManager::NETWORK_THREADS, static_cast<int32_t>(networkThreads));
+
+	g_dispatcher.start();
+
+	ServiceManager services;
+	if (!services.add<ProtocolEcho>(PORT)) {
+		return 1;
+	}
+	std::thread serverThread([&services]() { services.run(); });
+
+	boost::asio::io_context io_context;
+	const auto start = Clock::now();
+	const auto deadline = start + std::chrono::seconds(seconds);
+
+	std::vector<std::shared_ptr<Client>> fakeClients;
+	fakeClients.reserve(clients);
+	for (size_t i = 0; i < clients; ++i) {
+		fakeClients.emplace_back(std::make_shared<Client>(io_context, i, payloadSize, deadline))->start(PORT);
+	}
+
+	std::vector<std::thread> clientThreads;
+	for (size_t i = 0, threads = std::max(std::thread::hardware_concurrency() / 2, 1u); i < threads; ++i) {
+		clientThreads.emplace_back([&io_context]() { io_context.run(); });
+	}
+	for (auto& thread : clientThreads) {
+		thread.join();
+	}
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	g_dispatcher.addTask([&services]() { services.stop(); });
+	serverThread.join();
+	g_dispatcher.shutdown();
+	g_dispatcher.join();
+
+	std::vector<uint32_t> latencies;
+	size_t failed = 0;
+	for (const auto& client : fakeClients) {
+		const auto& clientLatencies = client->getLatencies();
+		latencies.insert(latencies.end(), clientLatencies.begin(), clientLatencies.end());
+		if (client->hasFailed()) {
+			++failed;
+		}
+	}
+
+	if (latencies.empty()) {
+		fmt::print(stderr, "No packet made it back, {:d} of {:d} clients failed.\n", failed, clients);
+		return 1;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	const auto percentile = [&latencies](double p) {
+		return latencies[std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * p))] / 1000.0;
+	};
+
+	fmt::print("{:d} clients ({:d} failed), {:d} byte payloads, networkThreads = {:d}\n", clients, failed,
+	           payloadSize, networkThreads);
+	fmt::print("{:>12.0f} packets/s\n", latencies.size() / elapsed);
+	fmt::print("latency p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms\n", percentile(0.5), percentile(0.99),
+	           latencies.back() / 1000.0);
+	return 0;
+}
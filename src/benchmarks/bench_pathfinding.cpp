@@ -0,0 +1,171 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Replays path queries against the test map, the same way a monster chasing its target searches for a path.
+// Run it from the repository root so the item and map files are found:
+//   bench_pathfinding [--record <file> | --replay <file>]
+// Queries are generated from a fixed seed unless they are replayed from a file written by --record, one
+// "startX startY startZ targetX targetY targetZ" line per query.
+
+#include "../otpch.h"
+
+#include "../creature.h"
+#include "../game.h"
+#include "../iomap.h"
+
+#include <fstream>
+
+extern Game g_game;
+
+namespace {
+
+constexpr size_t QUERIES = 20'000;
+constexpr size_t ROUNDS = 10;
+// queries start around the temples, where the test map has its walkable areas
+constexpr int32_t TEMPLE_RADIUS = 100;
+
+using Clock = std::chrono::steady_clock;
+
+class BenchCreature final : public Creature
+{
+public:
+	const std::string& getName() const override { return name; }
+	const std::string& getNameDescription() const override { return name; }
+	std::string getDescription(int32_t) const override { return name; }
+	CreatureType_t getType() const override { return CREATURETYPE_MONSTER; }
+
+	void setID() override {}
+	void removeList() override {}
+	void addList() override {}
+	void goToFollowCreature() override {}
+
+	using Creature::getPathSearchParams;
+
+private:
+	std::string name = "pathfinder";
+};
+
+struct PathQuery
+{
+	Position start;
+	Position target;
+};
+
+std::vector<PathQuery> generateQueries(const BenchCreature& creature)
+{
+	const Map& map = g_game.map;
+
+	std::vector<Position> temples;
+	for (const auto& it : map.towns.getTowns()) {
+		temples.push_back(it.second->templePosition);
+	}
+
+	if (temples.empty()) {
+		return {};
+	}
+
+	std::mt19937 generator{1337};
+	std::uniform_int_distribution<size_t> templeDistribution{0, temples.size() - 1};
+	std::uniform_int_distribution<int32_t> offsetTemple{-TEMPLE_RADIUS, TEMPLE_RADIUS};
+	std::uniform_int_distribution<int32_t> offsetX{-Map::maxClientViewportX, Map::maxClientViewportX};
+	std::uniform_int_distribution<int32_t> offsetY{-Map::maxClientViewportY, Map::maxClientViewportY};
+
+	std::vector<PathQuery> queries;
+	queries.reserve(QUERIES);
+	for (size_t attempts = 0; queries.size() < QUERIES && attempts < QUERIES * 100; ++attempts) {
+		const Position& temple = temples[templeDistribution(generator)];
+		const Position start(temple.x + offsetTemple(generator), temple.y + offsetTemple(generator), temple.z);
+		if (!map.canWalkTo(creature, start)) {
+			continue;
+		}
+
+		const Position target(start.x + offsetX(generator), start.y + offsetY(generator), start.z);
+		if (target != start && map.canWalkTo(creature, target)) {
+			queries.push_back({start, target});
+		}
+	}
+	return queries;
+}
+
+std::vector<PathQuery> readQueries(const std::string& fileName)
+{
+	std::vector<PathQuery> queries;
+	std::ifstream file{fileName};
+	uint32_t values[6];
+	while (file >> values[0] >> values[1] >> values[2] >> values[3] >> values[4] >> values[5]) {
+		queries.push_back({Position(values[0], values[1], values[2]), Position(values[3], values[4], values[5])});
+	}
+	return queries;
+}
+
+void writeQueries(const std::string& fileName, const std::vector<PathQuery>& queries)
+{
+	std::ofstream file{fileName};
+	for (const auto& query : queries) {
+		file << query.start.x << ' ' << query.start.y << ' ' << +query.start.z << ' ' << query.target.x << ' '
+		     << query.target.y << ' ' << +query.target.z << '\n';
+	}
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	if (!Item::items.loadFromOtb("data/items/items.otb") || !Item::items.loadFromXml()) {
+		fmt::print(stderr, "Unable to load items, run the benchmark from the repository root.\n");
+		return EXIT_FAILURE;
+	}
+
+	IOMap loader;
+	if (!loader.loadMap(&g_game.map, "data/world/forgotten.otbm")) {
+		fmt::print(stderr, "Unable to load the map: {:s}\n", loader.getLastErrorString());
+		return EXIT_FAILURE;
+	}
+
+	BenchCreature creature;
+
+	std::vector<PathQuery> queries;
+	const std::string_view mode = argc > 2 ? argv[1] : "";
+	if (mode == "--replay") {
+		queries = readQueries(argv[2]);
+		std::erase_if(queries, [](const PathQuery& query) { return !g_game.map.getTile(query.start); });
+	} else {
+		queries = generateQueries(creature);
+		if (mode == "--record") {
+			writeQueries(argv[2], queries);
+		}
+	}
+
+	if (queries.empty()) {
+		fmt::print(stderr, "No path queries to replay.\n");
+		return EXIT_FAILURE;
+	}
+
+	FindPathParams fpp;
+	creature.getPathSearchParams(nullptr, fpp);
+
+	std::vector<Direction> dirList;
+	dirList.reserve(Map::nodeReserveSize);
+
+	size_t found = 0;
+	size_t steps = 0;
+	const auto start = Clock::now();
+	for (size_t round = 0; round < ROUNDS; ++round) {
+		for (const auto& query : queries) {
+			creature.setParent(g_game.map.getTile(query.start));
+
+			dirList.clear();
+			if (g_game.map.getPathMatching(creature, query.target, dirList, FrozenPathingConditionCall(query.target),
+			                               fpp)) {
+				++found;
+				steps += dirList.size();
+			}
+		}
+	}
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	const size_t searches = queries.size() * ROUNDS;
+	fmt::print("{:d} searches, {:d} found ({:d} steps)\n", searches, found, steps);
+	fmt::print("{:.0f} searches/s, {:.2f} us per search\n", searches / elapsed, elapsed * 1e6 / searches);
+	return EXIT_SUCCESS;
+}
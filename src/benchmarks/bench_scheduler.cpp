@@ -0,0 +1,112 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Compares the timing wheel behind Scheduler with one boost::asio::steady_timer per event, which is what the
+// scheduler used before. Both run on a single thread to measure the data structures, not the thread hand-off.
+
+#include "../otpch.h"
+
+#include "../timingwheel.h"
+
+namespace {
+
+constexpr size_t EVENTS = 1'000'000;
+constexpr uint32_t MAX_DELAY = 10'000;
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchTimer : TimerNode
+{
+	uint32_t delay = 0;
+};
+
+void report(std::string_view name, Clock::time_point start, size_t operations)
+{
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	fmt::print("{:<32s} {:>12.0f} ops/s ({:.1f} ms)\n", name, operations / elapsed, elapsed * 1000);
+}
+
+std::vector<uint32_t> makeDelays()
+{
+	std::mt19937 generator{7};
+	std::uniform_int_distribution<uint32_t> distribution{1, MAX_DELAY};
+	std::vector<uint32_t> delays(EVENTS);
+	for (auto& delay : delays) {
+		delay = distribution(generator);
+	}
+	return delays;
+}
+
+void benchmarkTimingWheel(const std::vector<uint32_t>& delays)
+{
+	std::vector<BenchTimer> timers(delays.size());
+	TimingWheel wheel;
+
+	auto start = Clock::now();
+	for (size_t i = 0; i < timers.size(); ++i) {
+		wheel.insert(&timers[i], delays[i]);
+	}
+	report("timing wheel: insert", start, timers.size());
+
+	start = Clock::now();
+	for (size_t i = 0; i < timers.size(); i += 2) {
+		wheel.remove(&timers[i]);
+	}
+	report("timing wheel: cancel", start, timers.size() / 2);
+
+	size_t fired = 0;
+	start = Clock::now();
+	wheel.advance(MAX_DELAY, [&fired](TimerNode*) { ++fired; });
+	report("timing wheel: fire", start, fired);
+}
+
+void benchmarkSteadyTimer(const std::vector<uint32_t>& delays)
+{
+	boost::asio::io_context io_context;
+	std::unordered_map<uint32_t, boost::asio::steady_timer> timers;
+	size_t fired = 0;
+
+	auto start = Clock::now();
+	for (uint32_t i = 0; i < delays.size(); ++i) {
+		auto& timer = timers.emplace(i, boost::asio::steady_timer{io_context}).first->second;
+		timer.expires_after(std::chrono::milliseconds(delays[i]));
+		timer.async_wait([&fired](const boost::system::error_code& error) {
+			if (!error) {
+				++fired;
+			}
+		});
+	}
+	report("steady_timer: insert", start, delays.size());
+
+	start = Clock::now();
+	for (uint32_t i = 0; i < delays.size(); i += 2) {
+		timers.find(i)->second.cancel();
+	}
+	io_context.poll();
+	report("steady_timer: cancel", start, delays.size() / 2);
+
+	// move every deadline to the past instead of waiting for them
+	for (uint32_t i = 1; i < delays.size(); i += 2) {
+		auto& timer = timers.find(i)->second;
+		timer.expires_at(Clock::time_point{});
+		timer.async_wait([&fired](const boost::system::error_code& error) {
+			if (!error) {
+				++fired;
+			}
+		});
+	}
+	fired = 0;
+	start = Clock::now();
+	io_context.poll();
+	report("steady_timer: fire", start, fired);
+}
+
+} // namespace
+
+int main()
+{
+	const auto delays = makeDelays();
+	benchmarkTimingWheel(delays);
+	benchmarkSteadyTimer(delays);
+	return 0;
+}
@@ -0,0 +1,59 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+// Measures the throughput of every XTEA kernel this CPU supports, on packet sizes from a short client packet to a
+// full map description.
+
+#include "../otpch.h"
+
+#include "../xtea.h"
+
+namespace {
+
+constexpr size_t BYTES_PER_RUN = 64 * 1024 * 1024;
+constexpr std::array<size_t, 4> PACKET_SIZES = {16, 128, 1024, 8192};
+
+using Clock = std::chrono::steady_clock;
+
+std::string_view getName(xtea::kernel kernel)
+{
+	switch (kernel) {
+		case xtea::kernel::sse2:
+			return "sse2";
+		case xtea::kernel::avx2:
+			return "avx2";
+		default:
+			return "scalar";
+	}
+}
+
+template <typename F>
+void benchmark(std::string_view name, size_t packetSize, F&& run)
+{
+	std::vector<uint8_t> packet(packetSize, 0x66);
+
+	const auto start = Clock::now();
+	for (size_t done = 0; done < BYTES_PER_RUN; done += packetSize) {
+		run(packet.data(), packet.size());
+	}
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	fmt::print("{:<24s} {:>6d} bytes {:>10.1f} MB/s\n", name, packetSize, BYTES_PER_RUN / elapsed / 1e6);
+}
+
+} // namespace
+
+int main()
+{
+	const auto key = xtea::expand_key({0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210});
+
+	for (auto kernel : xtea::supported_kernels()) {
+		for (size_t packetSize : PACKET_SIZES) {
+			benchmark(fmt::format("{:s} encrypt", getName(kernel)), packetSize,
+			          [&](uint8_t* data, size_t length) { xtea::encrypt(kernel, data, length, key); });
+			benchmark(fmt::format("{:s} decrypt", getName(kernel)), packetSize,
+			          [&](uint8_t* data, size_t length) { xtea::decrypt(kernel, data, length, key); });
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,150 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "compression.h"
+
+#include "tools.h"
+
+#include <zlib.h>
+
+namespace tfs::compression {
+
+namespace {
+
+struct ClassSettings
+{
+	// largest message of the class
+	size_t maxSize;
+	int level;
+	// a window larger than the message only costs memory and setup time
+	int windowBits;
+	int memLevel;
+};
+
+constexpr std::array<ClassSettings, MESSAGE_CLASSES> CLASS_SETTINGS = {{
+    {1024, 6, 10, 6},
+    {8192, 6, 13, 8},
+    {std::numeric_limits<size_t>::max(), 5, 15, 8},
+}};
+
+struct AtomicStats
+{
+	std::atomic<uint64_t> messages{0};
+	std::atomic<uint64_t> inputBytes{0};
+	std::atomic<uint64_t> outputBytes{0};
+	std::atomic<uint64_t> nanoseconds{0};
+};
+
+std::array<AtomicStats, MESSAGE_CLASSES> stats;
+
+class Compressor
+{
+public:
+	Compressor()
+	{
+		for (size_t i = 0; i < MESSAGE_CLASSES; ++i) {
+			const ClassSettings& settings = CLASS_SETTINGS[i];
+			if (deflateInit2(&streams[i], settings.level, Z_DEFLATED, -settings.windowBits, settings.memLevel,
+			                 Z_DEFAULT_STRATEGY) != Z_OK) {
+				std::cout << "ZLIB initialization error: " << (streams[i].msg ? streams[i].msg : "unknown")
+				          << std::endl;
+			}
+		}
+	}
+
+	~Compressor()
+	{
+		for (z_stream& stream : streams) {
+			const auto zlibEndResult = deflateEnd(&stream);
+			if (zlibEndResult == Z_DATA_ERROR) {
+				std::cout << "ZLIB discarded pending output or unprocessed input while cleaning up stream state"
+				          << std::endl;
+			} else if (zlibEndResult == Z_STREAM_ERROR) {
+				std::cout << "ZLIB encountered an error while cleaning up stream state" << std::endl;
+			}
+		}
+	}
+
+	// non-copyable
+	Compressor(const Compressor&) = delete;
+	Compressor& operator=(const Compressor&) = delete;
+
+	std::string_view deflate(const uint8_t* data, size_t size)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		const size_t messageClass = tfs::to_underlying(getMessageClass(size));
+		z_stream& stream = streams[messageClass];
+		output.resize(deflateBound(&stream, size));
+
+		stream.next_in = const_cast<uint8_t*>(data);
+		stream.avail_in = size;
+		stream.next_out = reinterpret_cast<uint8_t*>(output.data());
+		stream.avail_out = output.size();
+
+		const auto result = ::deflate(&stream, Z_FINISH);
+		const auto compressedSize = stream.total_out;
+		deflateReset(&stream);
+
+		if (result != Z_OK && result != Z_STREAM_END) {
+			std::cout << "Error while deflating packet data error: " << (stream.msg ? stream.msg : "unknown")
+			          << std::endl;
+			return {};
+		}
+
+		if (compressedSize <= 0) {
+			std::cout << "Deflated packet data had invalid size: " << compressedSize
+			          << " error: " << (stream.msg ? stream.msg : "unknown") << std::endl;
+			return {};
+		}
+
+		output.resize(compressedSize);
+
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+		AtomicStats& classStats = stats[messageClass];
+		classStats.messages.fetch_add(1, std::memory_order_relaxed);
+		classStats.inputBytes.fetch_add(size, std::memory_order_relaxed);
+		classStats.outputBytes.fetch_add(compressedSize, std::memory_order_relaxed);
+		classStats.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+		                                 std::memory_order_relaxed);
+		return output;
+	}
+
+private:
+	std::array<z_stream, MESSAGE_CLASSES> streams{};
+	std::string output;
+};
+
+} // namespace
+
+MessageClass getMessageClass(size_t size)
+{
+	for (size_t i = 0; i < MESSAGE_CLASSES - 1; ++i) {
+		if (size <= CLASS_SETTINGS[i].maxSize) {
+			return static_cast<MessageClass>(i);
+		}
+	}
+	return MessageClass::LARGE;
+}
+
+std::string_view deflate(const uint8_t* data, size_t size)
+{
+	// every network thread compresses with its own streams
+	static thread_local Compressor compressor;
+	return compressor.deflate(data, size);
+}
+
+Stats getStats(MessageClass messageClass)
+{
+	const AtomicStats& classStats = stats[tfs::to_underlying(messageClass)];
+	return {
+	    .messages = classStats.messages.load(std::memory_order_relaxed),
+	    .inputBytes = classStats.inputBytes.load(std::memory_order_relaxed),
+	    .outputBytes = classStats.outputBytes.load(std::memory_order_relaxed),
+	    .nanoseconds = classStats.nanoseconds.load(std::memory_order_relaxed),
+	};
+}
+
+} // namespace tfs::compression
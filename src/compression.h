@@ -0,0 +1,43 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_COMPRESSION_H
+#define FS_COMPRESSION_H
+
+namespace tfs::compression {
+
+/**
+ * @brief Outgoing messages are compressed with settings picked by their size.
+ */
+enum class MessageClass : uint8_t
+{
+	SMALL,
+	MEDIUM,
+	LARGE,
+};
+
+constexpr size_t MESSAGE_CLASSES = 3;
+
+struct Stats
+{
+	uint64_t messages = 0;
+	uint64_t inputBytes = 0;
+	uint64_t outputBytes = 0;
+	// time spent compressing
+	uint64_t nanoseconds = 0;
+};
+
+MessageClass getMessageClass(size_t size);
+
+/**
+ * @brief Compresses a message with raw deflate, the way the client inflates it.
+ *
+ * @return the compressed message, valid until the next call on this thread, empty on error
+ */
+std::string_view deflate(const uint8_t* data, size_t size);
+
+Stats getStats(MessageClass messageClass);
+
+} // namespace tfs::compression
+
+#endif // FS_COMPRESSION_H
@@ -47,6 +47,8 @@ enum boolean_config_t
 	MANASHIELD_BREAKABLE,
 	CHECK_DUPLICATE_STORAGE_KEYS,
 	MONSTER_OVERSPAWN,
+	PROFILER,
+	HTTP_METRICS,
 
 	LAST_BOOLEAN_CONFIG /* this must be the last one */
 };
@@ -124,6 +126,11 @@ enum integer_config_t
 	STAMINA_REGEN_PREMIUM,
 	PATHFINDING_INTERVAL,
 	PATHFINDING_DELAY,
+	PATHFINDING_THREADS,
+	DATABASE_WORKERS,
+	NETWORK_THREADS,
+	OUTPUT_FLUSH_THRESHOLD,
+	SLOW_TICK_THRESHOLD,
 
 	LAST_INTEGER_CONFIG /* this must be the last one */
 };
@@ -7,6 +7,7 @@
 
 #include "configmanager.h"
 #include "outputmessage.h"
+#include "profiler.h"
 #include "protocol.h"
 #include "server.h"
 #include "tasks.h"
@@ -43,6 +44,32 @@ void ConnectionManager::closeAll()
 	connections.clear();
 }
 
+void ConnectionManager::addQueueDelay(uint64_t microseconds)
+{
+	totalQueueDelay.fetch_add(microseconds, std::memory_order_relaxed);
+	queueDelays[std::min<size_t>(std::bit_width(microseconds), QUEUE_DELAY_BUCKETS - 1)].fetch_add(
+	    1, std::memory_order_relaxed);
+
+	uint64_t max = maxQueueDelay.load(std::memory_order_relaxed);
+	while (microseconds > max && !maxQueueDelay.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {
+	}
+}
+
+ConnectionManager::WriteStats ConnectionManager::getWriteStats() const
+{
+	WriteStats stats{
+	    .writes = writes.load(std::memory_order_relaxed),
+	    .messages = writtenMessages.load(std::memory_order_relaxed),
+	    .bytes = writtenBytes.load(std::memory_order_relaxed),
+	    .totalQueueDelay = totalQueueDelay.load(std::memory_order_relaxed),
+	    .maxQueueDelay = maxQueueDelay.load(std::memory_order_relaxed),
+	};
+	for (size_t i = 0; i < QUEUE_DELAY_BUCKETS; ++i) {
+		stats.queueDelays[i] = queueDelays[i].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
 // Connection
 
 Connection::Connection(boost::asio::io_context& io_context, ConstServicePort_ptr service_port) :
@@ -65,7 +92,7 @@ void Connection::close(bool force)
 		g_dispatcher.addTask([protocol = protocol]() { protocol->release(); });
 	}
 
-	if (messageQueue.empty() || force) {
+	if ((messageQueue.empty() && writingMessages.empty()) || force) {
 		closeSocket();
 	} else {
 		// will be closed by the destructor or onWriteOperation
@@ -220,6 +247,8 @@ void Connection::parsePacket(const boost::system::error_code& error)
 		return;
 	}
 
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::NETWORK_RECEIVE};
+
 	// Read potential checksum bytes
 	msg.get<uint32_t>();
 
@@ -274,12 +303,11 @@ void Connection::send(const OutputMessage_ptr& msg)
 		return;
 	}
 
-	bool noPendingWrite = messageQueue.empty();
+	bool noPendingWrite = messageQueue.empty() && writingMessages.empty();
 	messageQueue.emplace_back(msg);
 	if (noPendingWrite) {
 		try {
-			boost::asio::post(socket.get_executor(),
-			                  [thisPtr = shared_from_this(), msg] { thisPtr->internalSend(msg); });
+			boost::asio::post(socket.get_executor(), [thisPtr = shared_from_this()] { thisPtr->internalSend(); });
 		} catch (const boost::system::system_error& e) {
 			std::cout << "[Network error - Connection::send] " << e.what() << std::endl;
 			messageQueue.clear();
@@ -288,9 +316,32 @@ void Connection::send(const OutputMessage_ptr& msg)
 	}
 }
 
-void Connection::internalSend(const OutputMessage_ptr& msg)
+void Connection::internalSend()
 {
-	protocol->onSendMessage(msg);
+	// network thread, everything queued until now goes out in one write
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::NETWORK_SEND};
+	{
+		std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
+		messageQueue.swap(writingMessages);
+	}
+
+	auto& connectionManager = ConnectionManager::getInstance();
+	const auto now = std::chrono::steady_clock::now();
+
+	writeBuffers.clear();
+	size_t bytes = 0;
+	for (const auto& msg : writingMessages) {
+		connectionManager.addQueueDelay(
+		    std::chrono::duration_cast<std::chrono::microseconds>(now - msg->getCreationTime()).count());
+
+		protocol->onSendMessage(msg);
+		writeBuffers.emplace_back(msg->getOutputBuffer(), msg->getLength());
+		bytes += msg->getLength();
+	}
+	connectionManager.addWrite(writingMessages.size(), bytes);
+
+	// close may run on the dispatcher thread and the socket is not thread safe, so only starting the write is locked
+	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
 	try {
 		writeTimer.expires_after(std::chrono::seconds(CONNECTION_WRITE_TIMEOUT));
 		writeTimer.async_wait(
@@ -299,7 +350,7 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 		    });
 
 		boost::asio::async_write(
-		    socket, boost::asio::buffer(msg->getOutputBuffer(), msg->getLength()),
+		    socket, writeBuffers,
 		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
 			    thisPtr->onWriteOperation(error);
 		    });
@@ -311,21 +362,28 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 
 void Connection::onWriteOperation(const boost::system::error_code& error)
 {
-	std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
-	writeTimer.cancel();
-	messageQueue.pop_front();
+	{
+		std::lock_guard<std::recursive_mutex> lockClass(connectionLock);
+		writeTimer.cancel();
+		writingMessages.clear();
 
-	if (error) {
-		messageQueue.clear();
-		close(FORCE_CLOSE);
-		return;
-	}
+		if (error) {
+			messageQueue.clear();
+			close(FORCE_CLOSE);
+			return;
+		}
 
-	if (!messageQueue.empty()) {
-		internalSend(messageQueue.front());
-	} else if (connectionState == CONNECTION_STATE_DISCONNECTED) {
-		closeSocket();
+		if (messageQueue.empty()) {
+			if (connectionState == CONNECTION_STATE_DISCONNECTED) {
+				closeSocket();
+			}
+			return;
+		}
 	}
+
+	// the queue is not empty, so send does not post another write and close leaves the socket open until this one is
+	// done. Encrypting the batch is left out of the lock, which would otherwise block the dispatcher queueing messages.
+	internalSend();
 }
 
 void Connection::handleTimeout(ConnectionWeak_ptr connectionWeak, const boost::system::error_code& error)
@@ -41,6 +41,21 @@ using ConstServicePort_ptr = std::shared_ptr<const ServicePort>;
 class ConnectionManager
 {
 public:
+	// queueing delays are counted in buckets of [2^(i-1), 2^i) microseconds, the last one takes everything above
+	static constexpr size_t QUEUE_DELAY_BUCKETS = 16;
+
+	struct WriteStats
+	{
+		// gathered writes, each one usually is a single writev
+		uint64_t writes = 0;
+		uint64_t messages = 0;
+		uint64_t bytes = 0;
+		// microseconds from creating a message until its socket write started
+		uint64_t totalQueueDelay = 0;
+		uint64_t maxQueueDelay = 0;
+		std::array<uint64_t, QUEUE_DELAY_BUCKETS> queueDelays = {};
+	};
+
 	static ConnectionManager& getInstance()
 	{
 		static ConnectionManager instance;
@@ -51,11 +66,29 @@ public:
 	void releaseConnection(const Connection_ptr& connection);
 	void closeAll();
 
+	void addWrite(size_t messages, size_t bytes)
+	{
+		writes.fetch_add(1, std::memory_order_relaxed);
+		writtenMessages.fetch_add(messages, std::memory_order_relaxed);
+		writtenBytes.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	void addQueueDelay(uint64_t microseconds);
+
+	WriteStats getWriteStats() const;
+
 private:
 	ConnectionManager() = default;
 
 	std::unordered_set<Connection_ptr> connections;
 	std::mutex connectionManagerLock;
+
+	std::atomic<uint64_t> writes{0};
+	std::atomic<uint64_t> writtenMessages{0};
+	std::atomic<uint64_t> writtenBytes{0};
+	std::atomic<uint64_t> totalQueueDelay{0};
+	std::atomic<uint64_t> maxQueueDelay{0};
+	std::array<std::atomic<uint64_t>, QUEUE_DELAY_BUCKETS> queueDelays = {};
 };
 
 class Connection : public std::enable_shared_from_this<Connection>
@@ -94,7 +127,7 @@ private:
 	static void handleTimeout(ConnectionWeak_ptr connectionWeak, const boost::system::error_code& error);
 
 	void closeSocket();
-	void internalSend(const OutputMessage_ptr& msg);
+	void internalSend();
 
 	boost::asio::ip::tcp::socket& getSocket() { return socket; }
 	friend class ServicePort;
@@ -106,7 +139,10 @@ private:
 
 	std::recursive_mutex connectionLock;
 
-	std::list<OutputMessage_ptr> messageQueue;
+	// messages queued while a write is in progress go out together with the next one
+	std::vector<OutputMessage_ptr> messageQueue;
+	std::vector<OutputMessage_ptr> writingMessages;
+	std::vector<boost::asio::const_buffer> writeBuffers;
 
 	ConstServicePort_ptr service_port;
 	Protocol_ptr protocol;
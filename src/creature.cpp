@@ -358,7 +358,19 @@ void Creature::updateFollowCreaturePath(FindPathParams& fpp)
 {
 	listWalkDir.clear();
 
-	if (getPathTo(followCreature->getPosition(), listWalkDir, fpp)) {
+	const Position& targetPos = followCreature->getPosition();
+
+	bool found;
+	if (prefetchedPath.ready && prefetchedPath.startPos == getPosition() && prefetchedPath.targetPos == targetPos &&
+	    prefetchedPath.fpp == fpp) {
+		listWalkDir.swap(prefetchedPath.dirList);
+		found = prefetchedPath.found;
+	} else {
+		found = getPathTo(targetPos, listWalkDir, fpp);
+	}
+	prefetchedPath.ready = false;
+
+	if (found) {
 		hasFollowPath = true;
 		startAutoWalk();
 	} else {
@@ -366,6 +378,27 @@ void Creature::updateFollowCreaturePath(FindPathParams& fpp)
 	}
 }
 
+bool Creature::prepareFollowPath()
+{
+	prefetchedPath.ready = false;
+	if (!willSearchFollowPath()) {
+		return false;
+	}
+
+	prefetchedPath.startPos = getPosition();
+	prefetchedPath.targetPos = followCreature->getPosition();
+	prefetchedPath.fpp = {};
+	getPathSearchParams(followCreature, prefetchedPath.fpp);
+	return true;
+}
+
+void Creature::findFollowPath()
+{
+	prefetchedPath.dirList.clear();
+	prefetchedPath.found = getPathTo(prefetchedPath.targetPos, prefetchedPath.dirList, prefetchedPath.fpp);
+	prefetchedPath.ready = true;
+}
+
 void Creature::onChangeZone(ZoneType_t zone)
 {
 	if (attackedCreature && zone == ZONE_PROTECTION) {
@@ -1363,17 +1396,21 @@ bool Creature::registerCreatureEvent(const std::string& name)
 	}
 
 	CreatureEventType_t type = event->getEventType();
-	if (hasEventRegistered(type)) {
-		for (CreatureEvent* creatureEvent : eventsList) {
-			if (creatureEvent == event) {
-				return false;
-			}
+	if (eventTable) {
+		auto first = eventTable->events.begin() + eventTable->offsets[type];
+		auto last = eventTable->events.begin() + eventTable->offsets[type + 1];
+		if (std::find(first, last, event) != last) {
+			return false;
 		}
-	} else {
-		scriptEventsBitField |= static_cast<uint32_t>(1) << type;
 	}
 
-	eventsList.push_back(event);
+	// views handed out before keep the previous table, so it is copied rather than changed
+	auto table = eventTable ? std::make_shared<CreatureEventTable>(*eventTable) : std::make_shared<CreatureEventTable>();
+	table->events.insert(table->events.begin() + table->offsets[type + 1], event);
+	for (size_t i = type + 1; i < table->offsets.size(); ++i) {
+		++table->offsets[i];
+	}
+	eventTable = std::move(table);
 	return true;
 }
 
@@ -1389,47 +1426,25 @@ bool Creature::unregisterCreatureEvent(const std::string& name)
 		return false;
 	}
 
-	bool resetTypeBit = true;
-
-	auto it = eventsList.begin(), end = eventsList.end();
-	while (it != end) {
-		CreatureEvent* curEvent = *it;
-		if (curEvent == event) {
-			it = eventsList.erase(it);
-			continue;
-		}
-
-		if (curEvent->getEventType() == type) {
-			resetTypeBit = false;
-		}
-		++it;
-	}
-
-	if (resetTypeBit) {
-		scriptEventsBitField &= ~(static_cast<uint32_t>(1) << type);
+	auto first = eventTable->events.begin() + eventTable->offsets[type];
+	auto last = eventTable->events.begin() + eventTable->offsets[type + 1];
+	auto it = std::find(first, last, event);
+	if (it == last) {
+		return true;
 	}
-	return true;
-}
 
-CreatureEventList Creature::getCreatureEvents(CreatureEventType_t type)
-{
-	CreatureEventList tmpEventList;
-
-	if (!hasEventRegistered(type)) {
-		return tmpEventList;
+	if (eventTable->events.size() == 1) {
+		eventTable.reset();
+		return true;
 	}
 
-	for (CreatureEvent* creatureEvent : eventsList) {
-		if (!creatureEvent->isLoaded()) {
-			continue;
-		}
-
-		if (creatureEvent->getEventType() == type) {
-			tmpEventList.push_back(creatureEvent);
-		}
+	auto table = std::make_shared<CreatureEventTable>(*eventTable);
+	table->events.erase(table->events.begin() + std::distance(eventTable->events.begin(), it));
+	for (size_t i = type + 1; i < table->offsets.size(); ++i) {
+		--table->offsets[i];
 	}
-
-	return tmpEventList;
+	eventTable = std::move(table);
+	return true;
 }
 
 bool FrozenPathingConditionCall::isInRange(const Position& startPos, const Position& testPos,
@@ -19,7 +19,6 @@ class Npc;
 class Player;
 
 using ConditionList = std::list<Condition*>;
-using CreatureEventList = std::list<CreatureEvent*>;
 using CreatureIconHashMap = std::unordered_map<CreatureIcon_t, uint16_t>;
 
 enum slots_t : uint8_t
@@ -51,6 +50,8 @@ struct FindPathParams
 	int32_t maxSearchDist = 0;
 	int32_t minTargetDist = -1;
 	int32_t maxTargetDist = -1;
+
+	bool operator==(const FindPathParams&) const = default;
 };
 
 static constexpr int32_t EVENT_CREATURECOUNT = 10;
@@ -191,6 +192,22 @@ public:
 	void stopEventWalk();
 	virtual void goToFollowCreature() = 0;
 	void updateFollowCreaturePath(FindPathParams& fpp);
+	/**
+	 * @brief Whether the next goToFollowCreature searches the path with updateFollowCreaturePath.
+	 */
+	virtual bool willSearchFollowPath() const { return followCreature != nullptr; }
+
+	/**
+	 * @brief Snapshots what searching the path to the followed creature needs, returns false if the next update does
+	 * not search one.
+	 */
+	bool prepareFollowPath();
+	/**
+	 * @brief Searches the path snapshotted by prepareFollowPath ahead of the next updateFollowCreaturePath. It only
+	 * reads the map, so the paths of many creatures can be searched in parallel while the dispatcher waits.
+	 */
+	void findFollowPath();
+	void discardFollowPath() { prefetchedPath.ready = false; }
 
 	// walk events
 	virtual void onWalk(Direction& dir);
@@ -380,7 +397,7 @@ public:
 
 	virtual void setStorageValue(uint32_t key, std::optional<int32_t> value, bool isSpawn = false);
 	virtual std::optional<int32_t> getStorageValue(uint32_t key) const;
-	decltype(auto) getStorageMap() const { return storageMap; }
+	const auto& getStorageMap() const { return storageMap; }
 
 protected:
 	struct CountBlock_t
@@ -395,12 +412,24 @@ protected:
 	CountMap damageMap;
 
 	std::list<Creature*> summons;
-	CreatureEventList eventsList;
+	std::shared_ptr<const CreatureEventTable> eventTable;
 	ConditionList conditions;
 	CreatureIconHashMap creatureIcons;
 
 	std::vector<Direction> listWalkDir;
 
+	struct PrefetchedPath
+	{
+		Position startPos;
+		Position targetPos;
+		FindPathParams fpp;
+		std::vector<Direction> dirList;
+		bool found = false;
+		bool ready = false;
+	};
+	// path to the followed creature searched by findFollowPath, only used while neither of them moved
+	PrefetchedPath prefetchedPath;
+
 	Tile* tile = nullptr;
 	Creature* attackedCreature = nullptr;
 	Creature* master = nullptr;
@@ -411,7 +440,6 @@ protected:
 	int64_t lastPathUpdate = 0;
 	uint32_t referenceCounter = 0;
 	uint32_t id = 0;
-	uint32_t scriptEventsBitField = 0;
 	uint32_t eventWalk = 0;
 	uint32_t walkUpdateTicks = 0;
 	uint32_t lastHitCreatureId = 0;
@@ -448,9 +476,9 @@ protected:
 	// creature script events
 	bool hasEventRegistered(CreatureEventType_t event) const
 	{
-		return (0 != (scriptEventsBitField & (static_cast<uint32_t>(1) << event)));
+		return eventTable && eventTable->offsets[event] != eventTable->offsets[event + 1];
 	}
-	CreatureEventList getCreatureEvents(CreatureEventType_t type);
+	CreatureEventList getCreatureEvents(CreatureEventType_t type) const { return {eventTable, type}; }
 
 	void onCreatureDisappear(const Creature* creature, bool isLogout);
 	virtual void doAttacking(uint32_t) {}
@@ -29,6 +29,8 @@ enum CreatureEventType_t
 	CREATURE_EVENT_EXTENDED_OPCODE, // otclient additional network opcodes
 };
 
+static constexpr size_t CREATURE_EVENT_TYPES = CREATURE_EVENT_EXTENDED_OPCODE + 1;
+
 class CreatureEvent final : public Event
 {
 public:
@@ -71,6 +73,78 @@ private:
 	bool loaded;
 };
 
+/**
+ * @brief The events registered to a creature, grouped by type. It is never modified, registering or unregistering an
+ * event replaces the table of the creature.
+ */
+struct CreatureEventTable
+{
+	std::vector<CreatureEvent*> events;
+	// the events of type t are events[offsets[t]] up to events[offsets[t + 1]]
+	std::array<uint16_t, CREATURE_EVENT_TYPES + 1> offsets = {};
+};
+
+/**
+ * @brief The loaded events of one type registered to a creature, looked up without allocating.
+ *
+ * It shares the table it was taken from, so it stays valid while the events it runs register or unregister others.
+ */
+class CreatureEventList
+{
+public:
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = CreatureEvent*;
+		using difference_type = std::ptrdiff_t;
+		using pointer = CreatureEvent* const*;
+		using reference = CreatureEvent*;
+
+		iterator(CreatureEvent* const* it, CreatureEvent* const* end) : it(it), end(end) { skipUnloaded(); }
+
+		CreatureEvent* operator*() const { return *it; }
+		iterator& operator++()
+		{
+			++it;
+			skipUnloaded();
+			return *this;
+		}
+		bool operator==(const iterator& other) const { return it == other.it; }
+
+	private:
+		// events that failed to load on a reload stay registered, but do not run
+		void skipUnloaded()
+		{
+			while (it != end && !(*it)->isLoaded()) {
+				++it;
+			}
+		}
+
+		CreatureEvent* const* it;
+		CreatureEvent* const* end;
+	};
+
+	CreatureEventList() = default;
+	CreatureEventList(std::shared_ptr<const CreatureEventTable> eventTable, CreatureEventType_t type) :
+	    table(std::move(eventTable))
+	{
+		if (table && type < CREATURE_EVENT_TYPES) {
+			events = {table->events.data() + table->offsets[type], table->events.data() + table->offsets[type + 1]};
+		}
+	}
+
+	iterator begin() const { return {events.data(), events.data() + events.size()}; }
+	iterator end() const { return {events.data() + events.size(), events.data() + events.size()}; }
+
+	bool empty() const { return begin() == end(); }
+	size_t size() const { return std::distance(begin(), end()); }
+
+private:
+	std::shared_ptr<const CreatureEventTable> table;
+	std::span<CreatureEvent* const> events;
+};
+
 class CreatureEvents final : public BaseEvents
 {
 public:
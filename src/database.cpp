@@ -47,7 +47,8 @@ static bool isLostConnectionError(const unsigned error)
 	       error == 1053 /*ER_SERVER_SHUTDOWN*/ || error == CR_CONNECTION_ERROR;
 }
 
-static bool executeQuery(tfs::detail::Mysql_ptr& handle, std::string_view query, const bool retryIfLostConnection)
+static bool executeQuery(tfs::detail::Mysql_ptr& handle, uint64_t& connectionId, std::string_view query,
+                         const bool retryIfLostConnection)
 {
 	while (mysql_real_query(handle.get(), query.data(), query.length()) != 0) {
 		std::cout << "[Error - mysql_real_query] Query: " << query.substr(0, 256) << std::endl
@@ -57,10 +58,14 @@ static bool executeQuery(tfs::detail::Mysql_ptr& handle, std::string_view query,
 			return false;
 		}
 		handle = connectToDatabase(true);
+		++connectionId;
 	}
 	return true;
 }
 
+// statements have to be closed before the connection they were prepared on
+Database::~Database() { statements.clear(); }
+
 bool Database::connect()
 {
 	auto newHandle = connectToDatabase(false);
@@ -69,6 +74,7 @@ bool Database::connect()
 	}
 
 	handle = std::move(newHandle);
+	++connectionId;
 	DBResult_ptr result = storeQuery("SHOW VARIABLES LIKE 'max_allowed_packet'");
 	if (result) {
 		maxPacketSize = result->getNumber<uint64_t>("Value");
@@ -106,7 +112,7 @@ bool Database::commit()
 bool Database::executeQuery(const std::string& query)
 {
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
-	auto success = ::executeQuery(handle, query, retryQueries);
+	auto success = ::executeQuery(handle, connectionId, query, retryQueries);
 
 	// executeQuery can be called with command that produces result (e.g. SELECT)
 	// we have to store that result, even though we do not need it, otherwise handle will get blocked
@@ -121,7 +127,7 @@ DBResult_ptr Database::storeQuery(std::string_view query)
 	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
 
 retry:
-	if (!::executeQuery(handle, query, retryQueries) && !retryQueries) {
+	if (!::executeQuery(handle, connectionId, query, retryQueries) && !retryQueries) {
 		return nullptr;
 	}
 
@@ -166,17 +172,42 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const
 	return escaped;
 }
 
+DBStatement& Database::prepare(std::string_view query)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+	auto it = statements.find(query);
+	if (it == statements.end()) {
+		it = statements.emplace(query, std::make_unique<DBStatement>(*this, std::string{query})).first;
+	}
+	return *it->second;
+}
+
 DBResult::DBResult(tfs::detail::MysqlResult_ptr&& res) : handle{std::move(res)}
 {
-	size_t i = 0;
+	setColumns();
+	next();
+}
+
+DBResult::DBResult(tfs::detail::MysqlResult_ptr&& metadata, std::string&& buffer, const std::vector<size_t>& offsets,
+                   std::vector<unsigned long>&& cellLengths) :
+    handle{std::move(metadata)}, buffer{std::move(buffer)}, cellLengths{std::move(cellLengths)}
+{
+	setColumns();
+
+	cells.reserve(offsets.size());
+	for (size_t offset : offsets) {
+		cells.push_back(offset != std::string::npos ? this->buffer.data() + offset : nullptr);
+	}
+	next();
+}
 
+void DBResult::setColumns()
+{
 	MYSQL_FIELD* field = mysql_fetch_field(handle.get());
 	while (field) {
-		listNames[field->name] = i++;
+		listNames[field->name] = columns++;
 		field = mysql_fetch_field(handle.get());
 	}
-
-	row = mysql_fetch_row(handle.get());
 }
 
 std::string_view DBResult::getString(std::string_view column) const
@@ -187,31 +218,205 @@ std::string_view DBResult::getString(std::string_view column) const
 		          << std::endl;
 		return {};
 	}
+	return getString(it->second);
+}
 
-	if (!row[it->second]) {
+std::string_view DBResult::getString(size_t index) const
+{
+	if (index >= columns || !row[index]) {
 		return {};
 	}
-
-	auto size = mysql_fetch_lengths(handle.get())[it->second];
-	return {row[it->second], size};
+	return {row[index], lengths[index]};
 }
 
 bool DBResult::hasNext() const { return row; }
 
 bool DBResult::next()
 {
+	if (!cells.empty()) {
+		if (nextCell >= cells.size()) {
+			row = nullptr;
+			return false;
+		}
+
+		row = cells.data() + nextCell;
+		lengths = cellLengths.data() + nextCell;
+		nextCell += columns;
+		return true;
+	}
+
 	row = mysql_fetch_row(handle.get());
+	lengths = row ? mysql_fetch_lengths(handle.get()) : nullptr;
 	return row;
 }
 
-DBInsert::DBInsert(std::string query) : query(std::move(query)) { this->length = this->query.length(); }
+bool DBStatement::prepare()
+{
+	prepared = false;
+	connectionId = db.connectionId;
+
+	handle.reset(mysql_stmt_init(db.handle.get()));
+	if (!handle) {
+		std::cout << "[Error - mysql_stmt_init] Query: " << query.substr(0, 256) << std::endl
+		          << "Message: " << mysql_error(db.handle.get()) << std::endl;
+		return false;
+	}
+
+	if (mysql_stmt_prepare(handle.get(), query.data(), query.length()) != 0) {
+		std::cout << "[Error - mysql_stmt_prepare] Query: " << query.substr(0, 256) << std::endl
+		          << "Message: " << mysql_stmt_error(handle.get()) << std::endl;
+		return false;
+	}
+
+	prepared = true;
+	return true;
+}
+
+bool DBStatement::run(MYSQL_BIND* params, size_t count, bool store)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(db.databaseLock);
+
+	while (true) {
+		if (!prepared || connectionId != db.connectionId) {
+			if (!prepare() && (!handle || !isLostConnectionError(mysql_stmt_errno(handle.get())))) {
+				return false;
+			}
+		}
+
+		if (prepared) {
+			if (mysql_stmt_param_count(handle.get()) != count) {
+				std::cout << "[Error - DBStatement::run] Query: " << query.substr(0, 256) << std::endl
+				          << "Message: expected " << mysql_stmt_param_count(handle.get()) << " parameters, got "
+				          << count << std::endl;
+				return false;
+			}
+
+			if ((count == 0 || mysql_stmt_bind_param(handle.get(), params) == 0) &&
+			    mysql_stmt_execute(handle.get()) == 0) {
+				if (store) {
+					if (storeResult()) {
+						return true;
+					}
+				} else {
+					// a result nobody reads would still block the connection
+					if (mysql_stmt_field_count(handle.get()) != 0) {
+						mysql_stmt_store_result(handle.get());
+						mysql_stmt_free_result(handle.get());
+					}
+					return true;
+				}
+			}
+
+			std::cout << "[Error - mysql_stmt_execute] Query: " << query.substr(0, 256) << std::endl
+			          << "Message: " << mysql_stmt_error(handle.get()) << std::endl;
+		}
+
+		const unsigned error = mysql_stmt_errno(handle.get());
+		if (!isLostConnectionError(error) || !db.retryQueries) {
+			return false;
+		}
+
+		db.handle = connectToDatabase(true);
+		++db.connectionId;
+	}
+}
+
+bool DBStatement::storeResult()
+{
+	using MysqlBool = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
+	struct Column
+	{
+		std::array<char, 64> data;
+		unsigned long length;
+		MysqlBool isNull;
+		MysqlBool error;
+	};
+
+	result = nullptr;
+
+	tfs::detail::MysqlResult_ptr metadata{mysql_stmt_result_metadata(handle.get())};
+	if (!metadata || mysql_stmt_store_result(handle.get()) != 0) {
+		return false;
+	}
+
+	// every column is read as text, short values straight into these buffers
+	const size_t columnCount = mysql_num_fields(metadata.get());
+	std::vector<Column> columns(columnCount);
+	std::vector<MYSQL_BIND> binds(columnCount);
+	for (size_t i = 0; i < columnCount; ++i) {
+		binds[i].buffer_type = MYSQL_TYPE_STRING;
+		binds[i].buffer = columns[i].data.data();
+		binds[i].buffer_length = columns[i].data.size();
+		binds[i].length = &columns[i].length;
+		binds[i].is_null = &columns[i].isNull;
+		binds[i].error = &columns[i].error;
+	}
+
+	if (mysql_stmt_bind_result(handle.get(), binds.data()) != 0) {
+		mysql_stmt_free_result(handle.get());
+		return false;
+	}
+
+	std::string buffer;
+	std::vector<size_t> offsets;
+	std::vector<unsigned long> lengths;
+
+	int status;
+	while ((status = mysql_stmt_fetch(handle.get())) == 0 || status == MYSQL_DATA_TRUNCATED) {
+		for (size_t i = 0; i < columnCount; ++i) {
+			const Column& column = columns[i];
+			if (column.isNull) {
+				offsets.push_back(std::string::npos);
+				lengths.push_back(0);
+				continue;
+			}
+
+			const size_t offset = buffer.size();
+			offsets.push_back(offset);
+			lengths.push_back(column.length);
+
+			if (column.length <= column.data.size()) {
+				buffer.append(column.data.data(), column.length);
+			} else {
+				// too long for the column buffer, fetch it again into its place
+				buffer.resize(offset + column.length);
+
+				MYSQL_BIND bind{};
+				bind.buffer_type = MYSQL_TYPE_STRING;
+				bind.buffer = buffer.data() + offset;
+				bind.buffer_length = column.length;
+				if (mysql_stmt_fetch_column(handle.get(), &bind, i, 0) != 0) {
+					mysql_stmt_free_result(handle.get());
+					return false;
+				}
+			}
+			buffer.push_back('\0');
+		}
+	}
+
+	mysql_stmt_free_result(handle.get());
+	if (status != MYSQL_NO_DATA) {
+		return false;
+	}
+
+	if (!offsets.empty()) {
+		result.reset(new DBResult(std::move(metadata), std::move(buffer), offsets, std::move(lengths)));
+	}
+	return true;
+}
+
+DBInsert::DBInsert(std::string query, Database& db) : db(db), query(std::move(query))
+{
+	this->length = this->query.length();
+}
 
 bool DBInsert::addRow(const std::string& row)
 {
 	// adds new row to buffer
 	const size_t rowLength = row.length();
 	length += rowLength;
-	if (length > Database::getInstance().getMaxPacketSize() && !execute()) {
+	if (length > db.getMaxPacketSize() && !execute()) {
 		return false;
 	}
 
@@ -244,8 +449,21 @@ bool DBInsert::execute()
 	}
 
 	// executes buffer
-	bool res = Database::getInstance().executeQuery(query + values);
+	bool res = db.executeQuery(query + values + suffix);
 	values.clear();
-	length = query.length();
+	length = query.length() + suffix.length();
 	return res;
 }
+
+void DBInsert::upsert(const std::vector<std::string_view>& columns)
+{
+	suffix = " ON DUPLICATE KEY UPDATE ";
+	for (size_t i = 0; i < columns.size(); ++i) {
+		if (i != 0) {
+			suffix += ", ";
+		}
+		const std::string_view column = columns[i];
+		suffix += fmt::format("`{:s}` = VALUES(`{:s}`)", column, column);
+	}
+	length = query.length() + values.length() + suffix.length();
+}
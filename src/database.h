@@ -4,9 +4,8 @@
 #ifndef FS_DATABASE_H
 #define FS_DATABASE_H
 
-#include "pugicast.h"
-
 class DBResult;
+class DBStatement;
 using DBResult_ptr = std::shared_ptr<DBResult>;
 
 namespace tfs::detail {
@@ -15,10 +14,39 @@ struct MysqlDeleter
 {
 	void operator()(MYSQL* handle) const { mysql_close(handle); }
 	void operator()(MYSQL_RES* handle) const { mysql_free_result(handle); }
+	void operator()(MYSQL_STMT* handle) const { mysql_stmt_close(handle); }
 };
 
 using Mysql_ptr = std::unique_ptr<MYSQL, MysqlDeleter>;
 using MysqlResult_ptr = std::unique_ptr<MYSQL_RES, MysqlDeleter>;
+using MysqlStatement_ptr = std::unique_ptr<MYSQL_STMT, MysqlDeleter>;
+
+template <typename T>
+T parseNumber(std::string_view value)
+{
+	const char* first = value.data();
+	const char* last = value.data() + value.size();
+	if constexpr (std::is_enum_v<T>) {
+		return static_cast<T>(parseNumber<std::underlying_type_t<T>>(value));
+	} else if constexpr (std::is_floating_point_v<T>) {
+		T result{};
+		std::from_chars(first, last, result);
+		return result;
+	} else if constexpr (std::is_signed_v<T>) {
+		int64_t result = 0;
+		std::from_chars(first, last, result);
+		return static_cast<T>(result);
+	} else {
+		// negative values wrap around, like they did with strtoull
+		if (value.starts_with('-')) {
+			return static_cast<T>(parseNumber<int64_t>(value));
+		}
+
+		uint64_t result = 0;
+		std::from_chars(first, last, result);
+		return static_cast<T>(result);
+	}
+}
 
 } // namespace tfs::detail
 
@@ -36,6 +64,13 @@ public:
 		return instance;
 	}
 
+	Database() = default;
+	~Database();
+
+	// non-copyable
+	Database(const Database&) = delete;
+	Database& operator=(const Database&) = delete;
+
 	/**
 	 * Connects to the database
 	 *
@@ -101,6 +136,17 @@ public:
 
 	uint64_t getMaxPacketSize() const { return maxPacketSize; }
 
+	/**
+	 * Prepared statement for a query with ? placeholders.
+	 *
+	 * The statement is prepared once per connection and kept until the
+	 * database is destroyed, so the query should be a constant.
+	 *
+	 * @param query query text
+	 * @return statement to execute the query with
+	 */
+	DBStatement& prepare(std::string_view query);
+
 private:
 	/**
 	 * Transaction related methods.
@@ -115,11 +161,15 @@ private:
 	bool commit();
 
 	tfs::detail::Mysql_ptr handle = nullptr;
+	// incremented whenever the connection is replaced, statements prepared before are gone then
+	uint64_t connectionId = 0;
+	std::map<std::string, std::unique_ptr<DBStatement>, std::less<>> statements;
 	std::recursive_mutex databaseLock;
 	uint64_t maxPacketSize = 1048576;
 	// Do not retry queries if we are in the middle of a transaction
 	bool retryQueries = true;
 
+	friend class DBStatement;
 	friend class DBTransaction;
 };
 
@@ -141,26 +191,146 @@ public:
 			          << std::endl;
 			return {};
 		}
+		return getNumber<T>(it->second);
+	}
 
-		if (!row[it->second]) {
+	/**
+	 * Reads a column by its position in the select list, without looking
+	 * up its name.
+	 */
+	template <typename T>
+	T getNumber(size_t index) const
+	{
+		if (index >= columns || !row[index]) {
 			return {};
 		}
-
-		return pugi::cast<T>(row[it->second]);
+		return tfs::detail::parseNumber<T>({row[index], lengths[index]});
 	}
 
 	std::string_view getString(std::string_view column) const;
+	std::string_view getString(size_t index) const;
 
 	bool hasNext() const;
 	bool next();
 
 private:
+	// rows of a prepared statement, fetched up front so the statement can be reused right away
+	DBResult(tfs::detail::MysqlResult_ptr&& metadata, std::string&& buffer, const std::vector<size_t>& offsets,
+	         std::vector<unsigned long>&& cellLengths);
+
+	void setColumns();
+
 	tfs::detail::MysqlResult_ptr handle;
-	MYSQL_ROW row;
+	MYSQL_ROW row = nullptr;
+	unsigned long* lengths = nullptr;
+	size_t columns = 0;
+
+	std::string buffer;
+	std::vector<char*> cells;
+	std::vector<unsigned long> cellLengths;
+	size_t nextCell = 0;
 
 	std::map<std::string_view, size_t> listNames;
 
 	friend class Database;
+	friend class DBStatement;
+};
+
+/**
+ * Query prepared on the server with mysql_stmt_*, executed with parameters
+ * bound in place of its ? placeholders. Numbers are sent in binary, strings
+ * as they are, neither needs formatting nor escaping.
+ *
+ * Statements are owned by their Database, see Database::prepare.
+ */
+class DBStatement
+{
+public:
+	DBStatement(Database& db, std::string query) : db{db}, query{std::move(query)} {}
+
+	// non-copyable
+	DBStatement(const DBStatement&) = delete;
+	DBStatement& operator=(const DBStatement&) = delete;
+
+	/**
+	 * Executes a statement which doesn't generate results.
+	 *
+	 * @return true on success, false on error
+	 */
+	template <typename... Args>
+	bool executeQuery(const Args&... args)
+	{
+		std::array<MYSQL_BIND, sizeof...(Args)> params{};
+		std::array<Param, sizeof...(Args)> values{};
+		[[maybe_unused]] size_t index = 0;
+		((bindParam(params[index], values[index], args), ++index), ...);
+		return run(params.data(), params.size(), false);
+	}
+
+	/**
+	 * Executes a statement which generates results.
+	 *
+	 * @return results object (nullptr on error or when there are no rows)
+	 */
+	template <typename... Args>
+	DBResult_ptr storeQuery(const Args&... args)
+	{
+		std::array<MYSQL_BIND, sizeof...(Args)> params{};
+		std::array<Param, sizeof...(Args)> values{};
+		[[maybe_unused]] size_t index = 0;
+		((bindParam(params[index], values[index], args), ++index), ...);
+
+		// the result is kept in the statement, which other threads may run as well
+		std::lock_guard<std::recursive_mutex> lockGuard(db.databaseLock);
+		if (!run(params.data(), params.size(), true)) {
+			return nullptr;
+		}
+		return std::move(result);
+	}
+
+private:
+	union Param
+	{
+		int64_t integer;
+		double real;
+	};
+
+	template <typename T>
+	static void bindParam(MYSQL_BIND& bind, Param& value, const T& arg)
+	{
+		if constexpr (std::is_enum_v<T>) {
+			bindParam(bind, value, static_cast<std::underlying_type_t<T>>(arg));
+		} else if constexpr (std::is_same_v<T, bool> || std::is_integral_v<T>) {
+			value.integer = static_cast<int64_t>(arg);
+			bind.buffer_type = MYSQL_TYPE_LONGLONG;
+			bind.buffer = &value.integer;
+			bind.is_unsigned = std::is_unsigned_v<T>;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			value.real = arg;
+			bind.buffer_type = MYSQL_TYPE_DOUBLE;
+			bind.buffer = &value.real;
+		} else if constexpr (std::is_same_v<T, std::nullptr_t>) {
+			bind.buffer_type = MYSQL_TYPE_NULL;
+		} else {
+			const std::string_view string = arg;
+			bind.buffer_type = MYSQL_TYPE_BLOB;
+			bind.buffer = const_cast<char*>(string.data());
+			bind.buffer_length = string.size();
+		}
+	}
+
+	bool prepare();
+	bool run(MYSQL_BIND* params, size_t count, bool store);
+	bool storeResult();
+
+	Database& db;
+	std::string query;
+	tfs::detail::MysqlStatement_ptr handle;
+	// connection the statement was prepared on
+	uint64_t connectionId = 0;
+	bool prepared = false;
+	// result of the last query, handed out by storeQuery()
+	DBResult_ptr result;
 };
 
 /**
@@ -169,26 +339,31 @@ private:
 class DBInsert
 {
 public:
-	explicit DBInsert(std::string query);
+	explicit DBInsert(std::string query, Database& db = Database::getInstance());
 	bool addRow(const std::string& row);
 	bool addRow(std::ostringstream& row);
 	bool execute();
 
+	// rows that already exist get these columns updated instead of failing the insert
+	void upsert(const std::vector<std::string_view>& columns);
+
 private:
+	Database& db;
 	std::string query;
 	std::string values;
+	std::string suffix;
 	size_t length;
 };
 
 class DBTransaction
 {
 public:
-	constexpr DBTransaction() = default;
+	explicit DBTransaction(Database& db = Database::getInstance()) : db{db} {}
 
 	~DBTransaction()
 	{
 		if (state == STATE_START) {
-			Database::getInstance().rollback();
+			db.rollback();
 		}
 	}
 
@@ -199,7 +374,7 @@ public:
 	bool begin()
 	{
 		state = STATE_START;
-		return Database::getInstance().beginTransaction();
+		return db.beginTransaction();
 	}
 
 	bool commit()
@@ -209,7 +384,7 @@ public:
 		}
 
 		state = STATE_COMMIT;
-		return Database::getInstance().commit();
+		return db.commit();
 	}
 
 private:
@@ -220,6 +395,7 @@ private:
 		STATE_COMMIT,
 	};
 
+	Database& db;
 	TransactionStates_t state = STATE_NO_START;
 };
 
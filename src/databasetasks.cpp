@@ -5,54 +5,130 @@
 
 #include "databasetasks.h"
 
+#include "profiler.h"
 #include "tasks.h"
 
 extern Dispatcher g_dispatcher;
 
-void DatabaseTasks::start()
+namespace {
+
+size_t getBucket(uint64_t value, size_t buckets) { return std::min<size_t>(std::bit_width(value), buckets - 1); }
+
+} // namespace
+
+bool DatabaseTasks::start(size_t workers)
+{
+	workers = std::max<size_t>(workers, 1);
+
+	connections.reserve(workers);
+	for (size_t i = 0; i < workers; ++i) {
+		auto& db = connections.emplace_back(std::make_unique<Database>());
+		if (!db->connect()) {
+			std::cout << "[Error - DatabaseTasks::start] Database worker " << i + 1 << " of " << workers
+			          << " could not connect, check max_connections of the server or lower databaseWorkers."
+			          << std::endl;
+			connections.clear();
+			return false;
+		}
+	}
+
+	threadState.store(THREAD_STATE_RUNNING, std::memory_order_relaxed);
+
+	threads.reserve(workers);
+	for (auto& db : connections) {
+		threads.emplace_back(&DatabaseTasks::threadMain, this, std::ref(*db));
+	}
+	return true;
+}
+
+void DatabaseTasks::stop()
+{
+	std::lock_guard<std::mutex> lockGuard(taskLock);
+	threadState.store(THREAD_STATE_CLOSING, std::memory_order_relaxed);
+}
+
+void DatabaseTasks::join()
 {
-	db.connect();
-	ThreadHolder::start();
+	for (auto& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
 }
 
-void DatabaseTasks::threadMain()
+void DatabaseTasks::threadMain(Database& db)
 {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
-			taskSignal.wait(taskLockUnique);
+	std::unique_lock<std::mutex> lock(taskLock);
+	while (true) {
+		taskSignal.wait(lock, [this]() {
+			return !readyLanes.empty() || threadState.load(std::memory_order_relaxed) == THREAD_STATE_TERMINATED;
+		});
+		if (readyLanes.empty()) {
+			// terminated, and everything queued is taken or waits for a lane another worker runs
+			break;
 		}
 
-		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
-			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
+		const uint64_t key = readyLanes.front();
+		readyLanes.pop_front();
+		auto lane = lanes.find(key);
+		lane->second.running = true;
+		DatabaseTask task = std::move(lane->second.tasks.front());
+		lane->second.tasks.pop_front();
+		lock.unlock();
+
+		const bool success = runTask(db, task);
+
+		lock.lock();
+		// the lane moved to the back, other keys get their turn before the next task of this one
+		lane = lanes.find(key);
+		if (lane->second.tasks.empty()) {
+			lanes.erase(lane);
 		} else {
-			taskLockUnique.unlock();
+			lane->second.running = false;
+			readyLanes.push_back(key);
+		}
+
+		const uint64_t latency =
+		    std::chrono::duration_cast<std::chrono::microseconds>(DatabaseTask::Clock::now() - task.queuedAt).count();
+		++stats.tasks;
+		if (!success) {
+			++stats.failures;
+		}
+		stats.totalLatency += latency;
+		stats.maxLatency = std::max(stats.maxLatency, latency);
+		++stats.latencies[getBucket(latency / 1000, LATENCY_BUCKETS)];
+
+		if (--pendingTasks == 0) {
+			doneSignal.notify_all();
 		}
 	}
 }
 
 void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback /* = nullptr*/,
-                            bool store /* = false*/)
+                            bool store /* = false*/, uint64_t key /* = 0*/)
 {
-	bool signal = false;
-	taskLock.lock();
-	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
-	}
-	taskLock.unlock();
+	{
+		std::lock_guard<std::mutex> lockGuard(taskLock);
+		if (threadState.load(std::memory_order_relaxed) != THREAD_STATE_RUNNING) {
+			return;
+		}
 
-	if (signal) {
-		taskSignal.notify_one();
+		++stats.depths[getBucket(pendingTasks, DEPTH_BUCKETS)];
+		stats.totalDepth += pendingTasks;
+		Lane& lane = lanes[key];
+		lane.tasks.emplace_back(std::move(query), std::move(callback), store, key);
+		if (!lane.running && lane.tasks.size() == 1) {
+			readyLanes.push_back(key);
+		}
+		stats.maxPending = std::max(stats.maxPending, ++pendingTasks);
 	}
+	taskSignal.notify_one();
 }
 
-void DatabaseTasks::runTask(const DatabaseTask& task)
+bool DatabaseTasks::runTask(Database& db, const DatabaseTask& task)
 {
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::DATABASE_TASK};
+
 	bool success;
 	DBResult_ptr result;
 	if (task.store) {
@@ -64,27 +140,49 @@ void DatabaseTasks::runTask(const DatabaseTask& task)
 	}
 
 	if (task.callback) {
-		g_dispatcher.addTask([=, callback = task.callback]() { callback(result, success); });
+		std::lock_guard<std::mutex> lockGuard(taskLock);
+		if (threadState.load(std::memory_order_relaxed) == THREAD_STATE_RUNNING) {
+			g_dispatcher.addTask([=, callback = task.callback]() { callback(result, success); });
+		} else {
+			// the dispatcher is stopped right after the workers and would drop the callback, shutdown runs it
+			stoppedCallbacks.emplace_back([=, callback = task.callback]() { callback(result, success); });
+		}
 	}
+	return success;
 }
 
 void DatabaseTasks::flush()
 {
-	std::unique_lock<std::mutex> guard{taskLock};
-	while (!tasks.empty()) {
-		auto task = std::move(tasks.front());
-		tasks.pop_front();
-		guard.unlock();
-		runTask(task);
-		guard.lock();
-	}
+	std::unique_lock<std::mutex> lock(taskLock);
+	doneSignal.wait(lock, [this]() { return pendingTasks == 0; });
 }
 
 void DatabaseTasks::shutdown()
 {
-	taskLock.lock();
-	setState(THREAD_STATE_TERMINATED);
-	taskLock.unlock();
+	{
+		std::lock_guard<std::mutex> lockGuard(taskLock);
+		threadState.store(THREAD_STATE_TERMINATED, std::memory_order_relaxed);
+	}
+	taskSignal.notify_all();
+
 	flush();
-	taskSignal.notify_one();
+
+	// Game::shutdown calls this on the dispatcher thread, which is stopped by then and no longer takes tasks
+	std::vector<std::function<void()>> callbacks;
+	{
+		std::lock_guard<std::mutex> lockGuard(taskLock);
+		callbacks.swap(stoppedCallbacks);
+	}
+	for (auto& callback : callbacks) {
+		callback();
+	}
+}
+
+DatabaseTasks::Stats DatabaseTasks::getStats() const
+{
+	std::lock_guard<std::mutex> lockGuard(taskLock);
+	Stats result = stats;
+	result.pending = pendingTasks;
+	result.workers = threads.size();
+	return result;
 }
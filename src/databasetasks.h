@@ -5,39 +5,111 @@
 #define FS_DATABASETASKS_H
 
 #include "database.h"
-#include "thread_holder_base.h"
+#include "enums.h"
 
 struct DatabaseTask
 {
-	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
-	    query(std::move(query)), callback(std::move(callback)), store(store)
+	using Clock = std::chrono::steady_clock;
+
+	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store, uint64_t key) :
+	    query(std::move(query)), callback(std::move(callback)), store(store), key(key), queuedAt(Clock::now())
 	{}
 
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
 	bool store;
+	uint64_t key;
+	Clock::time_point queuedAt;
 };
 
-class DatabaseTasks : public ThreadHolder<DatabaseTasks>
+/**
+ * @brief Runs asynchronous queries on a pool of worker threads, each with its own database connection.
+ *
+ * Tasks sharing a key (a player or account id, for example) run one at a time and in the order they were added, tasks
+ * of different keys run in parallel. Tasks without a key share key 0, so they keep running in the order they were
+ * added, as they did on a single thread. Callbacks are handed to the dispatcher.
+ */
+class DatabaseTasks
 {
 public:
+	// latencies are counted in buckets of [2^(i-1), 2^i) milliseconds, the last one takes everything above
+	static constexpr size_t LATENCY_BUCKETS = 12;
+	// queue depths found when adding a task, bucketed the same way
+	static constexpr size_t DEPTH_BUCKETS = 12;
+
+	struct Stats
+	{
+		uint64_t tasks = 0;
+		uint64_t failures = 0;
+		// microseconds from queueing a task until it ran
+		uint64_t totalLatency = 0;
+		uint64_t maxLatency = 0;
+		std::array<uint64_t, LATENCY_BUCKETS> latencies = {};
+		std::array<uint64_t, DEPTH_BUCKETS> depths = {};
+		// of the depths found when adding a task
+		uint64_t totalDepth = 0;
+		size_t pending = 0;
+		size_t maxPending = 0;
+		size_t workers = 0;
+	};
+
 	DatabaseTasks() = default;
-	void start();
+
+	// non-copyable
+	DatabaseTasks(const DatabaseTasks&) = delete;
+	DatabaseTasks& operator=(const DatabaseTasks&) = delete;
+
+	/**
+	 * @brief Connects a database connection for every worker and starts them, nothing is started if one of them cannot
+	 * connect.
+	 */
+	bool start(size_t workers);
+	void stop();
+	void join();
+
+	/**
+	 * @brief Blocks until every queued or running task is done.
+	 */
 	void flush();
+
+	/**
+	 * @brief Stops accepting tasks and blocks until the queued ones are done, the workers exit afterwards.
+	 *
+	 * Callbacks of tasks that finished after stop are run here, on the calling thread, since the dispatcher no longer
+	 * takes them.
+	 */
 	void shutdown();
 
-	void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+	void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false,
+	             uint64_t key = 0);
 
-	void threadMain();
+	Stats getStats() const;
 
 private:
-	void runTask(const DatabaseTask& task);
+	void threadMain(Database& db);
+	bool runTask(Database& db, const DatabaseTask& task);
+
+	std::vector<std::unique_ptr<Database>> connections;
+	std::vector<std::thread> threads;
+
+	// the queued tasks of a key, the lane is in readyLanes unless it is empty or its first task is running
+	struct Lane
+	{
+		std::deque<DatabaseTask> tasks;
+		bool running = false;
+	};
+
+	std::unordered_map<uint64_t, Lane> lanes;
+	std::deque<uint64_t> readyLanes;
+	size_t pendingTasks = 0;
+	Stats stats;
+	// callbacks of tasks that finished once the workers were stopped, see shutdown
+	std::vector<std::function<void()>> stoppedCallbacks;
 
-	Database db;
-	std::thread thread;
-	std::list<DatabaseTask> tasks;
-	std::mutex taskLock;
+	std::atomic<ThreadState> threadState{THREAD_STATE_TERMINATED};
+	mutable std::mutex taskLock;
 	std::condition_variable taskSignal;
+	std::condition_variable doneSignal;
 };
 
 extern DatabaseTasks g_databaseTasks;
@@ -5,8 +5,6 @@
 
 #include "fileloader.h"
 
-#include <stack>
-
 namespace OTB {
 
 constexpr Identifier wildcard = {{'\0', '\0', '\0', '\0'}};
@@ -25,75 +23,138 @@ Loader::Loader(const std::string& fileName, const Identifier& acceptedIdentifier
 	}
 }
 
-using NodeStack = std::stack<Node*, std::vector<Node*>>;
-static Node& getCurrentNode(const NodeStack& nodeStack)
-{
-	if (nodeStack.empty()) {
-		throw InvalidOTBFormat{};
-	}
-	return *nodeStack.top();
-}
+namespace {
+
+constexpr uint64_t repeat(uint8_t byte) { return 0x0101010101010101 * byte; }
 
-const Node& Loader::parseTree()
+// Reads the nodes nested in node, from the first byte after its type up to and including its END marker. Nodes more
+// than maxDepth levels below node are only skipped over. Returns the position right after the END marker of node.
+ContentIt parseNode(Node& node, ContentIt it, ContentIt end, size_t maxDepth)
 {
-	auto it = fileContents.begin() + sizeof(Identifier);
-	if (static_cast<uint8_t>(*it) != Node::START) {
-		throw InvalidOTBFormat{};
-	}
-	root.type = *(++it);
-	root.propsBegin = ++it;
-	NodeStack parseStack;
-	parseStack.push(&root);
+	std::vector<Node*> parseStack{&node};
+	size_t skipped = 0;
 
-	for (; it != fileContents.end(); ++it) {
+	for (it = findMarker(it, end); it != end; it = findMarker(it + 1, end)) {
 		switch (static_cast<uint8_t>(*it)) {
 			case Node::START: {
-				auto& currentNode = getCurrentNode(parseStack);
-				if (currentNode.children.empty()) {
+				auto& currentNode = *parseStack.back();
+				if (currentNode.propsEnd == ContentIt{}) {
 					currentNode.propsEnd = it;
 				}
-				currentNode.children.emplace_back();
-				auto& child = currentNode.children.back();
-				if (++it == fileContents.end()) {
+
+				// the type byte is never escaped
+				if (++it == end) {
 					throw InvalidOTBFormat{};
 				}
+
+				if (skipped > 0 || parseStack.size() > maxDepth) {
+					++skipped;
+					break;
+				}
+
+				auto& child = currentNode.children.emplace_back();
 				child.type = *it;
 				child.propsBegin = it + sizeof(Node::type);
-				parseStack.push(&child);
+				parseStack.push_back(&child);
 				break;
 			}
 			case Node::END: {
-				auto& currentNode = getCurrentNode(parseStack);
-				if (currentNode.children.empty()) {
+				if (skipped > 0) {
+					--skipped;
+					break;
+				}
+
+				auto& currentNode = *parseStack.back();
+				if (currentNode.propsEnd == ContentIt{}) {
 					currentNode.propsEnd = it;
 				}
-				parseStack.pop();
+				currentNode.end = it;
+
+				parseStack.pop_back();
+				if (parseStack.empty()) {
+					return it + 1;
+				}
 				break;
 			}
 			case Node::ESCAPE: {
-				if (++it == fileContents.end()) {
+				if (++it == end) {
 					throw InvalidOTBFormat{};
 				}
 				break;
 			}
-			default: {
-				break;
+		}
+	}
+	throw InvalidOTBFormat{};
+}
+
+} // namespace
+
+ContentIt findMarker(ContentIt it, ContentIt end)
+{
+	// looks at 8 bytes at once, every marker is above 0xFC so a byte is one when its high bit is set and adding 3 to
+	// the low 7 bits carries into the high bit, which can never spill into the next byte
+	while (end - it >= static_cast<std::ptrdiff_t>(sizeof(uint64_t))) {
+		uint64_t word;
+		std::memcpy(&word, it, sizeof(word));
+
+		const uint64_t markers = ((word & repeat(0x7F)) + repeat(0x03)) & word & repeat(0x80);
+		if (markers != 0) {
+			if constexpr (std::endian::native == std::endian::little) {
+				return it + std::countr_zero(markers) / 8;
+			} else {
+				return it + std::countl_zero(markers) / 8;
 			}
 		}
+		it += sizeof(word);
 	}
-	if (!parseStack.empty()) {
+
+	return std::find_if(it, end, [](char byte) { return static_cast<uint8_t>(byte) >= Node::ESCAPE; });
+}
+
+const Node& Loader::parseTree(size_t maxDepth)
+{
+	auto it = fileContents.begin() + sizeof(Identifier);
+	if (static_cast<uint8_t>(*it) != Node::START) {
 		throw InvalidOTBFormat{};
 	}
+	root.type = *(++it);
+	root.propsBegin = ++it;
+
+	// only escaped bytes may follow the root node
+	const auto end = fileContents.end();
+	for (it = findMarker(parseNode(root, it, end, maxDepth), end); it != end; it = findMarker(it + 1, end)) {
+		if (static_cast<uint8_t>(*it) != Node::ESCAPE || ++it == end) {
+			throw InvalidOTBFormat{};
+		}
+	}
 
 	return root;
 }
 
-bool Loader::getProps(const Node& node, PropStream& props)
+Node Loader::parseSubtree(const Node& node) const
+{
+	Node subtree{
+	    .children = {}, .propsBegin = node.propsBegin, .propsEnd = node.propsEnd, .end = node.end, .type = node.type};
+	if (node.propsEnd != node.end) {
+		parseNode(subtree, node.propsEnd, node.end + 1, std::numeric_limits<size_t>::max());
+	}
+	return subtree;
+}
+
+bool Loader::getProps(const Node& node, PropStream& props) const
 {
 	auto size = std::distance(node.propsBegin, node.propsEnd);
 	if (size == 0) {
 		return false;
 	}
+
+	// most nodes have nothing escaped, those are read straight from the mapped file
+	if (!std::memchr(node.propsBegin, Node::ESCAPE, size)) {
+		props.init(node.propsBegin, size);
+		return true;
+	}
+
+	static thread_local std::vector<char> propBuffer;
 	propBuffer.resize(size);
 	bool lastEscaped = false;
 
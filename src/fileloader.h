@@ -16,9 +16,11 @@ struct Node
 	using ChildrenVector = std::vector<Node>;
 
 	ChildrenVector children;
-	ContentIt propsBegin;
-	ContentIt propsEnd;
-	uint8_t type;
+	ContentIt propsBegin{};
+	ContentIt propsEnd{};
+	// the END marker of the node, children left to Loader::parseSubtree lie between propsEnd and here
+	ContentIt end{};
+	uint8_t type = 0;
 	enum NodeChar : uint8_t
 	{
 		ESCAPE = 0xFD,
@@ -41,14 +43,25 @@ class Loader
 {
 	MappedFile fileContents;
 	Node root;
-	std::vector<char> propBuffer;
 
 public:
 	Loader(const std::string& fileName, const Identifier& acceptedIdentifier);
-	bool getProps(const Node& node, PropStream& props);
-	const Node& parseTree();
+
+	// The stream stays valid until the next node with escaped bytes is read on the same thread, any number of threads
+	// may read properties at once
+	bool getProps(const Node& node, PropStream& props) const;
+
+	// Builds the tree down to maxDepth levels below the root, deeper nodes are only skipped over and can be built
+	// later with parseSubtree
+	const Node& parseTree(size_t maxDepth = std::numeric_limits<size_t>::max());
+
+	// Returns a copy of a node parseTree stopped at with all its descendants, safe to call from several threads at once
+	Node parseSubtree(const Node& node) const;
 };
 
+// Returns the first byte in [it, end) that is one of the node markers, or end
+ContentIt findMarker(ContentIt it, ContentIt end);
+
 } // namespace OTB
 
 class PropStream
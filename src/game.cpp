@@ -25,7 +25,9 @@
 #include "npc.h"
 #include "outfit.h"
 #include "party.h"
+#include "playersaver.h"
 #include "podium.h"
+#include "profiler.h"
 #include "scheduler.h"
 #include "script.h"
 #include "server.h"
@@ -65,6 +67,8 @@ void Game::start(ServiceManager* manager)
 {
 	serviceManager = manager;
 
+	pathfindingPool.start(std::max(getNumber(ConfigManager::PATHFINDING_THREADS), 0));
+
 	g_scheduler.addEvent(createSchedulerTask(EVENT_CREATURE_THINK_INTERVAL, [this]() { checkCreatures(0); }));
 	g_scheduler.addEvent(
 	    createSchedulerTask(getNumber(ConfigManager::PATHFINDING_INTERVAL), [this]() { updateCreaturesPath(0); }));
@@ -156,9 +160,25 @@ void Game::saveGameState()
 
 	std::cout << "Saving server..." << std::endl;
 
+	struct SaveResults
+	{
+		size_t pending;
+		size_t failed = 0;
+	};
+
+	auto results = std::make_shared<SaveResults>(players.size());
 	for (const auto& it : players) {
 		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+		IOLoginData::savePlayer(it.second, [results](bool saved) {
+			if (!saved) {
+				++results->failed;
+			}
+
+			if (--results->pending == 0 && results->failed != 0) {
+				std::cout << "[Warning - Game::saveGameState] " << results->failed << " players could not be saved."
+				          << std::endl;
+			}
+		});
 	}
 
 	Map::save();
@@ -1282,9 +1302,7 @@ ReturnValue Game::internalMoveItem(Cylinder* fromCylinder, Cylinder* toCylinder,
 
 	if (moveItem && moveItem->getDuration() > 0) {
 		if (moveItem->getDecaying() != DECAYING_TRUE) {
-			moveItem->incrementReferenceCounter();
-			moveItem->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(moveItem);
+			scheduleDecay(moveItem);
 		}
 	}
 
@@ -1386,9 +1404,7 @@ ReturnValue Game::internalAddItem(Cylinder* toCylinder, Item* item, int32_t inde
 
 	if (item->getDuration() > 0) {
 		if (item->getDecaying() != DECAYING_TRUE) {
-			item->incrementReferenceCounter();
-			item->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(item);
+			scheduleDecay(item);
 		}
 	}
 
@@ -1432,9 +1448,7 @@ ReturnValue Game::internalRemoveItem(Item* item, int32_t count /*= -1*/, bool te
 
 		if (item->isRemoved()) {
 			item->onRemoved();
-			if (item->canDecay()) {
-				decayItems->remove(item);
-			}
+			stopDecay(item);
 			ReleaseItem(item);
 		}
 
@@ -1754,9 +1768,7 @@ Item* Game::transformItem(Item* item, uint16_t newId, int32_t newCount /*= -1*/)
 
 	if (newItem->getDuration() > 0) {
 		if (newItem->getDecaying() != DECAYING_TRUE) {
-			newItem->incrementReferenceCounter();
-			newItem->setDecaying(DECAYING_TRUE);
-			toDecayItems.push_front(newItem);
+			scheduleDecay(newItem);
 		}
 	}
 
@@ -3631,13 +3643,18 @@ void Game::playerWhisper(Player* player, const std::string& text)
 	map.getSpectators(spectators, player->getPosition(), false, false, Map::maxClientViewportX, Map::maxClientViewportX,
 	                  Map::maxClientViewportY, Map::maxClientViewportY);
 
-	// send to client
+	// send to client, only the players next to the speaker hear the words
+	NetworkMessage msg, farMsg;
+	ProtocolGame::AddCreatureSay(msg, player, TALKTYPE_WHISPER, text);
+	ProtocolGame::AddCreatureSay(farMsg, player, TALKTYPE_WHISPER, "pspsps");
+
+	const Position& playerPosition = player->getPosition();
 	for (Creature* spectator : spectators) {
 		if (Player* spectatorPlayer = spectator->getPlayer()) {
-			if (!player->getPosition().isInRange(spectatorPlayer->getPosition(), 1, 1)) {
-				spectatorPlayer->sendCreatureSay(player, TALKTYPE_WHISPER, "pspsps");
+			if (!playerPosition.isInRange(spectatorPlayer->getPosition(), 1, 1)) {
+				spectatorPlayer->sendNetworkMessage(farMsg);
 			} else {
-				spectatorPlayer->sendCreatureSay(player, TALKTYPE_WHISPER, text);
+				spectatorPlayer->sendNetworkMessage(msg);
 			}
 		}
 	}
@@ -3803,13 +3820,10 @@ bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, const std:
 	}
 
 	// send to client
-	for (Creature* spectator : spectators) {
-		if (Player* tmpPlayer = spectator->getPlayer()) {
-			if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-				tmpPlayer->sendCreatureSay(creature, type, text, pos);
-			}
-		}
-	}
+	NetworkMessage msg;
+	ProtocolGame::AddCreatureSay(msg, creature, type, text, pos);
+	broadcastMessage(spectators, msg,
+	                 [=](const Player* tmpPlayer) { return !ghostMode || tmpPlayer->canSeeCreature(creature); });
 
 	// event method
 	if (!echo) {
@@ -3836,6 +3850,9 @@ void Game::updateCreatureWalk(uint32_t creatureId)
 	Creature* creature = getCreatureByID(creatureId);
 	if (creature && !creature->isDead()) {
 		creature->goToFollowCreature();
+
+		// a path searched ahead is only meant for this update
+		creature->discardFollowPath();
 	}
 }
 
@@ -3856,8 +3873,18 @@ void Game::addCreatureCheck(Creature* creature)
 		return;
 	}
 
+	auto& checkCreatureList = checkCreatureLists[uniform_random(0, EVENT_CREATURECOUNT - 1)];
+	if (Player* player = creature->getPlayer()) {
+		checkCreatureList.players.push_back(player);
+	} else if (Monster* monster = creature->getMonster()) {
+		checkCreatureList.monsters.push_back(monster);
+	} else if (Npc* npc = creature->getNpc()) {
+		checkCreatureList.npcs.push_back(npc);
+	} else {
+		return;
+	}
+
 	creature->inCheckCreaturesVector = true;
-	checkCreatureLists[uniform_random(0, EVENT_CREATURECOUNT - 1)].push_back(creature);
 	creature->incrementReferenceCounter();
 }
 
@@ -3868,28 +3895,41 @@ void Game::removeCreatureCheck(Creature* creature)
 	}
 }
 
+static_assert(EVENT_CREATURECOUNT == tfs::profiler::CREATURE_BUCKETS, "every think bucket needs a histogram");
+
 void Game::checkCreatures(size_t index)
 {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_CHECK_CREATURE_INTERVAL,
 	                                         [=, this]() { checkCreatures((index + 1) % EVENT_CREATURECOUNT); }));
 
-	auto& checkCreatureList = checkCreatureLists[index];
-	auto it = checkCreatureList.begin(), end = checkCreatureList.end();
-	while (it != end) {
-		Creature* creature = *it;
-		if (creature->creatureCheck) {
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::CHECK_CREATURES,
+	                                 &tfs::profiler::getCreatureBucketHistogram(index)};
+
+	auto think = [this](auto& creatures) {
+		// by index, a creature may be added to this very bucket while the others think
+		for (size_t i = 0; i < creatures.size();) {
+			auto creature = creatures[i];
+			if (!creature->creatureCheck) {
+				creature->inCheckCreaturesVector = false;
+				creatures[i] = creatures.back();
+				creatures.pop_back();
+				ReleaseCreature(creature);
+				continue;
+			}
+
 			if (!creature->isDead()) {
 				creature->onThink(EVENT_CREATURE_THINK_INTERVAL);
 				creature->onAttacking(EVENT_CREATURE_THINK_INTERVAL);
 				creature->executeConditions(EVENT_CREATURE_THINK_INTERVAL);
 			}
-			++it;
-		} else {
-			creature->inCheckCreaturesVector = false;
-			it = checkCreatureList.erase(it);
-			ReleaseCreature(creature);
+			++i;
 		}
-	}
+	};
+
+	auto& checkCreatureList = checkCreatureLists[index];
+	think(checkCreatureList.players);
+	think(checkCreatureList.monsters);
+	think(checkCreatureList.npcs);
 
 	cleanup();
 }
@@ -3900,11 +3940,24 @@ void Game::updateCreaturesPath(size_t index)
 	                                         [=, this]() { updateCreaturesPath((index + 1) % EVENT_CREATURECOUNT); }));
 
 	auto& checkCreatureList = checkCreatureLists[index];
-	for (Creature* creature : checkCreatureList) {
+	if (pathfindingPool.getThreadCount() > 0) {
+		// nothing changes the map while the dispatcher waits, so the whole bucket can be searched at once
+		pathfindingCreatures.clear();
+		checkCreatureList.forEach([this](Creature* creature) {
+			if (!creature->isDead() && creature->prepareFollowPath()) {
+				pathfindingCreatures.push_back(creature);
+			}
+		});
+
+		pathfindingPool.parallelFor(pathfindingCreatures.size(),
+		                            [this](size_t i) { pathfindingCreatures[i]->findFollowPath(); });
+	}
+
+	checkCreatureList.forEach([](Creature* creature) {
 		if (!creature->isDead()) {
 			creature->forceUpdatePath();
 		}
-	}
+	});
 }
 
 void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta)
@@ -3917,10 +3970,10 @@ void Game::changeSpeed(Creature* creature, int32_t varSpeedDelta)
 	// send to clients
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), false, true);
-	for (Creature* spectator : spectators) {
-		assert(dynamic_cast<Player*>(spectator) != nullptr);
-		static_cast<Player*>(spectator)->sendChangeSpeed(creature, creature->getStepSpeed());
-	}
+
+	NetworkMessage msg;
+	ProtocolGame::AddChangeSpeed(msg, creature, creature->getStepSpeed());
+	broadcastMessage(spectators, msg);
 }
 
 void Game::internalCreatureChangeOutfit(Creature* creature, const Outfit_t& outfit)
@@ -4691,11 +4744,9 @@ void Game::addCreatureHealth(const Creature* target)
 
 void Game::addCreatureHealth(const SpectatorVec& spectators, const Creature* target)
 {
-	for (Creature* spectator : spectators) {
-		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendCreatureHealth(target);
-		}
-	}
+	NetworkMessage msg;
+	ProtocolGame::AddCreatureHealth(msg, target);
+	broadcastMessage(spectators, msg);
 }
 
 void Game::addMagicEffect(const Position& pos, uint8_t effect)
@@ -4707,11 +4758,9 @@ void Game::addMagicEffect(const Position& pos, uint8_t effect)
 
 void Game::addMagicEffect(const SpectatorVec& spectators, const Position& pos, uint8_t effect)
 {
-	for (Creature* spectator : spectators) {
-		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendMagicEffect(pos, effect);
-		}
-	}
+	NetworkMessage msg;
+	ProtocolGame::AddMagicEffect(msg, pos, effect);
+	broadcastMessage(spectators, msg, [&pos](const Player* tmpPlayer) { return tmpPlayer->canSee(pos); });
 }
 
 void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uint8_t effect)
@@ -4727,11 +4776,9 @@ void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uin
 void Game::addDistanceEffect(const SpectatorVec& spectators, const Position& fromPos, const Position& toPos,
                              uint8_t effect)
 {
-	for (Creature* spectator : spectators) {
-		if (Player* tmpPlayer = spectator->getPlayer()) {
-			tmpPlayer->sendDistanceShoot(fromPos, toPos, effect);
-		}
-	}
+	NetworkMessage msg;
+	ProtocolGame::AddDistanceShoot(msg, fromPos, toPos, effect);
+	broadcastMessage(spectators, msg);
 }
 
 void Game::startDecay(Item* item)
@@ -4746,14 +4793,38 @@ void Game::startDecay(Item* item)
 	}
 
 	if (item->getDuration() > 0) {
-		item->incrementReferenceCounter();
-		item->setDecaying(DECAYING_TRUE);
-		toDecayItems.push_front(item);
+		scheduleDecay(item);
 	} else {
 		internalDecayItem(item);
 	}
 }
 
+void Game::scheduleDecay(Item* item)
+{
+	DecayTimer& timer = item->getDecayTimer();
+	if (!timer.isScheduled()) {
+		// the wheel holds a reference until the item expires or stops decaying
+		item->incrementReferenceCounter();
+		timer.item = item;
+	}
+
+	item->setDecaying(DECAYING_TRUE);
+	decayWheel.insert(&timer, OTSYS_TIME() + item->getDuration());
+}
+
+void Game::stopDecay(Item* item)
+{
+	if (!item->isDecayScheduled()) {
+		return;
+	}
+
+	const uint32_t duration = item->getDuration();
+	decayWheel.remove(&item->getDecayTimer());
+	item->setIntAttr(ITEM_ATTRIBUTE_DURATION, duration);
+	item->setDecaying(DECAYING_FALSE);
+	ReleaseItem(item);
+}
+
 void Game::internalDecayItem(Item* item)
 {
 	const int32_t decayTo = item->getDecayTo();
@@ -4776,43 +4847,23 @@ void Game::internalDecayItem(Item* item)
 void Game::checkDecay()
 {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }));
-	size_t bucket = (lastBucket + 1) % EVENT_DECAY_BUCKETS;
 
-	auto it = decayItems[bucket].begin(), end = decayItems[bucket].end();
-	while (it != end) {
-		Item* item = *it;
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::CHECK_DECAY};
+
+	// only the items that are due come out of the wheel, the others are not touched
+	decayWheel.advance(OTSYS_TIME(), [this](TimerNode* node) {
+		Item* item = static_cast<DecayTimer*>(node)->item;
 		if (!item->canDecay()) {
 			item->setDecaying(DECAYING_FALSE);
 			ReleaseItem(item);
-			it = decayItems[bucket].erase(it);
-			continue;
+			return;
 		}
 
-		int32_t duration = item->getDuration();
-		int32_t decreaseTime = std::min<int32_t>(EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS, duration);
-
-		duration -= decreaseTime;
-		item->decreaseDuration(decreaseTime);
-
-		if (duration <= 0) {
-			it = decayItems[bucket].erase(it);
-			internalDecayItem(item);
-			ReleaseItem(item);
-		} else if (duration < EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			it = decayItems[bucket].erase(it);
-			size_t newBucket = (bucket + ((duration + EVENT_DECAYINTERVAL / 2) / 1000)) % EVENT_DECAY_BUCKETS;
-			if (newBucket == bucket) {
-				internalDecayItem(item);
-				ReleaseItem(item);
-			} else {
-				decayItems[newBucket].push_back(item);
-			}
-		} else {
-			++it;
-		}
-	}
+		item->setIntAttr(ITEM_ATTRIBUTE_DURATION, 0);
+		internalDecayItem(item);
+		ReleaseItem(item);
+	});
 
-	lastBucket = bucket;
 	cleanup();
 }
 
@@ -4822,7 +4873,9 @@ void Game::shutdown()
 
 	g_scheduler.shutdown();
 	g_databaseTasks.shutdown();
+	g_playerSaver.shutdown();
 	g_dispatcher.shutdown();
+	pathfindingPool.shutdown();
 	map.spawns.clear();
 
 	cleanup();
@@ -4848,16 +4901,6 @@ void Game::cleanup()
 		item->decrementReferenceCounter();
 	}
 	ToReleaseItems.clear();
-
-	for (Item* item : toDecayItems) {
-		const uint32_t dur = item->getDuration();
-		if (dur >= EVENT_DECAYINTERVAL * EVENT_DECAY_BUCKETS) {
-			decayItems[lastBucket].push_back(item);
-		} else {
-			decayItems[(lastBucket + 1 + dur / 1000) % EVENT_DECAY_BUCKETS].push_back(item);
-		}
-	}
-	toDecayItems.clear();
 }
 
 void Game::ReleaseCreature(Creature* creature) { ToReleaseCreatures.push_back(creature); }
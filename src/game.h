@@ -9,7 +9,9 @@
 #include "mounts.h"
 #include "player.h"
 #include "position.h"
+#include "timingwheel.h"
 #include "wildcardtree.h"
+#include "workerpool.h"
 
 class Monster;
 class Npc;
@@ -45,7 +47,6 @@ enum GameState_t
 static constexpr int32_t PLAYER_NAME_LENGTH = 25;
 
 static constexpr int32_t EVENT_DECAYINTERVAL = 250;
-static constexpr int32_t EVENT_DECAY_BUCKETS = 4;
 
 static constexpr int32_t MOVE_CREATURE_INTERVAL = 1000;
 static constexpr int32_t RANGE_MOVE_CREATURE_INTERVAL = 1500;
@@ -204,6 +205,7 @@ public:
 
 	void addCreatureCheck(Creature* creature);
 	static void removeCreatureCheck(Creature* creature);
+	size_t getCheckCreatureCount(size_t index) const { return checkCreatureLists[index].size(); }
 
 	size_t getPlayersOnline() const { return players.size(); }
 	size_t getMonstersOnline() const { return monsters.size(); }
@@ -434,6 +436,27 @@ public:
 	bool combatChangeHealth(Creature* attacker, Creature* target, CombatDamage& damage);
 	bool combatChangeMana(Creature* attacker, Creature* target, CombatDamage& damage);
 
+	/**
+	 * @brief Sends a message built once to every player among the spectators that the filter accepts.
+	 *
+	 * Only messages that read the same for every player can be shared. Whether a player sees a position or a creature
+	 * is up to the filter, and messages that depend on the creatures a player already knows still have to be built per
+	 * player.
+	 */
+	template <typename Filter>
+	static void broadcastMessage(const SpectatorVec& spectators, const NetworkMessage& msg, Filter&& filter)
+	{
+		for (Creature* spectator : spectators) {
+			if (Player* tmpPlayer = spectator->getPlayer(); tmpPlayer && filter(tmpPlayer)) {
+				tmpPlayer->sendNetworkMessage(msg);
+			}
+		}
+	}
+	static void broadcastMessage(const SpectatorVec& spectators, const NetworkMessage& msg)
+	{
+		broadcastMessage(spectators, msg, [](const Player*) { return true; });
+	}
+
 	// animation help functions
 	void addCreatureHealth(const Creature* target);
 	static void addCreatureHealth(const SpectatorVec& spectators, const Creature* target);
@@ -444,6 +467,10 @@ public:
 	                              uint8_t effect);
 
 	void startDecay(Item* item);
+	// links an item into the decay wheel, to expire once its duration has passed
+	void scheduleDecay(Item* item);
+	// unlinks a decaying item and keeps what is left of its duration, does nothing if it is not decaying
+	void stopDecay(Item* item);
 
 	void sendOfflineTrainingDialog(Player* player);
 
@@ -485,8 +512,6 @@ public:
 	Map map;
 	Mounts mounts;
 
-	std::forward_list<Item*> toDecayItems;
-
 	std::unordered_set<Tile*> getTilesToClean() const { return tilesToClean; }
 	bool isTileInCleanList(Tile* tile) { return tilesToClean.find(tile) != tilesToClean.end(); }
 	void addTileToClean(Tile* tile) { tilesToClean.emplace(tile); }
@@ -503,20 +528,44 @@ private:
 	void checkDecay();
 	void internalDecayItem(Item* item);
 
+	// the creatures of one think bucket, grouped by kind so a pass over them calls into one final class at a time
+	struct CheckCreatureList
+	{
+		std::vector<Player*> players;
+		std::vector<Monster*> monsters;
+		std::vector<Npc*> npcs;
+
+		size_t size() const { return players.size() + monsters.size() + npcs.size(); }
+
+		template <typename F>
+		void forEach(F&& f) const
+		{
+			// by index, the callback may add creatures to the same bucket
+			for (size_t i = 0; i < players.size(); ++i) {
+				f(players[i]);
+			}
+			for (size_t i = 0; i < monsters.size(); ++i) {
+				f(monsters[i]);
+			}
+			for (size_t i = 0; i < npcs.size(); ++i) {
+				f(npcs[i]);
+			}
+		}
+	};
+
 	std::unordered_map<uint32_t, Player*> players;
 	std::unordered_map<std::string, Player*> mappedPlayerNames;
 	std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
 	std::unordered_map<uint32_t, Guild_ptr> guilds;
 	std::unordered_map<uint16_t, Item*> uniqueItems;
 
-	std::list<Item*> decayItems[EVENT_DECAY_BUCKETS];
-	std::list<Creature*> checkCreatureLists[EVENT_CREATURECOUNT];
+	// decaying items by absolute expiration, it ticks once per millisecond of OTSYS_TIME
+	TimingWheel decayWheel{static_cast<uint64_t>(OTSYS_TIME())};
+	std::array<CheckCreatureList, EVENT_CREATURECOUNT> checkCreatureLists;
 
 	std::vector<Creature*> ToReleaseCreatures;
 	std::vector<Item*> ToReleaseItems;
 
-	size_t lastBucket = 0;
-
 	WildcardTreeNode wildcardTree{false};
 
 	std::map<uint32_t, Npc*> npcs;
@@ -529,6 +578,10 @@ private:
 
 	std::unordered_set<Tile*> tilesToClean;
 
+	// searches the paths of a whole creature bucket in updateCreaturesPath
+	WorkerPool pathfindingPool;
+	std::vector<Creature*> pathfindingCreatures;
+
 	ModalWindow offlineTrainingWindow{std::numeric_limits<uint32_t>::max(), "Choose a Skill", "Please choose a skill:"};
 
 	GameState_t gameState = GAME_STATE_NORMAL;
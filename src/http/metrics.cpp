@@ -0,0 +1,296 @@
+#include "../otpch.h"
+
+#include "metrics.h"
+
+#include "../compression.h"
+#include "../configmanager.h"
+#include "../connection.h"
+#include "../databasetasks.h"
+#include "../game.h"
+#include "../outputmessage.h"
+#include "../playersaver.h"
+#include "../profiler.h"
+
+extern Game g_game;
+
+namespace beast = boost::beast;
+
+namespace {
+
+std::string escape_label(std::string_view value)
+{
+	std::string escaped;
+	escaped.reserve(value.size());
+	for (char c : value) {
+		if (c == '\\' || c == '"') {
+			escaped += '\\';
+			escaped += c;
+		} else if (c == '\n') {
+			escaped += "\\n";
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+// metric{labels}, or just the metric without labels
+std::string series(std::string_view metric, std::string_view labels)
+{
+	if (labels.empty()) {
+		return std::string{metric};
+	}
+	return fmt::format("{:s}{{{:s}}}", metric, labels);
+}
+
+void append_header(std::string& out, std::string_view metric, std::string_view type, std::string_view help)
+{
+	fmt::format_to(std::back_inserter(out), "# HELP {:s} {:s}\n# TYPE {:s} {:s}\n", metric, help, metric, type);
+}
+
+template <typename T>
+void append_sample(std::string& out, std::string_view metric, std::string_view labels, T value)
+{
+	fmt::format_to(std::back_inserter(out), "{:s} {}\n", series(metric, labels), value);
+}
+
+// bucket i counts values below 2^i units, the last one is everything else, whole numbers below 2^i are at most 2^i - 1
+void append_histogram(std::string& out, std::string_view metric, std::string_view labels,
+                      std::span<const uint64_t> buckets, double unit, double sum, bool whole = false)
+{
+	auto it = std::back_inserter(out);
+	const std::string prefix = labels.empty() ? std::string{} : fmt::format("{:s},", labels);
+
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i < buckets.size() - 1; ++i) {
+		cumulative += buckets[i];
+		const double bound = whole ? static_cast<double>((uint64_t{1} << i) - 1) : (uint64_t{1} << i) * unit;
+		fmt::format_to(it, "{:s}_bucket{{{:s}le=\"{:g}\"}} {:d}\n", metric, prefix, bound, cumulative);
+	}
+	cumulative += buckets.back();
+	fmt::format_to(it, "{:s}_bucket{{{:s}le=\"+Inf\"}} {:d}\n", metric, prefix, cumulative);
+	fmt::format_to(it, "{:s} {:g}\n", series(fmt::format("{:s}_sum", metric), labels), sum);
+	fmt::format_to(it, "{:s} {:d}\n", series(fmt::format("{:s}_count", metric), labels), cumulative);
+}
+
+void append_histogram(std::string& out, std::string_view metric, std::string_view labels,
+                      const tfs::profiler::Stats& stats)
+{
+	append_histogram(out, metric, labels, stats.buckets, 1e-6, stats.totalMicroseconds / 1e6);
+}
+
+void append_network(std::string& out)
+{
+	const auto stats = ConnectionManager::getInstance().getWriteStats();
+
+	append_header(out, "tfs_network_writes_total", "counter", "Gathered socket writes.");
+	append_sample(out, "tfs_network_writes_total", "", stats.writes);
+	append_header(out, "tfs_network_messages_total", "counter", "Messages written to sockets.");
+	append_sample(out, "tfs_network_messages_total", "", stats.messages);
+	append_header(out, "tfs_network_bytes_total", "counter", "Bytes written to sockets.");
+	append_sample(out, "tfs_network_bytes_total", "", stats.bytes);
+
+	append_header(out, "tfs_network_queue_delay_seconds", "histogram",
+	              "Time from creating a message until its socket write started.");
+	append_histogram(out, "tfs_network_queue_delay_seconds", "", stats.queueDelays, 1e-6,
+	                 stats.totalQueueDelay / 1e6);
+	append_header(out, "tfs_network_queue_delay_max_seconds", "gauge", "Longest queueing delay of a message.");
+	append_sample(out, "tfs_network_queue_delay_max_seconds", "", stats.maxQueueDelay / 1e6);
+}
+
+void append_database(std::string& out)
+{
+	const auto stats = g_databaseTasks.getStats();
+
+	append_header(out, "tfs_database_tasks_total", "counter", "Asynchronous queries run by the database workers.");
+	append_sample(out, "tfs_database_tasks_total", "", stats.tasks);
+	append_header(out, "tfs_database_task_failures_total", "counter", "Asynchronous queries that failed.");
+	append_sample(out, "tfs_database_task_failures_total", "", stats.failures);
+	append_header(out, "tfs_database_workers", "gauge", "Database worker threads.");
+	append_sample(out, "tfs_database_workers", "", stats.workers);
+	append_header(out, "tfs_database_pending_tasks", "gauge", "Asynchronous queries queued or running.");
+	append_sample(out, "tfs_database_pending_tasks", "", stats.pending);
+	append_header(out, "tfs_database_pending_tasks_max", "gauge", "Most asynchronous queries queued or running at once.");
+	append_sample(out, "tfs_database_pending_tasks_max", "", stats.maxPending);
+
+	// latencies are bucketed by milliseconds
+	append_header(out, "tfs_database_task_latency_seconds", "histogram",
+	              "Time from queueing an asynchronous query until it ran.");
+	append_histogram(out, "tfs_database_task_latency_seconds", "", stats.latencies, 1e-3, stats.totalLatency / 1e6);
+	append_header(out, "tfs_database_task_latency_max_seconds", "gauge", "Longest latency of an asynchronous query.");
+	append_sample(out, "tfs_database_task_latency_max_seconds", "", stats.maxLatency / 1e6);
+
+	append_header(out, "tfs_database_queue_depth", "histogram", "Queries pending when another one was queued.");
+	append_histogram(out, "tfs_database_queue_depth", "", stats.depths, 1, static_cast<double>(stats.totalDepth),
+	                 true);
+}
+
+void append_player_saves(std::string& out)
+{
+	const auto stats = g_playerSaver.getStats();
+
+	append_header(out, "tfs_player_saves_total", "counter", "Player saves written.");
+	append_sample(out, "tfs_player_saves_total", "", stats.saves);
+	append_header(out, "tfs_player_save_failures_total", "counter", "Player saves that could not be written.");
+	append_sample(out, "tfs_player_save_failures_total", "", stats.failures);
+	append_header(out, "tfs_player_save_batches_total", "counter", "Transactions the player saves were written in.");
+	append_sample(out, "tfs_player_save_batches_total", "", stats.batches);
+	append_header(out, "tfs_player_saves_pending", "gauge", "Player saves queued or being written.");
+	append_sample(out, "tfs_player_saves_pending", "", stats.pending);
+
+	append_header(out, "tfs_player_save_latency_seconds", "summary",
+	              "Time from queueing a player save until it was written.");
+	append_sample(out, "tfs_player_save_latency_seconds_sum", "", stats.totalLatency / 1e6);
+	append_sample(out, "tfs_player_save_latency_seconds_count", "", stats.saves);
+	append_header(out, "tfs_player_save_latency_max_seconds", "gauge", "Longest latency of a player save.");
+	append_sample(out, "tfs_player_save_latency_max_seconds", "", stats.maxLatency / 1e6);
+
+	append_header(out, "tfs_player_save_rows_avoided_total", "counter",
+	              "Item and storage rows not written because they were unchanged.");
+	append_sample(out, "tfs_player_save_rows_avoided_total", "", stats.rowsAvoided);
+	append_header(out, "tfs_player_save_bytes_avoided_total", "counter",
+	              "Approximate size of the rows not written because they were unchanged.");
+	append_sample(out, "tfs_player_save_bytes_avoided_total", "", stats.bytesAvoided);
+}
+
+void append_compression(std::string& out)
+{
+	using tfs::compression::MessageClass;
+	constexpr std::array<std::pair<MessageClass, std::string_view>, tfs::compression::MESSAGE_CLASSES> classes = {{
+	    {MessageClass::SMALL, "small"},
+	    {MessageClass::MEDIUM, "medium"},
+	    {MessageClass::LARGE, "large"},
+	}};
+
+	std::array<tfs::compression::Stats, tfs::compression::MESSAGE_CLASSES> stats;
+	for (size_t i = 0; i < classes.size(); ++i) {
+		stats[i] = tfs::compression::getStats(classes[i].first);
+	}
+
+	const auto append = [&](std::string_view metric, std::string_view help, auto value) {
+		append_header(out, metric, "counter", help);
+		for (size_t i = 0; i < classes.size(); ++i) {
+			append_sample(out, metric, fmt::format("class=\"{:s}\"", classes[i].second), value(stats[i]));
+		}
+	};
+	append("tfs_compression_messages_total", "Messages compressed, by size class.",
+	       [](const auto& stats) { return stats.messages; });
+	append("tfs_compression_input_bytes_total", "Bytes of the messages compressed, by size class.",
+	       [](const auto& stats) { return stats.inputBytes; });
+	append("tfs_compression_output_bytes_total", "Bytes the messages were compressed into, by size class.",
+	       [](const auto& stats) { return stats.outputBytes; });
+	append("tfs_compression_seconds_total", "Time spent compressing, by size class.",
+	       [](const auto& stats) { return stats.nanoseconds / 1e9; });
+}
+
+void append_output_buffers(std::string& out)
+{
+	using tfs::net::BufferClass;
+	constexpr std::array<std::pair<BufferClass, std::string_view>, tfs::net::BUFFER_CLASSES> classes = {{
+	    {BufferClass::SMALL, "small"},
+	    {BufferClass::MEDIUM, "medium"},
+	    {BufferClass::FULL, "full"},
+	}};
+
+	std::array<tfs::net::BufferPoolStats, tfs::net::BUFFER_CLASSES> stats;
+	for (size_t i = 0; i < classes.size(); ++i) {
+		stats[i] = tfs::net::get_buffer_pool_stats(classes[i].first);
+	}
+
+	const auto append = [&](std::string_view metric, std::string_view type, std::string_view help, auto value) {
+		append_header(out, metric, type, help);
+		for (size_t i = 0; i < classes.size(); ++i) {
+			append_sample(out, metric, fmt::format("class=\"{:s}\"", classes[i].second), value(stats[i]));
+		}
+	};
+	append("tfs_output_buffer_size_bytes", "gauge", "Size of the output message buffers of a class.",
+	       [](const auto& stats) { return stats.bufferSize; });
+	append("tfs_output_buffer_allocations_total", "counter", "Output message buffers handed out.",
+	       [](const auto& stats) { return stats.allocations; });
+	append("tfs_output_buffer_refills_total", "counter",
+	       "Times a thread cache was empty and took a batch of buffers from the shared pool.",
+	       [](const auto& stats) { return stats.refills; });
+	append("tfs_output_buffer_misses_total", "counter", "Buffers that had to come from the heap.",
+	       [](const auto& stats) { return stats.misses; });
+	append("tfs_output_buffer_grows_total", "counter", "Messages that outgrew a buffer of the class.",
+	       [](const auto& stats) { return stats.grows; });
+	append("tfs_output_buffers_resident", "gauge", "Buffers taken from the heap and not given back.",
+	       [](const auto& stats) { return stats.resident; });
+}
+
+void append_cache(std::string& out, std::string_view name, std::string_view what, uint64_t hits, uint64_t misses,
+                  size_t entries)
+{
+	const std::string prefix = fmt::format("tfs_{:s}_cache", name);
+	append_header(out, prefix + "_hits_total", "counter", fmt::format("Lookups of {:s} served from the cache.", what));
+	append_sample(out, prefix + "_hits_total", "", hits);
+	append_header(out, prefix + "_misses_total", "counter", fmt::format("Lookups of {:s} the cache missed.", what));
+	append_sample(out, prefix + "_misses_total", "", misses);
+	append_header(out, prefix + "_entries", "gauge", fmt::format("Entries in the cache of {:s}.", what));
+	append_sample(out, prefix + "_entries", "", entries);
+}
+
+} // namespace
+
+std::string tfs::http::render_metrics()
+{
+	using namespace tfs::profiler;
+
+	std::string out;
+	out += "# HELP tfs_profiler_enabled Whether the sections are being timed.\n";
+	out += "# TYPE tfs_profiler_enabled gauge\n";
+	out += fmt::format("tfs_profiler_enabled {:d}\n", isEnabled() ? 1 : 0);
+
+	out += "# HELP tfs_section_duration_seconds Time spent in a section of the server.\n";
+	out += "# TYPE tfs_section_duration_seconds histogram\n";
+	for (size_t i = 0; i < SECTIONS; ++i) {
+		const auto section = static_cast<Section>(i);
+		append_histogram(out, "tfs_section_duration_seconds", fmt::format("section=\"{:s}\"", getSectionName(section)),
+		                 getHistogram(section).getStats());
+	}
+
+	out += "# HELP tfs_lua_event_duration_seconds Time spent in a Lua event, by script and event.\n";
+	out += "# TYPE tfs_lua_event_duration_seconds histogram\n";
+	for (const auto& [name, stats] : getLuaStats()) {
+		append_histogram(out, "tfs_lua_event_duration_seconds", fmt::format("event=\"{:s}\"", escape_label(name)),
+		                 stats);
+	}
+
+	out += "# HELP tfs_creature_bucket_duration_seconds Time spent in a pass over one creature think bucket.\n";
+	out += "# TYPE tfs_creature_bucket_duration_seconds histogram\n";
+	for (size_t i = 0; i < CREATURE_BUCKETS; ++i) {
+		append_histogram(out, "tfs_creature_bucket_duration_seconds", fmt::format("bucket=\"{:d}\"", i),
+		                 getCreatureBucketHistogram(i).getStats());
+	}
+
+	append_network(out);
+	append_database(out);
+	append_player_saves(out);
+	append_compression(out);
+	append_output_buffers(out);
+
+	const TileDescriptionCache& tileDescriptions = g_game.map.getTileDescriptionCache();
+	append_cache(out, "spectator", "spectators", g_game.map.getSpectatorCacheHits(),
+	             g_game.map.getSpectatorCacheMisses(), g_game.map.getSpectatorCacheSize());
+	append_cache(out, "tile_description", "tile descriptions", tileDescriptions.hits, tileDescriptions.misses,
+	             tileDescriptions.size());
+	return out;
+}
+
+beast::http::message_generator tfs::http::handle_metrics(const beast::http::request<beast::http::string_body>& req)
+{
+	// off unless the config asks for it, the HTTP server is usually reachable by everyone
+	if (!getBoolean(ConfigManager::HTTP_METRICS)) {
+		beast::http::response<beast::http::string_body> res{beast::http::status::not_found, req.version()};
+		res.keep_alive(req.keep_alive());
+		res.prepare_payload();
+		return res;
+	}
+
+	beast::http::response<beast::http::string_body> res{beast::http::status::ok, req.version()};
+	res.set(beast::http::field::content_type, "text/plain; version=0.0.4");
+	res.body() = render_metrics();
+	res.keep_alive(req.keep_alive());
+	res.prepare_payload();
+	return res;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <boost/beast/http/message_generator.hpp>
+#include <boost/beast/http/string_body.hpp>
+
+namespace tfs::http {
+
+// the profiler histograms and the network, database, player saver, buffer pool and map cache counters in the
+// Prometheus text exposition format
+std::string render_metrics();
+
+boost::beast::http::message_generator handle_metrics(
+    const boost::beast::http::request<boost::beast::http::string_body>& req);
+
+} // namespace tfs::http
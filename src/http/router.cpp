@@ -3,6 +3,7 @@
 #include "cacheinfo.h"
 #include "error.h"
 #include "login.h"
+#include "metrics.h"
 
 #include <boost/json/monotonic_resource.hpp>
 #include <boost/json/parse.hpp>
@@ -34,6 +35,10 @@ thread_local json::monotonic_resource mr;
 beast::http::message_generator tfs::http::handle_request(const beast::http::request<beast::http::string_body>& req,
                                                          std::string_view ip)
 {
+	if (req.method() == beast::http::verb::get && req.target() == "/metrics") {
+		return handle_metrics(req);
+	}
+
 	auto&& [status, responseBody] = [&req, ip]() {
 		boost::system::error_code ec;
 		auto requestBody = json::parse(req.body(), ec, &mr);
@@ -0,0 +1,76 @@
+#define BOOST_TEST_MODULE http_metrics
+
+#include "../../otpch.h"
+
+#include "../../compression.h"
+#include "../../profiler.h"
+#include "../metrics.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace tfs::profiler;
+
+BOOST_AUTO_TEST_CASE(test_metrics_histograms)
+{
+	reset();
+	getHistogram(Section::CHECK_DECAY).add(3);
+	getHistogram(Section::CHECK_DECAY).add(1500);
+
+	const auto metrics = tfs::http::render_metrics();
+	BOOST_TEST(metrics.find("# TYPE tfs_section_duration_seconds histogram\n") != std::string::npos);
+	// cumulative, 3 us is below 4 us and 1500 us below 2048 us
+	BOOST_TEST(metrics.find("tfs_section_duration_seconds_bucket{section=\"check_decay\",le=\"2e-06\"} 0\n") !=
+	           std::string::npos);
+	BOOST_TEST(metrics.find("tfs_section_duration_seconds_bucket{section=\"check_decay\",le=\"4e-06\"} 1\n") !=
+	           std::string::npos);
+	BOOST_TEST(metrics.find("tfs_section_duration_seconds_bucket{section=\"check_decay\",le=\"0.002048\"} 2\n") !=
+	           std::string::npos);
+	BOOST_TEST(metrics.find("tfs_section_duration_seconds_bucket{section=\"check_decay\",le=\"+Inf\"} 2\n") !=
+	           std::string::npos);
+	BOOST_TEST(metrics.find("tfs_section_duration_seconds_sum{section=\"check_decay\"} 0.001503\n") !=
+	           std::string::npos);
+	BOOST_TEST(metrics.find("tfs_section_duration_seconds_count{section=\"check_decay\"} 2\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_metrics_escape_lua_events)
+{
+	reset();
+	getLuaHistogram("scripts/\"quoted\".lua:onThink").add(10);
+
+	const auto metrics = tfs::http::render_metrics();
+	BOOST_TEST(metrics.find("tfs_lua_event_duration_seconds_count{event=\"scripts/\\\"quoted\\\".lua:onThink\"} 1\n") !=
+	           std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_metrics_creature_buckets)
+{
+	reset();
+	getCreatureBucketHistogram(7).add(100);
+
+	const auto metrics = tfs::http::render_metrics();
+	BOOST_TEST(metrics.find("tfs_creature_bucket_duration_seconds_count{bucket=\"7\"} 1\n") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_creature_bucket_duration_seconds_count{bucket=\"0\"} 0\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_metrics_counters)
+{
+	const std::string message(1000, 'a');
+	tfs::compression::deflate(reinterpret_cast<const uint8_t*>(message.data()), message.size());
+	const auto compressed = tfs::compression::getStats(tfs::compression::MessageClass::SMALL);
+
+	const auto metrics = tfs::http::render_metrics();
+	BOOST_TEST(metrics.find("# TYPE tfs_network_writes_total counter\n") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_network_queue_delay_seconds_bucket{le=\"+Inf\"} ") != std::string::npos);
+	// nothing started the workers or the saver
+	BOOST_TEST(metrics.find("tfs_database_workers 0\n") != std::string::npos);
+	// depths are whole numbers, the first bucket is the tasks queued with nothing pending
+	BOOST_TEST(metrics.find("tfs_database_queue_depth_bucket{le=\"0\"} 0\n") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_database_queue_depth_bucket{le=\"3\"} 0\n") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_database_queue_depth_count 0\n") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_player_saves_pending 0\n") != std::string::npos);
+	BOOST_TEST(metrics.find(fmt::format("tfs_compression_messages_total{{class=\"small\"}} {:d}\n",
+	                                    compressed.messages)) != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_output_buffer_size_bytes{class=\"full\"} ") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_spectator_cache_entries 0\n") != std::string::npos);
+	BOOST_TEST(metrics.find("tfs_tile_description_cache_hits_total 0\n") != std::string::npos);
+}
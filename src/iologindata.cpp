@@ -10,47 +10,126 @@
 #include "depotchest.h"
 #include "game.h"
 #include "inbox.h"
+#include "playersaver.h"
 #include "storeinbox.h"
 
 extern Game g_game;
 
+namespace {
+
+// columns of the players row read by loadPlayer, in the order they are selected
+enum PlayerColumn : size_t
+{
+	PLAYER_ID,
+	PLAYER_NAME,
+	PLAYER_ACCOUNT_ID,
+	PLAYER_GROUP_ID,
+	PLAYER_SEX,
+	PLAYER_VOCATION,
+	PLAYER_EXPERIENCE,
+	PLAYER_LEVEL,
+	PLAYER_MAGLEVEL,
+	PLAYER_HEALTH,
+	PLAYER_HEALTHMAX,
+	PLAYER_BLESSINGS,
+	PLAYER_MANA,
+	PLAYER_MANAMAX,
+	PLAYER_MANASPENT,
+	PLAYER_SOUL,
+	PLAYER_LOOKBODY,
+	PLAYER_LOOKFEET,
+	PLAYER_LOOKHEAD,
+	PLAYER_LOOKLEGS,
+	PLAYER_LOOKTYPE,
+	PLAYER_LOOKADDONS,
+	PLAYER_LOOKMOUNT,
+	PLAYER_LOOKMOUNTHEAD,
+	PLAYER_LOOKMOUNTBODY,
+	PLAYER_LOOKMOUNTLEGS,
+	PLAYER_LOOKMOUNTFEET,
+	PLAYER_CURRENTMOUNT,
+	PLAYER_RANDOMIZEMOUNT,
+	PLAYER_POSX,
+	PLAYER_POSY,
+	PLAYER_POSZ,
+	PLAYER_CAP,
+	PLAYER_LASTLOGIN,
+	PLAYER_LASTLOGOUT,
+	PLAYER_LASTIP,
+	PLAYER_CONDITIONS,
+	PLAYER_SKULLTIME,
+	PLAYER_SKULL,
+	PLAYER_TOWN_ID,
+	PLAYER_BALANCE,
+	PLAYER_OFFLINETRAINING_TIME,
+	PLAYER_OFFLINETRAINING_SKILL,
+	PLAYER_STAMINA,
+	PLAYER_SKILL_FIST,
+	PLAYER_SKILL_FIST_TRIES,
+	PLAYER_SKILL_CLUB,
+	PLAYER_SKILL_CLUB_TRIES,
+	PLAYER_SKILL_SWORD,
+	PLAYER_SKILL_SWORD_TRIES,
+	PLAYER_SKILL_AXE,
+	PLAYER_SKILL_AXE_TRIES,
+	PLAYER_SKILL_DIST,
+	PLAYER_SKILL_DIST_TRIES,
+	PLAYER_SKILL_SHIELDING,
+	PLAYER_SKILL_SHIELDING_TRIES,
+	PLAYER_SKILL_FISHING,
+	PLAYER_SKILL_FISHING_TRIES,
+	PLAYER_DIRECTION,
+};
+
+// columns of the item rows read by loadItems
+enum ItemColumn : size_t
+{
+	ITEM_PID,
+	ITEM_SID,
+	ITEM_ITEMTYPE,
+	ITEM_COUNT,
+	ITEM_ATTRIBUTES,
+};
+
+} // namespace
+
 uint32_t IOLoginData::getAccountIdByPlayerName(const std::string& playerName)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(
-	    fmt::format("SELECT `account_id` FROM `players` WHERE `name` = {:s}", db.escapeString(playerName)));
+	DBResult_ptr result = db.prepare("SELECT `account_id` FROM `players` WHERE `name` = ?").storeQuery(playerName);
 	if (!result) {
 		return 0;
 	}
-	return result->getNumber<uint32_t>("account_id");
+	return result->getNumber<uint32_t>(0);
 }
 
 uint32_t IOLoginData::getAccountIdByPlayerId(uint32_t playerId)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `account_id` FROM `players` WHERE `id` = {:d}", playerId));
+	DBResult_ptr result = db.prepare("SELECT `account_id` FROM `players` WHERE `id` = ?").storeQuery(playerId);
 	if (!result) {
 		return 0;
 	}
-	return result->getNumber<uint32_t>("account_id");
+	return result->getNumber<uint32_t>(0);
 }
 
 AccountType_t IOLoginData::getAccountType(uint32_t accountId)
 {
 	DBResult_ptr result =
-	    Database::getInstance().storeQuery(fmt::format("SELECT `type` FROM `accounts` WHERE `id` = {:d}", accountId));
+	    Database::getInstance().prepare("SELECT `type` FROM `accounts` WHERE `id` = ?").storeQuery(accountId);
 	if (!result) {
 		return ACCOUNT_TYPE_NORMAL;
 	}
-	return static_cast<AccountType_t>(result->getNumber<uint16_t>("type"));
+	return result->getNumber<AccountType_t>(0);
 }
 
 void IOLoginData::setAccountType(uint32_t accountId, AccountType_t accountType)
 {
-	Database::getInstance().executeQuery(fmt::format("UPDATE `accounts` SET `type` = {:d} WHERE `id` = {:d}",
-	                                                 static_cast<uint16_t>(accountType), accountId));
+	Database::getInstance()
+	    .prepare("UPDATE `accounts` SET `type` = ? WHERE `id` = ?")
+	    .executeQuery(static_cast<uint16_t>(accountType), accountId);
 }
 
 void IOLoginData::updateOnlineStatus(uint32_t guid, bool login)
@@ -60,10 +139,9 @@ void IOLoginData::updateOnlineStatus(uint32_t guid, bool login)
 	}
 
 	if (login) {
-		Database::getInstance().executeQuery(fmt::format("INSERT INTO `players_online` VALUES ({:d})", guid));
+		Database::getInstance().prepare("INSERT INTO `players_online` VALUES (?)").executeQuery(guid);
 	} else {
-		Database::getInstance().executeQuery(
-		    fmt::format("DELETE FROM `players_online` WHERE `player_id` = {:d}", guid));
+		Database::getInstance().prepare("DELETE FROM `players_online` WHERE `player_id` = ?").executeQuery(guid);
 	}
 }
 
@@ -71,63 +149,69 @@ bool IOLoginData::preloadPlayer(Player* player)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format(
-	    "SELECT `p`.`name`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` AS `p` JOIN `accounts` AS `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`id` = {:d} AND `p`.`deletion` = 0",
-	    player->getGUID()));
+	DBResult_ptr result =
+	    db.prepare(
+	          "SELECT `p`.`name`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` AS `p` JOIN `accounts` AS `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`id` = ? AND `p`.`deletion` = 0")
+	        .storeQuery(player->getGUID());
 	if (!result) {
 		return false;
 	}
 
-	player->setName(result->getString("name"));
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	player->setName(result->getString(0));
+	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>(2));
 	if (!group) {
 		std::cout << "[Error - IOLoginData::preloadPlayer] " << player->name << " has Group ID "
-		          << result->getNumber<uint16_t>("group_id") << " which doesn't exist." << std::endl;
+		          << result->getNumber<uint16_t>(2) << " which doesn't exist." << std::endl;
 		return false;
 	}
 	player->setGroup(group);
-	player->accountNumber = result->getNumber<uint32_t>("account_id");
-	player->accountType = static_cast<AccountType_t>(result->getNumber<uint16_t>("type"));
-	player->premiumEndsAt = result->getNumber<time_t>("premium_ends_at");
+	player->accountNumber = result->getNumber<uint32_t>(1);
+	player->accountType = result->getNumber<AccountType_t>(3);
+	player->premiumEndsAt = result->getNumber<time_t>(4);
 	return true;
 }
 
 bool IOLoginData::loadPlayerById(Player* player, uint32_t id)
 {
+	// read what the last save wrote, not what it is about to overwrite
+	g_playerSaver.waitForPlayer(id);
+
 	Database& db = Database::getInstance();
 	return loadPlayer(
 	    player,
-	    db.storeQuery(fmt::format(
-	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}",
-	        id)));
+	    db.prepare(
+	          "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = ?")
+	        .storeQuery(id));
 }
 
 bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
 {
-	Database& db = Database::getInstance();
-	return loadPlayer(
-	    player,
-	    db.storeQuery(fmt::format(
-	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `currentmount`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}",
-	        db.escapeString(name))));
+	// saves never rename a player, so the name leads to the same guid before and after the pending ones
+	uint32_t guid = getGuidByName(name);
+	if (guid == 0) {
+		return false;
+	}
+	return loadPlayerById(player, guid);
 }
 
 static GuildWarVector getWarList(uint32_t guildId)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = {:d} OR `guild2` = {:d}) AND `ended` = 0 AND `status` = 1",
-	    guildId, guildId));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = ? OR `guild2` = ?) AND `ended` = 0 AND `status` = 1")
+	        .storeQuery(guildId, guildId);
 	if (!result) {
 		return {};
 	}
 
 	GuildWarVector guildWarVector;
 	do {
-		uint32_t guild1 = result->getNumber<uint32_t>("guild1");
+		uint32_t guild1 = result->getNumber<uint32_t>(0);
 		if (guildId != guild1) {
 			guildWarVector.push_back(guild1);
 		} else {
-			guildWarVector.push_back(result->getNumber<uint32_t>("guild2"));
+			guildWarVector.push_back(result->getNumber<uint32_t>(1));
 		}
 	} while (result->next());
 	return guildWarVector;
@@ -141,35 +225,34 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 
 	Database& db = Database::getInstance();
 
-	uint32_t accountId = result->getNumber<uint32_t>("account_id");
+	uint32_t accountId = result->getNumber<uint32_t>(PLAYER_ACCOUNT_ID);
 
-	auto account =
-	    db.storeQuery(fmt::format("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = {:d}", accountId));
+	auto account = db.prepare("SELECT `type`, `premium_ends_at` FROM `accounts` WHERE `id` = ?").storeQuery(accountId);
 	if (!account) {
 		return false;
 	}
 
-	player->accountType = static_cast<AccountType_t>(account->getNumber<int32_t>("type"));
-	player->premiumEndsAt = account->getNumber<time_t>("premium_ends_at");
+	player->accountType = account->getNumber<AccountType_t>(0);
+	player->premiumEndsAt = account->getNumber<time_t>(1);
 
-	player->setGUID(result->getNumber<uint32_t>("id"));
-	player->name = result->getString("name");
+	player->setGUID(result->getNumber<uint32_t>(PLAYER_ID));
+	player->name = result->getString(PLAYER_NAME);
 	player->accountNumber = accountId;
 
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>(PLAYER_GROUP_ID));
 	if (!group) {
 		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Group ID "
-		          << result->getNumber<uint16_t>("group_id") << " which doesn't exist" << std::endl;
+		          << result->getNumber<uint16_t>(PLAYER_GROUP_ID) << " which doesn't exist" << std::endl;
 		return false;
 	}
 	player->setGroup(group);
 
-	player->bankBalance = result->getNumber<uint64_t>("balance");
+	player->bankBalance = result->getNumber<uint64_t>(PLAYER_BALANCE);
 
-	player->setSex(static_cast<PlayerSex_t>(result->getNumber<uint16_t>("sex")));
-	player->level = std::max<uint32_t>(1, result->getNumber<uint32_t>("level"));
+	player->setSex(static_cast<PlayerSex_t>(result->getNumber<uint16_t>(PLAYER_SEX)));
+	player->level = std::max<uint32_t>(1, result->getNumber<uint32_t>(PLAYER_LEVEL));
 
-	uint64_t experience = result->getNumber<uint64_t>("experience");
+	uint64_t experience = result->getNumber<uint64_t>(PLAYER_EXPERIENCE);
 
 	uint64_t currExpCount = Player::getExpForLevel(player->level);
 	uint64_t nextExpCount = Player::getExpForLevel(player->level + 1);
@@ -186,11 +269,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		player->levelPercent = 0;
 	}
 
-	player->soul = result->getNumber<uint16_t>("soul");
-	player->capacity = result->getNumber<uint32_t>("cap") * 100;
-	player->blessings = result->getNumber<uint16_t>("blessings");
+	player->soul = result->getNumber<uint16_t>(PLAYER_SOUL);
+	player->capacity = result->getNumber<uint32_t>(PLAYER_CAP) * 100;
+	player->blessings = result->getNumber<uint16_t>(PLAYER_BLESSINGS);
 
-	auto conditions = result->getString("conditions");
+	auto conditions = result->getString(PLAYER_CONDITIONS);
 	PropStream propStream;
 	propStream.init(conditions.data(), conditions.size());
 
@@ -204,18 +287,18 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		condition = Condition::createCondition(propStream);
 	}
 
-	if (!player->setVocation(result->getNumber<uint16_t>("vocation"))) {
+	if (!player->setVocation(result->getNumber<uint16_t>(PLAYER_VOCATION))) {
 		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Vocation ID "
-		          << result->getNumber<uint16_t>("vocation") << " which doesn't exist" << std::endl;
+		          << result->getNumber<uint16_t>(PLAYER_VOCATION) << " which doesn't exist" << std::endl;
 		return false;
 	}
 
-	player->mana = result->getNumber<uint32_t>("mana");
-	player->manaMax = result->getNumber<uint32_t>("manamax");
-	player->magLevel = result->getNumber<uint32_t>("maglevel");
+	player->mana = result->getNumber<uint32_t>(PLAYER_MANA);
+	player->manaMax = result->getNumber<uint32_t>(PLAYER_MANAMAX);
+	player->magLevel = result->getNumber<uint32_t>(PLAYER_MAGLEVEL);
 
 	uint64_t nextManaCount = player->vocation->getReqMana(player->magLevel + 1);
-	uint64_t manaSpent = result->getNumber<uint64_t>("manaspent");
+	uint64_t manaSpent = result->getNumber<uint64_t>(PLAYER_MANASPENT);
 	if (manaSpent > nextManaCount) {
 		manaSpent = 0;
 	}
@@ -223,32 +306,32 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	player->manaSpent = manaSpent;
 	player->magLevelPercent = Player::getBasisPointLevel(player->manaSpent, nextManaCount);
 
-	player->health = result->getNumber<int32_t>("health");
-	player->healthMax = result->getNumber<int32_t>("healthmax");
-
-	player->defaultOutfit.lookType = result->getNumber<uint16_t>("looktype");
-	player->defaultOutfit.lookHead = result->getNumber<uint16_t>("lookhead");
-	player->defaultOutfit.lookBody = result->getNumber<uint16_t>("lookbody");
-	player->defaultOutfit.lookLegs = result->getNumber<uint16_t>("looklegs");
-	player->defaultOutfit.lookFeet = result->getNumber<uint16_t>("lookfeet");
-	player->defaultOutfit.lookAddons = result->getNumber<uint16_t>("lookaddons");
-	player->defaultOutfit.lookMount = result->getNumber<uint16_t>("lookmount");
-	player->defaultOutfit.lookMountHead = result->getNumber<uint16_t>("lookmounthead");
-	player->defaultOutfit.lookMountBody = result->getNumber<uint16_t>("lookmountbody");
-	player->defaultOutfit.lookMountLegs = result->getNumber<uint16_t>("lookmountlegs");
-	player->defaultOutfit.lookMountFeet = result->getNumber<uint16_t>("lookmountfeet");
+	player->health = result->getNumber<int32_t>(PLAYER_HEALTH);
+	player->healthMax = result->getNumber<int32_t>(PLAYER_HEALTHMAX);
+
+	player->defaultOutfit.lookType = result->getNumber<uint16_t>(PLAYER_LOOKTYPE);
+	player->defaultOutfit.lookHead = result->getNumber<uint16_t>(PLAYER_LOOKHEAD);
+	player->defaultOutfit.lookBody = result->getNumber<uint16_t>(PLAYER_LOOKBODY);
+	player->defaultOutfit.lookLegs = result->getNumber<uint16_t>(PLAYER_LOOKLEGS);
+	player->defaultOutfit.lookFeet = result->getNumber<uint16_t>(PLAYER_LOOKFEET);
+	player->defaultOutfit.lookAddons = result->getNumber<uint16_t>(PLAYER_LOOKADDONS);
+	player->defaultOutfit.lookMount = result->getNumber<uint16_t>(PLAYER_LOOKMOUNT);
+	player->defaultOutfit.lookMountHead = result->getNumber<uint16_t>(PLAYER_LOOKMOUNTHEAD);
+	player->defaultOutfit.lookMountBody = result->getNumber<uint16_t>(PLAYER_LOOKMOUNTBODY);
+	player->defaultOutfit.lookMountLegs = result->getNumber<uint16_t>(PLAYER_LOOKMOUNTLEGS);
+	player->defaultOutfit.lookMountFeet = result->getNumber<uint16_t>(PLAYER_LOOKMOUNTFEET);
 	player->currentOutfit = player->defaultOutfit;
-	player->currentMount = result->getNumber<uint16_t>("currentmount");
-	player->direction = static_cast<Direction>(result->getNumber<uint16_t>("direction"));
-	player->randomizeMount = result->getNumber<uint8_t>("randomizemount") != 0;
+	player->currentMount = result->getNumber<uint16_t>(PLAYER_CURRENTMOUNT);
+	player->direction = static_cast<Direction>(result->getNumber<uint16_t>(PLAYER_DIRECTION));
+	player->randomizeMount = result->getNumber<uint8_t>(PLAYER_RANDOMIZEMOUNT) != 0;
 
 	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
-		const time_t skullSeconds = result->getNumber<time_t>("skulltime") - time(nullptr);
+		const time_t skullSeconds = result->getNumber<time_t>(PLAYER_SKULLTIME) - time(nullptr);
 		if (skullSeconds > 0) {
 			// ensure that we round up the number of ticks
 			player->skullTicks = (skullSeconds + 2);
 
-			uint16_t skull = result->getNumber<uint16_t>("skull");
+			uint16_t skull = result->getNumber<uint16_t>(PLAYER_SKULL);
 			if (skull == SKULL_RED) {
 				player->skull = SKULL_RED;
 			} else if (skull == SKULL_BLACK) {
@@ -257,20 +340,20 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		}
 	}
 
-	player->loginPosition.x = result->getNumber<uint16_t>("posx");
-	player->loginPosition.y = result->getNumber<uint16_t>("posy");
-	player->loginPosition.z = result->getNumber<uint16_t>("posz");
+	player->loginPosition.x = result->getNumber<uint16_t>(PLAYER_POSX);
+	player->loginPosition.y = result->getNumber<uint16_t>(PLAYER_POSY);
+	player->loginPosition.z = result->getNumber<uint16_t>(PLAYER_POSZ);
 
-	player->lastLoginSaved = result->getNumber<time_t>("lastlogin");
-	player->lastLogout = result->getNumber<time_t>("lastlogout");
+	player->lastLoginSaved = result->getNumber<time_t>(PLAYER_LASTLOGIN);
+	player->lastLogout = result->getNumber<time_t>(PLAYER_LASTLOGOUT);
 
-	player->offlineTrainingTime = result->getNumber<int32_t>("offlinetraining_time") * 1000;
-	player->offlineTrainingSkill = result->getNumber<int32_t>("offlinetraining_skill");
+	player->offlineTrainingTime = result->getNumber<int32_t>(PLAYER_OFFLINETRAINING_TIME) * 1000;
+	player->offlineTrainingSkill = result->getNumber<int32_t>(PLAYER_OFFLINETRAINING_SKILL);
 
-	const Town* town = g_game.map.towns.getTown(result->getNumber<uint32_t>("town_id"));
+	const Town* town = g_game.map.towns.getTown(result->getNumber<uint32_t>(PLAYER_TOWN_ID));
 	if (!town) {
 		std::cout << "[Error - IOLoginData::loadPlayer] " << player->name << " has Town ID "
-		          << result->getNumber<uint32_t>("town_id") << " which doesn't exist" << std::endl;
+		          << result->getNumber<uint32_t>(PLAYER_TOWN_ID) << " which doesn't exist" << std::endl;
 		return false;
 	}
 
@@ -281,17 +364,12 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		player->loginPosition = player->getTemplePosition();
 	}
 
-	player->staminaMinutes = result->getNumber<uint16_t>("stamina");
+	player->staminaMinutes = result->getNumber<uint16_t>(PLAYER_STAMINA);
 
-	static const std::string skillNames[] = {"skill_fist", "skill_club",      "skill_sword",  "skill_axe",
-	                                         "skill_dist", "skill_shielding", "skill_fishing"};
-	static const std::string skillNameTries[] = {"skill_fist_tries",   "skill_club_tries", "skill_sword_tries",
-	                                             "skill_axe_tries",    "skill_dist_tries", "skill_shielding_tries",
-	                                             "skill_fishing_tries"};
-	static constexpr size_t size = sizeof(skillNames) / sizeof(std::string);
-	for (uint8_t i = 0; i < size; ++i) {
-		uint16_t skillLevel = result->getNumber<uint16_t>(skillNames[i]);
-		uint64_t skillTries = result->getNumber<uint64_t>(skillNameTries[i]);
+	// every skill has its level followed by its tries, from fist to fishing
+	for (uint8_t i = SKILL_FIRST; i <= SKILL_LAST; ++i) {
+		uint16_t skillLevel = result->getNumber<uint16_t>(PLAYER_SKILL_FIST + (i * 2));
+		uint64_t skillTries = result->getNumber<uint64_t>(PLAYER_SKILL_FIST_TRIES + (i * 2));
 		uint64_t nextSkillTries = player->vocation->getReqSkillTries(i, skillLevel + 1);
 		if (skillTries > nextSkillTries) {
 			skillTries = 0;
@@ -302,12 +380,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		player->skills[i].percent = Player::getBasisPointLevel(skillTries, nextSkillTries);
 	}
 
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {:d}",
-	                     player->getGUID())))) {
-		uint32_t guildId = result->getNumber<uint32_t>("guild_id");
-		uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
-		player->guildNick = result->getString("nick");
+	if ((result = db.prepare("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = ?")
+	                  .storeQuery(player->getGUID()))) {
+		uint32_t guildId = result->getNumber<uint32_t>(0);
+		uint32_t playerRankId = result->getNumber<uint32_t>(1);
+		player->guildNick = result->getString(2);
 
 		auto guild = g_game.getGuild(guildId);
 		if (!guild) {
@@ -324,10 +401,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 			player->guild = guild;
 			auto rank = guild->getRankById(playerRankId);
 			if (!rank) {
-				if ((result = db.storeQuery(fmt::format(
-				         "SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = {:d}", playerRankId)))) {
-					guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"),
-					               result->getNumber<uint16_t>("level"));
+				if ((result = db.prepare("SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = ?")
+				                  .storeQuery(playerRankId))) {
+					guild->addRank(result->getNumber<uint32_t>(0), result->getString(1),
+					               result->getNumber<uint16_t>(2));
 				}
 
 				rank = guild->getRankById(playerRankId);
@@ -339,17 +416,17 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 			player->guildRank = rank;
 			player->guildWarVector = getWarList(guildId);
 
-			if ((result = db.storeQuery(fmt::format(
-			         "SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
-				guild->setMemberCount(result->getNumber<uint32_t>("members"));
+			if ((result = db.prepare("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = ?")
+			                  .storeQuery(guildId))) {
+				guild->setMemberCount(result->getNumber<uint32_t>(0));
 			}
 		}
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}",
-	                                        player->getGUID())))) {
+	if ((result = db.prepare("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = ?")
+	                  .storeQuery(player->getGUID()))) {
 		do {
-			player->learnedInstantSpellList.emplace_front(result->getString("name"));
+			player->learnedInstantSpellList.emplace_front(result->getString(1));
 		} while (result->next());
 	}
 
@@ -357,9 +434,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	ItemMap itemMap;
 	std::map<uint8_t, Container*> openContainersList;
 
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
+	if ((result =
+	         db.prepare(
+	               "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = ? ORDER BY `sid` DESC")
+	             .storeQuery(player->getGUID()))) {
 		loadItems(itemMap, result);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
@@ -399,9 +477,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	// load depot items
 	itemMap.clear();
 
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
+	if ((result =
+	         db.prepare(
+	               "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = ? ORDER BY `sid` DESC")
+	             .storeQuery(player->getGUID()))) {
 		loadItems(itemMap, result);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
@@ -430,9 +509,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	// load inbox items
 	itemMap.clear();
 
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
+	if ((result =
+	         db.prepare(
+	               "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC")
+	             .storeQuery(player->getGUID()))) {
 		loadItems(itemMap, result);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
@@ -460,9 +540,10 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	// load store inbox items
 	itemMap.clear();
 
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
+	if ((result =
+	         db.prepare(
+	               "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC")
+	             .storeQuery(player->getGUID()))) {
 		loadItems(itemMap, result);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
@@ -488,34 +569,34 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	}
 
 	// load storage map
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result =
+	         db.prepare("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = ?").storeQuery(player->getGUID()))) {
 		do {
-			player->setStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
+			player->setStorageValue(result->getNumber<uint32_t>(0), result->getNumber<int32_t>(1), true);
 		} while (result->next());
 	}
 
 	// load vip list
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}",
-	                                        player->getAccount())))) {
+	if ((result = db.prepare("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = ?")
+	                  .storeQuery(player->getAccount()))) {
 		do {
-			player->addVIPInternal(result->getNumber<uint32_t>("player_id"));
+			player->addVIPInternal(result->getNumber<uint32_t>(0));
 		} while (result->next());
 	}
 
 	// load outfits & addons
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = db.prepare("SELECT `outfit_id`, `addons` FROM `player_outfits` WHERE `player_id` = ?")
+	                  .storeQuery(player->getGUID()))) {
 		do {
-			player->addOutfit(result->getNumber<uint16_t>("outfit_id"), result->getNumber<uint8_t>("addons"));
+			player->addOutfit(result->getNumber<uint16_t>(0), result->getNumber<uint8_t>(1));
 		} while (result->next());
 	}
 
 	// load mounts
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result =
+	         db.prepare("SELECT `mount_id` FROM `player_mounts` WHERE `player_id` = ?").storeQuery(player->getGUID()))) {
 		do {
-			player->tameMount(result->getNumber<uint16_t>("mount_id"));
+			player->tameMount(result->getNumber<uint16_t>(0));
 		} while (result->next());
 	}
 
@@ -525,7 +606,7 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	return true;
 }
 
-bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert,
+void IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, std::vector<PlayerSaveItem>& items,
                             PropWriteStream& propWriteStream)
 {
 	using ContainerBlock = std::pair<Container*, int32_t>;
@@ -535,7 +616,6 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 	int32_t runningId = 100;
 	const auto& openContainers = player->getOpenContainers();
 
-	Database& db = Database::getInstance();
 	for (const auto& it : itemList) {
 		int32_t pid = it.first;
 		Item* item = it.second;
@@ -564,11 +644,7 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 		propWriteStream.clear();
 		item->serializeAttr(propWriteStream);
 
-		if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId,
-		                                     item->getID(), item->getSubType(),
-		                                     db.escapeString(propWriteStream.getStream())))) {
-			return false;
-		}
+		items.push_back({pid, runningId, item->getID(), item->getSubType(), std::string{propWriteStream.getStream()}});
 	}
 
 	for (size_t i = 0; i < containers.size(); i++) {
@@ -603,35 +679,70 @@ bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList,
 			propWriteStream.clear();
 			item->serializeAttr(propWriteStream);
 
-			if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId,
-			                                     runningId, item->getID(), item->getSubType(),
-			                                     db.escapeString(propWriteStream.getStream())))) {
-				return false;
-			}
+			items.push_back(
+			    {parentId, runningId, item->getID(), item->getSubType(), std::string{propWriteStream.getStream()}});
 		}
 	}
-	return query_insert.execute();
 }
 
-bool IOLoginData::savePlayer(Player* player)
+bool IOLoginData::saveItems(Database& db, const std::string& table, const std::vector<const PlayerSaveData*>& saves,
+                            PlayerSaveItems PlayerSaveData::*items)
 {
-	if (player->isDead()) {
-		player->changeHealth(1);
+	std::string ids;
+	for (const PlayerSaveData* save : saves) {
+		if ((save->*items).changed) {
+			if (!ids.empty()) {
+				ids.push_back(',');
+			}
+			ids += std::to_string(save->guid);
+		}
 	}
 
-	Database& db = Database::getInstance();
+	if (ids.empty()) {
+		return true;
+	}
 
-	DBResult_ptr result =
-	    db.storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", player->getGUID()));
-	if (!result) {
+	if (!db.executeQuery(fmt::format("DELETE FROM `{:s}` WHERE `player_id` IN ({:s})", table, ids))) {
 		return false;
 	}
 
-	if (result->getNumber<uint16_t>("save") == 0) {
-		return db.executeQuery(
-		    fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = INET6_ATON('{:s}') WHERE `id` = {:d}",
-		                player->lastLoginSaved, player->lastIP.to_string(), player->getGUID()));
+	DBInsert query(
+	    fmt::format("INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ", table),
+	    db);
+	for (const PlayerSaveData* save : saves) {
+		if (!(save->*items).changed) {
+			continue;
+		}
+
+		for (const PlayerSaveItem& item : (save->*items).rows) {
+			if (!query.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", save->guid, item.pid, item.sid,
+			                              item.itemType, item.count, db.escapeString(item.attributes)))) {
+				return false;
+			}
+		}
 	}
+	return query.execute();
+}
+
+void IOLoginData::savePlayer(Player* player, std::function<void(bool)> callback /* = nullptr*/,
+                             bool loggedOut /* = false*/)
+{
+	if (player->isDead()) {
+		player->changeHealth(1);
+	}
+
+	PlayerSaveData save = getPlayerSaveData(player);
+	save.loggedOut = loggedOut || player->isOffline();
+	g_playerSaver.addSave(std::move(save), std::move(callback));
+}
+
+PlayerSaveData IOLoginData::getPlayerSaveData(Player* player)
+{
+	PlayerSaveData save;
+	save.guid = player->getGUID();
+	save.name = player->getName();
+	save.lastLogin = player->lastLoginSaved;
+	save.lastIP = player->lastIP.to_string();
 
 	// serialize conditions
 	PropWriteStream propWriteStream;
@@ -641,61 +752,58 @@ bool IOLoginData::savePlayer(Player* player)
 			propWriteStream.write<uint8_t>(CONDITIONATTR_END);
 		}
 	}
-
-	// First, an UPDATE query to write the player itself
-	std::ostringstream query;
-	query << "UPDATE `players` SET ";
-	query << "`level` = " << player->level << ',';
-	query << "`group_id` = " << player->group->id << ',';
-	query << "`vocation` = " << player->getVocationId() << ',';
-	query << "`health` = " << player->health << ',';
-	query << "`healthmax` = " << player->healthMax << ',';
-	query << "`experience` = " << player->experience << ',';
-	query << "`lookbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookBody) << ',';
-	query << "`lookfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookFeet) << ',';
-	query << "`lookhead` = " << static_cast<uint32_t>(player->defaultOutfit.lookHead) << ',';
-	query << "`looklegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookLegs) << ',';
-	query << "`looktype` = " << player->defaultOutfit.lookType << ',';
-	query << "`lookaddons` = " << static_cast<uint32_t>(player->defaultOutfit.lookAddons) << ',';
-	query << "`lookmount` = " << player->defaultOutfit.lookMount << ',';
-	query << "`lookmounthead` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountHead) << ',';
-	query << "`lookmountbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountBody) << ',';
-	query << "`lookmountlegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountLegs) << ',';
-	query << "`lookmountfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountFeet) << ',';
-	query << "`currentmount` = " << static_cast<uint16_t>(player->currentMount) << ',';
-	query << "`randomizemount` = " << player->randomizeMount << ",";
-	query << "`maglevel` = " << player->magLevel << ',';
-	query << "`mana` = " << player->mana << ',';
-	query << "`manamax` = " << player->manaMax << ',';
-	query << "`manaspent` = " << player->manaSpent << ',';
-	query << "`soul` = " << static_cast<uint16_t>(player->soul) << ',';
-	query << "`town_id` = " << player->town->id << ',';
+	save.conditions = propWriteStream.getStream();
+
+	auto columns = std::back_inserter(save.columns);
+	fmt::format_to(columns, "`level` = {:d},", player->level);
+	fmt::format_to(columns, "`group_id` = {:d},", player->group->id);
+	fmt::format_to(columns, "`vocation` = {:d},", player->getVocationId());
+	fmt::format_to(columns, "`health` = {:d},", player->health);
+	fmt::format_to(columns, "`healthmax` = {:d},", player->healthMax);
+	fmt::format_to(columns, "`experience` = {:d},", player->experience);
+	fmt::format_to(columns, "`lookbody` = {:d},", player->defaultOutfit.lookBody);
+	fmt::format_to(columns, "`lookfeet` = {:d},", player->defaultOutfit.lookFeet);
+	fmt::format_to(columns, "`lookhead` = {:d},", player->defaultOutfit.lookHead);
+	fmt::format_to(columns, "`looklegs` = {:d},", player->defaultOutfit.lookLegs);
+	fmt::format_to(columns, "`looktype` = {:d},", player->defaultOutfit.lookType);
+	fmt::format_to(columns, "`lookaddons` = {:d},", player->defaultOutfit.lookAddons);
+	fmt::format_to(columns, "`lookmount` = {:d},", player->defaultOutfit.lookMount);
+	fmt::format_to(columns, "`lookmounthead` = {:d},", player->defaultOutfit.lookMountHead);
+	fmt::format_to(columns, "`lookmountbody` = {:d},", player->defaultOutfit.lookMountBody);
+	fmt::format_to(columns, "`lookmountlegs` = {:d},", player->defaultOutfit.lookMountLegs);
+	fmt::format_to(columns, "`lookmountfeet` = {:d},", player->defaultOutfit.lookMountFeet);
+	fmt::format_to(columns, "`currentmount` = {:d},", player->currentMount);
+	fmt::format_to(columns, "`randomizemount` = {:d},", player->randomizeMount);
+	fmt::format_to(columns, "`maglevel` = {:d},", player->magLevel);
+	fmt::format_to(columns, "`mana` = {:d},", player->mana);
+	fmt::format_to(columns, "`manamax` = {:d},", player->manaMax);
+	fmt::format_to(columns, "`manaspent` = {:d},", player->manaSpent);
+	fmt::format_to(columns, "`soul` = {:d},", player->soul);
+	fmt::format_to(columns, "`town_id` = {:d},", player->town->id);
 
 	const Position& loginPosition = player->getLoginPosition();
-	query << "`posx` = " << loginPosition.getX() << ',';
-	query << "`posy` = " << loginPosition.getY() << ',';
-	query << "`posz` = " << loginPosition.getZ() << ',';
+	fmt::format_to(columns, "`posx` = {:d},", loginPosition.getX());
+	fmt::format_to(columns, "`posy` = {:d},", loginPosition.getY());
+	fmt::format_to(columns, "`posz` = {:d},", loginPosition.getZ());
 
-	query << "`cap` = " << (player->capacity / 100) << ',';
-	query << "`sex` = " << static_cast<uint16_t>(player->sex) << ',';
+	fmt::format_to(columns, "`cap` = {:d},", player->capacity / 100);
+	fmt::format_to(columns, "`sex` = {:d},", static_cast<uint16_t>(player->sex));
 
 	if (player->lastLoginSaved != 0) {
-		query << "`lastlogin` = " << player->lastLoginSaved << ',';
+		fmt::format_to(columns, "`lastlogin` = {:d},", player->lastLoginSaved);
 	}
 
 	if (!player->lastIP.is_unspecified()) {
-		query << "`lastip` = INET6_ATON('" << player->lastIP.to_string() << "'),";
+		fmt::format_to(columns, "`lastip` = INET6_ATON('{:s}'),", save.lastIP);
 	}
 
-	query << "`conditions` = " << db.escapeString(propWriteStream.getStream()) << ',';
-
 	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
 		int64_t skullTime = 0;
 
 		if (player->skullTicks > 0) {
 			skullTime = time(nullptr) + player->skullTicks;
 		}
-		query << "`skulltime` = " << skullTime << ',';
+		fmt::format_to(columns, "`skulltime` = {:d},", skullTime);
 
 		Skulls_t skull = SKULL_NONE;
 		if (player->skull == SKULL_RED) {
@@ -703,70 +811,40 @@ bool IOLoginData::savePlayer(Player* player)
 		} else if (player->skull == SKULL_BLACK) {
 			skull = SKULL_BLACK;
 		}
-		query << "`skull` = " << static_cast<int64_t>(skull) << ',';
-	}
-
-	query << "`lastlogout` = " << player->getLastLogout() << ',';
-	query << "`balance` = " << player->bankBalance << ',';
-	query << "`offlinetraining_time` = " << player->getOfflineTrainingTime() / 1000 << ',';
-	query << "`offlinetraining_skill` = " << player->getOfflineTrainingSkill() << ',';
-	query << "`stamina` = " << player->getStaminaMinutes() << ',';
-
-	query << "`skill_fist` = " << player->skills[SKILL_FIST].level << ',';
-	query << "`skill_fist_tries` = " << player->skills[SKILL_FIST].tries << ',';
-	query << "`skill_club` = " << player->skills[SKILL_CLUB].level << ',';
-	query << "`skill_club_tries` = " << player->skills[SKILL_CLUB].tries << ',';
-	query << "`skill_sword` = " << player->skills[SKILL_SWORD].level << ',';
-	query << "`skill_sword_tries` = " << player->skills[SKILL_SWORD].tries << ',';
-	query << "`skill_axe` = " << player->skills[SKILL_AXE].level << ',';
-	query << "`skill_axe_tries` = " << player->skills[SKILL_AXE].tries << ',';
-	query << "`skill_dist` = " << player->skills[SKILL_DISTANCE].level << ',';
-	query << "`skill_dist_tries` = " << player->skills[SKILL_DISTANCE].tries << ',';
-	query << "`skill_shielding` = " << player->skills[SKILL_SHIELD].level << ',';
-	query << "`skill_shielding_tries` = " << player->skills[SKILL_SHIELD].tries << ',';
-	query << "`skill_fishing` = " << player->skills[SKILL_FISHING].level << ',';
-	query << "`skill_fishing_tries` = " << player->skills[SKILL_FISHING].tries << ',';
-	query << "`direction` = " << static_cast<uint16_t>(player->getDirection()) << ',';
+		fmt::format_to(columns, "`skull` = {:d},", static_cast<int64_t>(skull));
+	}
+
+	fmt::format_to(columns, "`lastlogout` = {:d},", player->getLastLogout());
+	fmt::format_to(columns, "`balance` = {:d},", player->bankBalance);
+	fmt::format_to(columns, "`offlinetraining_time` = {:d},", player->getOfflineTrainingTime() / 1000);
+	fmt::format_to(columns, "`offlinetraining_skill` = {:d},", player->getOfflineTrainingSkill());
+	fmt::format_to(columns, "`stamina` = {:d},", player->getStaminaMinutes());
+
+	fmt::format_to(columns, "`skill_fist` = {:d},", player->skills[SKILL_FIST].level);
+	fmt::format_to(columns, "`skill_fist_tries` = {:d},", player->skills[SKILL_FIST].tries);
+	fmt::format_to(columns, "`skill_club` = {:d},", player->skills[SKILL_CLUB].level);
+	fmt::format_to(columns, "`skill_club_tries` = {:d},", player->skills[SKILL_CLUB].tries);
+	fmt::format_to(columns, "`skill_sword` = {:d},", player->skills[SKILL_SWORD].level);
+	fmt::format_to(columns, "`skill_sword_tries` = {:d},", player->skills[SKILL_SWORD].tries);
+	fmt::format_to(columns, "`skill_axe` = {:d},", player->skills[SKILL_AXE].level);
+	fmt::format_to(columns, "`skill_axe_tries` = {:d},", player->skills[SKILL_AXE].tries);
+	fmt::format_to(columns, "`skill_dist` = {:d},", player->skills[SKILL_DISTANCE].level);
+	fmt::format_to(columns, "`skill_dist_tries` = {:d},", player->skills[SKILL_DISTANCE].tries);
+	fmt::format_to(columns, "`skill_shielding` = {:d},", player->skills[SKILL_SHIELD].level);
+	fmt::format_to(columns, "`skill_shielding_tries` = {:d},", player->skills[SKILL_SHIELD].tries);
+	fmt::format_to(columns, "`skill_fishing` = {:d},", player->skills[SKILL_FISHING].level);
+	fmt::format_to(columns, "`skill_fishing_tries` = {:d},", player->skills[SKILL_FISHING].tries);
+	fmt::format_to(columns, "`direction` = {:d},", static_cast<uint16_t>(player->getDirection()));
 
 	if (!player->isOffline()) {
-		query << "`onlinetime` = `onlinetime` + " << (time(nullptr) - player->lastLoginSaved) << ',';
-	}
-	query << "`blessings` = " << player->blessings.to_ulong();
-	query << " WHERE `id` = " << player->getGUID();
-
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
-
-	if (!db.executeQuery(query.str())) {
-		return false;
+		fmt::format_to(columns, "`onlinetime` = `onlinetime` + {:d},", time(nullptr) - player->lastLoginSaved);
 	}
+	fmt::format_to(columns, "`blessings` = {:d}", player->blessings.to_ulong());
 
 	// learned spells
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ");
-	for (const std::string& spellName : player->learnedInstantSpellList) {
-		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", player->getGUID(), db.escapeString(spellName)))) {
-			return false;
-		}
-	}
-
-	if (!spellsQuery.execute()) {
-		return false;
-	}
+	save.spells.assign(player->learnedInstantSpellList.begin(), player->learnedInstantSpellList.end());
 
 	// item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert itemsQuery(
-	    "INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-
 	ItemBlockList itemList;
 	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
 		Item* item = player->inventory[slotId];
@@ -775,17 +853,9 @@ bool IOLoginData::savePlayer(Player* player)
 		}
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
-		return false;
-	}
+	saveItems(player, itemList, save.items.rows, propWriteStream);
 
 	// save depot items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert depotQuery(
-	    "INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
 	itemList.clear();
 
 	for (const auto& it : player->depotChests) {
@@ -794,54 +864,142 @@ bool IOLoginData::savePlayer(Player* player)
 		}
 	}
 
-	if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-		return false;
-	}
+	saveItems(player, itemList, save.depotItems.rows, propWriteStream);
 
 	// save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+	itemList.clear();
+
+	for (Item* item : player->getInbox()->getItemList()) {
+		itemList.emplace_back(0, item);
 	}
 
-	DBInsert inboxQuery(
-	    "INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
+	saveItems(player, itemList, save.inboxItems.rows, propWriteStream);
+
+	// save store inbox items
 	itemList.clear();
 
-	for (Item* item : player->getInbox()->getItemList()) {
+	for (Item* item : player->getStoreInbox()->getItemList()) {
 		itemList.emplace_back(0, item);
 	}
 
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-		return false;
+	saveItems(player, itemList, save.storeInboxItems.rows, propWriteStream);
+
+	// only the storage keys that changed
+	for (uint32_t key : player->dirtyStorageKeys) {
+		save.storage.emplace(key, player->getStorageValue(key));
 	}
+	player->dirtyStorageKeys.clear();
+	save.storageSize = player->getStorageMap().size();
 
-	// save store inbox items
-	if (!db.executeQuery(
-	        fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+	// save outfits & addons
+	save.outfits.assign(player->outfits.begin(), player->outfits.end());
+
+	// save mounts
+	save.mounts.assign(player->mounts.begin(), player->mounts.end());
+	return save;
+}
+
+bool IOLoginData::savePlayerData(Database& db, const std::vector<const PlayerSaveData*>& saves,
+                                 std::vector<const PlayerSaveData*>& written)
+{
+	written.clear();
+
+	std::string ids;
+	for (const PlayerSaveData* save : saves) {
+		if (!ids.empty()) {
+			ids.push_back(',');
+		}
+		ids += std::to_string(save->guid);
+	}
+
+	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, `save` FROM `players` WHERE `id` IN ({:s})", ids));
+	if (!result) {
+		// none of the players exist anymore
+		return true;
+	}
+
+	std::unordered_set<uint32_t> saveEnabled;
+	do {
+		if (result->getNumber<uint16_t>(1) != 0) {
+			saveEnabled.insert(result->getNumber<uint32_t>(0));
+		}
+	} while (result->next());
+
+	DBTransaction transaction{db};
+	if (!transaction.begin()) {
 		return false;
 	}
 
-	DBInsert storeInboxQuery(
-	    "INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+	std::vector<const PlayerSaveData*> players;
+	players.reserve(saves.size());
+	ids.clear();
 
-	for (Item* item : player->getStoreInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
+	for (const PlayerSaveData* save : saves) {
+		if (!saveEnabled.contains(save->guid)) {
+			if (!db.prepare("UPDATE `players` SET `lastlogin` = ?, `lastip` = INET6_ATON(?) WHERE `id` = ?")
+			         .executeQuery(save->lastLogin, save->lastIP, save->guid)) {
+				return false;
+			}
+			continue;
+		}
+
+		// First, an UPDATE query to write the player itself
+		if (!db.executeQuery(fmt::format("UPDATE `players` SET {:s}, `conditions` = {:s} WHERE `id` = {:d}",
+		                                 save->columns, db.escapeString(save->conditions), save->guid))) {
+			return false;
+		}
+
+		players.push_back(save);
+		if (!ids.empty()) {
+			ids.push_back(',');
+		}
+		ids += std::to_string(save->guid);
+	}
+
+	if (players.empty()) {
+		return transaction.commit();
 	}
 
-	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
+	// learned spells
+	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` IN ({:s})", ids))) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()))) {
+	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ", db);
+	for (const PlayerSaveData* save : players) {
+		for (const std::string& spellName : save->spells) {
+			if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", save->guid, db.escapeString(spellName)))) {
+				return false;
+			}
+		}
+	}
+
+	if (!spellsQuery.execute()) {
 		return false;
 	}
 
-	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
+	// item saving
+	if (!saveItems(db, "player_items", players, &PlayerSaveData::items) ||
+	    !saveItems(db, "player_depotitems", players, &PlayerSaveData::depotItems) ||
+	    !saveItems(db, "player_inboxitems", players, &PlayerSaveData::inboxItems) ||
+	    !saveItems(db, "player_storeinboxitems", players, &PlayerSaveData::storeInboxItems)) {
+		return false;
+	}
 
-	for (const auto& [key, value] : player->getStorageMap()) {
-		if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), key, value))) {
-			return false;
+	// storage keys are written one by one, only those that changed
+	std::string removedKeys;
+	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", db);
+	storageQuery.upsert({"value"});
+	for (const PlayerSaveData* save : players) {
+		for (const auto& [key, value] : save->storage) {
+			if (!value) {
+				if (!removedKeys.empty()) {
+					removedKeys.push_back(',');
+				}
+				removedKeys += fmt::format("({:d}, {:d})", save->guid, key);
+			} else if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", save->guid, key, *value))) {
+				return false;
+			}
 		}
 	}
 
@@ -849,16 +1007,23 @@ bool IOLoginData::savePlayer(Player* player)
 		return false;
 	}
 
-	// save outfits & addons
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_outfits` WHERE `player_id` = {:d}", player->getGUID()))) {
+	if (!removedKeys.empty() &&
+	    !db.executeQuery(
+	        fmt::format("DELETE FROM `player_storage` WHERE (`player_id`, `key`) IN ({:s})", removedKeys))) {
 		return false;
 	}
 
-	DBInsert outfitQuery("INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ");
+	// save outfits & addons
+	if (!db.executeQuery(fmt::format("DELETE FROM `player_outfits` WHERE `player_id` IN ({:s})", ids))) {
+		return false;
+	}
 
-	for (const auto& it : player->outfits) {
-		if (!outfitQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), it.first, it.second))) {
-			return false;
+	DBInsert outfitQuery("INSERT INTO `player_outfits` (`player_id`, `outfit_id`, `addons`) VALUES ", db);
+	for (const PlayerSaveData* save : players) {
+		for (const auto& [outfitId, addons] : save->outfits) {
+			if (!outfitQuery.addRow(fmt::format("{:d}, {:d}, {:d}", save->guid, outfitId, addons))) {
+				return false;
+			}
 		}
 	}
 
@@ -867,15 +1032,16 @@ bool IOLoginData::savePlayer(Player* player)
 	}
 
 	// save mounts
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_mounts` WHERE `player_id` = {:d}", player->getGUID()))) {
+	if (!db.executeQuery(fmt::format("DELETE FROM `player_mounts` WHERE `player_id` IN ({:s})", ids))) {
 		return false;
 	}
 
-	DBInsert mountQuery("INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ");
-
-	for (const auto& it : player->mounts) {
-		if (!mountQuery.addRow(fmt::format("{:d}, {:d}", player->getGUID(), it))) {
-			return false;
+	DBInsert mountQuery("INSERT INTO `player_mounts` (`player_id`, `mount_id`) VALUES ", db);
+	for (const PlayerSaveData* save : players) {
+		for (uint16_t mountId : save->mounts) {
+			if (!mountQuery.addRow(fmt::format("{:d}, {:d}", save->guid, mountId))) {
+				return false;
+			}
 		}
 	}
 
@@ -884,18 +1050,22 @@ bool IOLoginData::savePlayer(Player* player)
 	}
 
 	// End the transaction
-	return transaction.commit();
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	written = std::move(players);
+	return true;
 }
 
 std::string IOLoginData::getNameByGuid(uint32_t guid)
 {
-	DBResult_ptr result =
-	    Database::getInstance().storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `id` = {:d}", guid));
+	DBResult_ptr result = Database::getInstance().prepare("SELECT `name` FROM `players` WHERE `id` = ?").storeQuery(guid);
 	if (!result) {
 		return {};
 	}
 
-	auto name = result->getString("name");
+	auto name = result->getString(0);
 	return {name.data(), name.size()};
 }
 
@@ -903,27 +1073,26 @@ uint32_t IOLoginData::getGuidByName(const std::string& name)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result =
-	    db.storeQuery(fmt::format("SELECT `id` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
+	DBResult_ptr result = db.prepare("SELECT `id` FROM `players` WHERE `name` = ?").storeQuery(name);
 	if (!result) {
 		return 0;
 	}
-	return result->getNumber<uint32_t>("id");
+	return result->getNumber<uint32_t>(0);
 }
 
 bool IOLoginData::getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format(
-	    "SELECT `name`, `id`, `group_id`, `account_id` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
+	DBResult_ptr result =
+	    db.prepare("SELECT `name`, `id`, `group_id`, `account_id` FROM `players` WHERE `name` = ?").storeQuery(name);
 	if (!result) {
 		return false;
 	}
 
-	name = result->getString("name");
-	guid = result->getNumber<uint32_t>("id");
-	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>("group_id"));
+	name = result->getString(0);
+	guid = result->getNumber<uint32_t>(1);
+	Group* group = g_game.groups.getGroup(result->getNumber<uint16_t>(2));
 
 	uint64_t flags;
 	if (group) {
@@ -940,25 +1109,24 @@ bool IOLoginData::formatPlayerName(std::string& name)
 {
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result =
-	    db.storeQuery(fmt::format("SELECT `name` FROM `players` WHERE `name` = {:s}", db.escapeString(name)));
+	DBResult_ptr result = db.prepare("SELECT `name` FROM `players` WHERE `name` = ?").storeQuery(name);
 	if (!result) {
 		return false;
 	}
 
-	name = result->getString("name");
+	name = result->getString(0);
 	return true;
 }
 
 void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 {
 	do {
-		uint32_t sid = result->getNumber<uint32_t>("sid");
-		uint32_t pid = result->getNumber<uint32_t>("pid");
-		uint16_t type = result->getNumber<uint16_t>("itemtype");
-		uint16_t count = result->getNumber<uint16_t>("count");
+		uint32_t sid = result->getNumber<uint32_t>(ITEM_SID);
+		uint32_t pid = result->getNumber<uint32_t>(ITEM_PID);
+		uint16_t type = result->getNumber<uint16_t>(ITEM_ITEMTYPE);
+		uint16_t count = result->getNumber<uint16_t>(ITEM_COUNT);
 
-		auto attr = result->getString("attributes");
+		auto attr = result->getString(ITEM_ATTRIBUTES);
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
 
@@ -976,28 +1144,33 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance)
 {
-	Database::getInstance().executeQuery(
-	    fmt::format("UPDATE `players` SET `balance` = `balance` + {:d} WHERE `id` = {:d}", bankBalance, guid));
+	// a pending save would overwrite the balance otherwise
+	g_playerSaver.waitForPlayer(guid);
+
+	Database::getInstance()
+	    .prepare("UPDATE `players` SET `balance` = `balance` + ? WHERE `id` = ?")
+	    .executeQuery(bankBalance, guid);
 }
 
 bool IOLoginData::hasBiddedOnHouse(uint32_t guid)
 {
 	Database& db = Database::getInstance();
-	return db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `highest_bidder` = {:d} LIMIT 1", guid)).get();
+	return db.prepare("SELECT `id` FROM `houses` WHERE `highest_bidder` = ? LIMIT 1").storeQuery(guid).get();
 }
 
 std::forward_list<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId)
 {
 	std::forward_list<VIPEntry> entries;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `player_id`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `name`, `description`, `icon`, `notify` FROM `account_viplist` WHERE `account_id` = {:d}",
-	    accountId));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `player_id`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `name`, `description`, `icon`, `notify` FROM `account_viplist` WHERE `account_id` = ?")
+	        .storeQuery(accountId);
 	if (result) {
 		do {
-			entries.emplace_front(result->getNumber<uint32_t>("player_id"), result->getString("name"),
-			                      result->getString("description"), result->getNumber<uint32_t>("icon"),
-			                      result->getNumber<uint16_t>("notify") != 0);
+			entries.emplace_front(result->getNumber<uint32_t>(0), result->getString(1), result->getString(2),
+			                      result->getNumber<uint32_t>(3), result->getNumber<uint16_t>(4) != 0);
 		} while (result->next());
 	}
 	return entries;
@@ -1006,29 +1179,31 @@ std::forward_list<VIPEntry> IOLoginData::getVIPEntries(uint32_t accountId)
 void IOLoginData::addVIPEntry(uint32_t accountId, uint32_t guid, const std::string& description, uint32_t icon,
                               bool notify)
 {
-	Database& db = Database::getInstance();
-	db.executeQuery(fmt::format(
-	    "INSERT INTO `account_viplist` (`account_id`, `player_id`, `description`, `icon`, `notify`) VALUES ({:d}, {:d}, {:s}, {:d}, {:d})",
-	    accountId, guid, db.escapeString(description), icon, notify));
+	Database::getInstance()
+	    .prepare(
+	        "INSERT INTO `account_viplist` (`account_id`, `player_id`, `description`, `icon`, `notify`) VALUES (?, ?, ?, ?, ?)")
+	    .executeQuery(accountId, guid, description, icon, notify);
 }
 
 void IOLoginData::editVIPEntry(uint32_t accountId, uint32_t guid, const std::string& description, uint32_t icon,
                                bool notify)
 {
-	Database& db = Database::getInstance();
-	db.executeQuery(fmt::format(
-	    "UPDATE `account_viplist` SET `description` = {:s}, `icon` = {:d}, `notify` = {:d} WHERE `account_id` = {:d} AND `player_id` = {:d}",
-	    db.escapeString(description), icon, notify, accountId, guid));
+	Database::getInstance()
+	    .prepare(
+	        "UPDATE `account_viplist` SET `description` = ?, `icon` = ?, `notify` = ? WHERE `account_id` = ? AND `player_id` = ?")
+	    .executeQuery(description, icon, notify, accountId, guid);
 }
 
 void IOLoginData::removeVIPEntry(uint32_t accountId, uint32_t guid)
 {
-	Database::getInstance().executeQuery(
-	    fmt::format("DELETE FROM `account_viplist` WHERE `account_id` = {:d} AND `player_id` = {:d}", accountId, guid));
+	Database::getInstance()
+	    .prepare("DELETE FROM `account_viplist` WHERE `account_id` = ? AND `player_id` = ?")
+	    .executeQuery(accountId, guid);
 }
 
 void IOLoginData::updatePremiumTime(uint32_t accountId, time_t endTime)
 {
-	Database::getInstance().executeQuery(
-	    fmt::format("UPDATE `accounts` SET `premium_ends_at` = {:d} WHERE `id` = {:d}", endTime, accountId));
+	Database::getInstance()
+	    .prepare("UPDATE `accounts` SET `premium_ends_at` = ? WHERE `id` = ?")
+	    .executeQuery(endTime, accountId);
 }
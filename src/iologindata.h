@@ -14,6 +14,52 @@ struct VIPEntry;
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
+struct PlayerSaveItem
+{
+	int32_t pid;
+	int32_t sid;
+	uint16_t itemType;
+	uint16_t count;
+	std::string attributes;
+};
+
+struct PlayerSaveItems
+{
+	std::vector<PlayerSaveItem> rows;
+	// cleared when the database holds these rows already, they are not written again then
+	bool changed = true;
+};
+
+/**
+ * @brief Everything a player save writes, taken on the dispatcher so the rows can be written from another thread.
+ */
+struct PlayerSaveData
+{
+	uint32_t guid = 0;
+	std::string name;
+
+	// written instead of everything else when the player has `save` disabled
+	time_t lastLogin = 0;
+	std::string lastIP;
+
+	// `column` = value list of the players row, without the conditions that still need to be escaped
+	std::string columns;
+	std::string conditions;
+
+	std::vector<std::string> spells;
+	PlayerSaveItems items;
+	PlayerSaveItems depotItems;
+	PlayerSaveItems inboxItems;
+	PlayerSaveItems storeInboxItems;
+	// storage keys changed since the previous save, removed keys have no value
+	std::map<uint32_t, std::optional<int32_t>> storage;
+	size_t storageSize = 0;
+	std::vector<std::pair<uint16_t, uint8_t>> outfits;
+	std::vector<uint16_t> mounts;
+	// the last save before the player is out of the game, the saver forgets the player once it is written
+	bool loggedOut = false;
+};
+
 class IOLoginData
 {
 public:
@@ -28,7 +74,16 @@ public:
 	static bool loadPlayerById(Player* player, uint32_t id);
 	static bool loadPlayerByName(Player* player, const std::string& name);
 	static bool loadPlayer(Player* player, DBResult_ptr result);
-	static bool savePlayer(Player* player);
+	/**
+	 * @brief Queues a save of the player, the callback gets whether it was written once it reaches the dispatcher.
+	 *
+	 * Saves of offline players, and the one a player leaving the game passes loggedOut for, are the last ones for a
+	 * while, nothing is kept to compare the next save against.
+	 */
+	static void savePlayer(Player* player, std::function<void(bool)> callback = nullptr, bool loggedOut = false);
+	static PlayerSaveData getPlayerSaveData(Player* player);
+	static bool savePlayerData(Database& db, const std::vector<const PlayerSaveData*>& saves,
+	                           std::vector<const PlayerSaveData*>& written);
 	static uint32_t getGuidByName(const std::string& name);
 	static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 	static std::string getNameByGuid(uint32_t guid);
@@ -49,8 +104,10 @@ private:
 	using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
 	static void loadItems(ItemMap& itemMap, DBResult_ptr result);
-	static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert,
+	static void saveItems(const Player* player, const ItemBlockList& itemList, std::vector<PlayerSaveItem>& items,
 	                      PropWriteStream& propWriteStream);
+	static bool saveItems(Database& db, const std::string& table, const std::vector<const PlayerSaveData*>& saves,
+	                      PlayerSaveItems PlayerSaveData::*items);
 };
 
 #endif // FS_IOLOGINDATA_H
@@ -6,6 +6,7 @@
 #include "iomap.h"
 
 #include "housetile.h"
+#include "workerpool.h"
 
 /*
         OTBM_ROOTV1
@@ -31,6 +32,36 @@
         |--- OTBM_ITEM_DEF (not implemented)
 */
 
+// A tile area as one of the loading threads parsed it. Creating items touches the decay wheel, the unique ids and the
+// random generator, so the tiles and their items are only created from it later, on the loading thread and in file
+// order.
+struct IOMap::TileArea
+{
+	struct StagedItem
+	{
+		// nullptr for an item given as a tile attribute, which is nothing but its id
+		const OTB::Node* node = nullptr;
+		uint16_t id = 0;
+	};
+
+	struct StagedTile
+	{
+		size_t firstItem = 0;
+		size_t itemCount = 0;
+		uint32_t houseId = 0;
+		uint32_t flags = TILESTATE_NONE;
+		uint16_t x = 0;
+		uint16_t y = 0;
+		bool isHouseTile = false;
+	};
+
+	OTB::Node node;
+	std::vector<StagedTile> tiles;
+	std::vector<StagedItem> items;
+	std::string error;
+	uint16_t z = 0;
+};
+
 Tile* IOMap::createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8_t z)
 {
 	if (!ground) {
@@ -53,9 +84,15 @@ Tile* IOMap::createTile(Item*& ground, Item* item, uint16_t x, uint16_t y, uint8
 bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName)
 {
 	int64_t start = OTSYS_TIME();
+	int64_t indexed = start;
+	int64_t parsed = start;
+	size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
 	try {
 		OTB::Loader loader{fileName.string(), OTB::Identifier{{'O', 'T', 'B', 'M'}}};
-		auto& root = loader.parseTree();
+
+		// a single pass over the file finds where every node below the map data ends, the tiles and items in them
+		// are only built when their area is parsed
+		auto& root = loader.parseTree(2);
 
 		PropStream propStream;
 		if (!loader.getProps(root, propStream)) {
@@ -119,17 +156,16 @@ bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName)
 			return false;
 		}
 
+		std::vector<const OTB::Node*> tileAreaNodes;
 		for (auto& mapDataNode : mapNode.children) {
 			if (mapDataNode.type == OTBM_TILE_AREA) {
-				if (!parseTileArea(loader, mapDataNode, *map)) {
-					return false;
-				}
+				tileAreaNodes.push_back(&mapDataNode);
 			} else if (mapDataNode.type == OTBM_TOWNS) {
-				if (!parseTowns(loader, mapDataNode, *map)) {
+				if (!parseTowns(loader, loader.parseSubtree(mapDataNode), *map)) {
 					return false;
 				}
 			} else if (mapDataNode.type == OTBM_WAYPOINTS && headerVersion > 1) {
-				if (!parseWaypoints(loader, mapDataNode, *map)) {
+				if (!parseWaypoints(loader, loader.parseSubtree(mapDataNode), *map)) {
 					return false;
 				}
 			} else {
@@ -137,12 +173,38 @@ bool IOMap::loadMap(Map* map, const std::filesystem::path& fileName)
 				return false;
 			}
 		}
+		indexed = OTSYS_TIME();
+
+		std::vector<TileArea> areas(tileAreaNodes.size());
+		{
+			// the loading thread works through the areas along with the pool
+			WorkerPool workers;
+			workers.start(threads - 1);
+			workers.parallelFor(areas.size(),
+			                    [&](size_t index) { parseTileArea(loader, *tileAreaNodes[index], areas[index]); });
+		}
+		parsed = OTSYS_TIME();
+
+		for (auto& area : areas) {
+			if (!area.error.empty()) {
+				setLastErrorString(std::move(area.error));
+				return false;
+			}
+
+			if (!buildTileArea(loader, area, *map)) {
+				return false;
+			}
+			area = {};
+		}
 	} catch (const OTB::InvalidOTBFormat& err) {
 		setLastErrorString(err.what());
 		return false;
 	}
 
-	std::cout << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
+	int64_t end = OTSYS_TIME();
+	std::cout << "> Map loading time: " << (end - start) / (1000.) << " seconds (indexing "
+	          << (indexed - start) / (1000.) << ", parsing " << (parsed - indexed) / (1000.) << " on " << threads
+	          << " threads, building " << (end - parsed) / (1000.) << ")." << std::endl;
 	return true;
 }
 
@@ -197,67 +259,63 @@ bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode
 	return true;
 }
 
-bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map)
+bool IOMap::parseTileArea(const OTB::Loader& loader, const OTB::Node& tileAreaNode, TileArea& area)
 {
+	try {
+		area.node = loader.parseSubtree(tileAreaNode);
+	} catch (const OTB::InvalidOTBFormat& err) {
+		area.error = err.what();
+		return false;
+	}
+
 	PropStream propStream;
-	if (!loader.getProps(tileAreaNode, propStream)) {
-		setLastErrorString("Invalid map node.");
+	if (!loader.getProps(area.node, propStream)) {
+		area.error = "Invalid map node.";
 		return false;
 	}
 
 	OTBM_Destination_coords area_coord;
 	if (!propStream.read(area_coord)) {
-		setLastErrorString("Invalid map node.");
+		area.error = "Invalid map node.";
 		return false;
 	}
 
 	uint16_t base_x = area_coord.x;
 	uint16_t base_y = area_coord.y;
-	uint16_t z = area_coord.z;
+	uint16_t z = area.z = area_coord.z;
 
-	for (auto& tileNode : tileAreaNode.children) {
+	area.tiles.reserve(area.node.children.size());
+	for (auto& tileNode : area.node.children) {
 		if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE) {
-			setLastErrorString("Unknown tile node.");
+			area.error = "Unknown tile node.";
 			return false;
 		}
 
 		if (!loader.getProps(tileNode, propStream)) {
-			setLastErrorString("Could not read node data.");
+			area.error = "Could not read node data.";
 			return false;
 		}
 
 		OTBM_Tile_coords tile_coord;
 		if (!propStream.read(tile_coord)) {
-			setLastErrorString("Could not read tile position.");
+			area.error = "Could not read tile position.";
 			return false;
 		}
 
 		uint16_t x = base_x + tile_coord.x;
 		uint16_t y = base_y + tile_coord.y;
 
-		bool isHouseTile = false;
-		House* house = nullptr;
-		Tile* tile = nullptr;
-		Item* ground_item = nullptr;
-		uint32_t tileflags = TILESTATE_NONE;
+		auto& tile = area.tiles.emplace_back();
+		tile.firstItem = area.items.size();
+		tile.x = x;
+		tile.y = y;
 
 		if (tileNode.type == OTBM_HOUSETILE) {
-			uint32_t houseId;
-			if (!propStream.read<uint32_t>(houseId)) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z));
+			if (!propStream.read<uint32_t>(tile.houseId)) {
+				area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z);
 				return false;
 			}
-
-			house = map.houses.addHouse(houseId);
-			if (!house) {
-				setLastErrorString(
-				    fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, houseId));
-				return false;
-			}
-
-			tile = new HouseTile(x, y, z, house);
-			house->addTile(static_cast<HouseTile*>(tile));
-			isHouseTile = true;
+			tile.isHouseTile = true;
 		}
 
 		uint8_t attribute;
@@ -267,72 +325,85 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 				case OTBM_ATTR_TILE_FLAGS: {
 					uint32_t flags;
 					if (!propStream.read<uint32_t>(flags)) {
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z));
+						area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z);
 						return false;
 					}
 
 					if ((flags & OTBM_TILEFLAG_PROTECTIONZONE) != 0) {
-						tileflags |= TILESTATE_PROTECTIONZONE;
+						tile.flags |= TILESTATE_PROTECTIONZONE;
 					} else if ((flags & OTBM_TILEFLAG_NOPVPZONE) != 0) {
-						tileflags |= TILESTATE_NOPVPZONE;
+						tile.flags |= TILESTATE_NOPVPZONE;
 					} else if ((flags & OTBM_TILEFLAG_PVPZONE) != 0) {
-						tileflags |= TILESTATE_PVPZONE;
+						tile.flags |= TILESTATE_PVPZONE;
 					}
 
 					if ((flags & OTBM_TILEFLAG_NOLOGOUT) != 0) {
-						tileflags |= TILESTATE_NOLOGOUT;
+						tile.flags |= TILESTATE_NOLOGOUT;
 					}
 					break;
 				}
 
 				case OTBM_ATTR_ITEM: {
-					Item* item = Item::CreateItem(propStream);
-					if (!item) {
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
+					uint16_t id;
+					if (!propStream.read<uint16_t>(id)) {
+						area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z);
 						return false;
 					}
 
-					if (isHouseTile && item->isMoveable()) {
-						std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID()
-						          << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y
-						          << ", z: " << z << "]." << std::endl;
-						delete item;
-					} else {
-						if (item->getItemCount() == 0) {
-							item->setItemCount(1);
-						}
-
-						if (tile) {
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						} else if (item->isGroundTile()) {
-							delete ground_item;
-							ground_item = item;
-						} else {
-							tile = createTile(ground_item, item, x, y, z);
-							tile->internalAddThing(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						}
-					}
+					area.items.push_back({.id = id});
 					break;
 				}
 
 				default:
-					setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z));
+					area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z);
 					return false;
 			}
 		}
 
 		for (auto& itemNode : tileNode.children) {
 			if (itemNode.type != OTBM_ITEM) {
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z));
+				area.error = fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z);
 				return false;
 			}
 
+			area.items.push_back({.node = &itemNode});
+		}
+
+		tile.itemCount = area.items.size() - tile.firstItem;
+	}
+	return true;
+}
+
+bool IOMap::buildTileArea(OTB::Loader& loader, const TileArea& area, Map& map)
+{
+	uint16_t z = area.z;
+	for (auto& staged : area.tiles) {
+		uint16_t x = staged.x;
+		uint16_t y = staged.y;
+
+		House* house = nullptr;
+		Tile* tile = nullptr;
+		Item* ground_item = nullptr;
+
+		if (staged.isHouseTile) {
+			house = map.houses.addHouse(staged.houseId);
+			if (!house) {
+				setLastErrorString(
+				    fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, staged.houseId));
+				return false;
+			}
+
+			tile = new HouseTile(x, y, z, house);
+			house->addTile(static_cast<HouseTile*>(tile));
+		}
+
+		for (size_t i = staged.firstItem, last = staged.firstItem + staged.itemCount; i < last; ++i) {
+			const auto& stagedItem = area.items[i];
+
 			PropStream stream;
-			if (!loader.getProps(itemNode, stream)) {
+			if (!stagedItem.node) {
+				stream.init(reinterpret_cast<const char*>(&stagedItem.id), sizeof(stagedItem.id));
+			} else if (!loader.getProps(*stagedItem.node, stream)) {
 				setLastErrorString("Invalid item node.");
 				return false;
 			}
@@ -343,14 +414,14 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 				return false;
 			}
 
-			if (!item->unserializeItemNode(loader, itemNode, stream)) {
+			if (stagedItem.node && !item->unserializeItemNode(loader, *stagedItem.node, stream)) {
 				setLastErrorString(
 				    fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID()));
 				delete item;
 				return false;
 			}
 
-			if (isHouseTile && item->isMoveable()) {
+			if (staged.isHouseTile && item->isMoveable()) {
 				std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID()
 				          << ", in house: " << house->getId() << ", at position [x: " << x << ", y: " << y
 				          << ", z: " << z << "]." << std::endl;
@@ -380,7 +451,7 @@ bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Ma
 			tile = createTile(ground_item, nullptr, x, y, z);
 		}
 
-		tile->setFlag(static_cast<tileflags_t>(tileflags));
+		tile->setFlag(static_cast<tileflags_t>(staged.flags));
 
 		map.setTile(x, y, z, tile);
 	}
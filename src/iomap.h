@@ -131,11 +131,14 @@ public:
 	void setLastErrorString(std::string error) { errorString = error; }
 
 private:
+	struct TileArea;
+
 	bool parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map,
 	                            const std::filesystem::path& fileName);
 	bool parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map);
 	bool parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map);
-	bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map);
+	static bool parseTileArea(const OTB::Loader& loader, const OTB::Node& tileAreaNode, TileArea& area);
+	bool buildTileArea(OTB::Loader& loader, const TileArea& area, Map& map);
 	std::string errorString;
 };
 
@@ -21,7 +21,7 @@ void IOMapSerialize::loadHouseItems(Map* map)
 	}
 
 	do {
-		auto attr = result->getString("data");
+		auto attr = result->getString(0);
 		PropStream propStream;
 		propStream.init(attr.data(), attr.size());
 
@@ -260,20 +260,20 @@ bool IOMapSerialize::loadHouseInfo()
 	}
 
 	do {
-		House* house = g_game.map.houses.getHouse(result->getNumber<uint32_t>("id"));
+		House* house = g_game.map.houses.getHouse(result->getNumber<uint32_t>(0));
 		if (house) {
-			house->setOwner(result->getNumber<uint32_t>("owner"), false);
-			house->setPaidUntil(result->getNumber<time_t>("paid"));
-			house->setPayRentWarnings(result->getNumber<uint32_t>("warnings"));
+			house->setOwner(result->getNumber<uint32_t>(1), false);
+			house->setPaidUntil(result->getNumber<time_t>(2));
+			house->setPayRentWarnings(result->getNumber<uint32_t>(3));
 		}
 	} while (result->next());
 
 	result = db.storeQuery("SELECT `house_id`, `listid`, `list` FROM `house_lists`");
 	if (result) {
 		do {
-			House* house = g_game.map.houses.getHouse(result->getNumber<uint32_t>("house_id"));
+			House* house = g_game.map.houses.getHouse(result->getNumber<uint32_t>(0));
 			if (house) {
-				house->setAccessList(result->getNumber<uint32_t>("listid"), result->getString("list"));
+				house->setAccessList(result->getNumber<uint32_t>(1), result->getString(2));
 			}
 		} while (result->next());
 	}
@@ -293,21 +293,22 @@ bool IOMapSerialize::saveHouseInfo()
 		return false;
 	}
 
+	DBStatement& selectHouse = db.prepare("SELECT `id` FROM `houses` WHERE `id` = ?");
+	DBStatement& updateHouse = db.prepare(
+	    "UPDATE `houses` SET `owner` = ?, `paid` = ?, `warnings` = ?, `name` = ?, `town_id` = ?, `rent` = ?, `size` = ?, `beds` = ? WHERE `id` = ?");
+	DBStatement& insertHouse = db.prepare(
+	    "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
 	for (const auto& it : g_game.map.houses.getHouses()) {
 		House* house = it.second;
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `id` = {:d}", house->getId()));
-		if (result) {
-			db.executeQuery(fmt::format(
-			    "UPDATE `houses` SET `owner` = {:d}, `paid` = {:d}, `warnings` = {:d}, `name` = {:s}, `town_id` = {:d}, `rent` = {:d}, `size` = {:d}, `beds` = {:d} WHERE `id` = {:d}",
-			    house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
-			    db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
-			    house->getBedCount(), house->getId()));
+		if (selectHouse.storeQuery(house->getId())) {
+			updateHouse.executeQuery(house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
+			                         house->getName(), house->getTownId(), house->getRent(), house->getTiles().size(),
+			                         house->getBedCount(), house->getId());
 		} else {
-			db.executeQuery(fmt::format(
-			    "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ({:d}, {:d}, {:d}, {:d}, {:s}, {:d}, {:d}, {:d}, {:d})",
-			    house->getId(), house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
-			    db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
-			    house->getBedCount()));
+			insertHouse.executeQuery(house->getId(), house->getOwner(), house->getPaidUntil(),
+			                         house->getPayRentWarnings(), house->getName(), house->getTownId(),
+			                         house->getRent(), house->getTiles().size(), house->getBedCount());
 		}
 	}
 
@@ -367,7 +368,7 @@ bool IOMapSerialize::saveHouse(House* house)
 	uint32_t houseId = house->getId();
 
 	// clear old tile data
-	if (!db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` = {:d}", houseId))) {
+	if (!db.prepare("DELETE FROM `tile_store` WHERE `house_id` = ?").executeQuery(houseId)) {
 		return false;
 	}
 
@@ -27,9 +27,11 @@ MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId)
 {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}",
-	    tfs::to_underlying(action), itemId));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = ? AND `itemtype` = ?")
+	        .storeQuery(action, itemId);
 	if (!result) {
 		return offerList;
 	}
@@ -38,13 +40,13 @@ MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId)
 
 	do {
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
+		offer.amount = result->getNumber<uint16_t>(1);
+		offer.price = result->getNumber<uint64_t>(2);
+		offer.timestamp = result->getNumber<uint32_t>(3) + marketOfferDuration;
+		offer.counter = result->getNumber<uint32_t>(0) & 0xFFFF;
 		offer.itemId = itemId;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+		if (result->getNumber<uint16_t>(4) == 0) {
+			offer.playerName = result->getString(5);
 		} else {
 			offer.playerName = "Anonymous";
 		}
@@ -59,20 +61,22 @@ MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId)
 
 	const int32_t marketOfferDuration = getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}",
-	    playerId, tfs::to_underlying(action)));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = ? AND `sale` = ?")
+	        .storeQuery(playerId, action);
 	if (!result) {
 		return offerList;
 	}
 
 	do {
 		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
+		offer.amount = result->getNumber<uint16_t>(1);
+		offer.price = result->getNumber<uint64_t>(2);
+		offer.timestamp = result->getNumber<uint32_t>(3) + marketOfferDuration;
+		offer.counter = result->getNumber<uint32_t>(0) & 0xFFFF;
+		offer.itemId = result->getNumber<uint16_t>(4);
 		offerList.push_back(offer);
 	} while (result->next());
 	return offerList;
@@ -82,21 +86,23 @@ HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId)
 {
 	HistoryMarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = {:d} AND `sale` = {:d}",
-	    playerId, tfs::to_underlying(action)));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = ? AND `sale` = ?")
+	        .storeQuery(playerId, action);
 	if (!result) {
 		return offerList;
 	}
 
 	do {
 		HistoryMarketOffer offer;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("expires_at");
+		offer.itemId = result->getNumber<uint16_t>(0);
+		offer.amount = result->getNumber<uint16_t>(1);
+		offer.price = result->getNumber<uint64_t>(2);
+		offer.timestamp = result->getNumber<uint32_t>(3);
 
-		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
+		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>(4));
 		if (offerState == OFFERSTATE_ACCEPTEDEX) {
 			offerState = OFFERSTATE_ACCEPTED;
 		}
@@ -115,14 +121,14 @@ void processExpiredOffers(DBResult_ptr result, bool)
 	}
 
 	do {
-		if (!moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
+		if (!moveOfferToHistory(result->getNumber<uint32_t>(0), OFFERSTATE_EXPIRED)) {
 			continue;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
+		const uint32_t playerId = result->getNumber<uint32_t>(4);
+		const uint16_t amount = result->getNumber<uint16_t>(1);
+		if (result->getNumber<uint16_t>(5) == 1) {
+			const ItemType& itemType = Item::items[result->getNumber<uint16_t>(3)];
 			if (itemType.id == 0) {
 				continue;
 			}
@@ -172,7 +178,7 @@ void processExpiredOffers(DBResult_ptr result, bool)
 				delete player;
 			}
 		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
+			uint64_t totalPrice = result->getNumber<uint64_t>(2) * amount;
 
 			Player* player = g_game.getPlayerByGUID(playerId);
 			if (player) {
@@ -204,12 +210,13 @@ void checkExpiredOffers()
 
 uint32_t getPlayerOfferCount(uint32_t playerId)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(
-	    fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
+	DBResult_ptr result = Database::getInstance()
+	                          .prepare("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = ?")
+	                          .storeQuery(playerId);
 	if (!result) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return result->getNumber<int32_t>(0);
 }
 
 MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter)
@@ -218,25 +225,27 @@ MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter)
 
 	const int32_t created = timestamp - getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1",
-	    created, counter));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = ? AND (`id` & 65535) = ? LIMIT 1")
+	        .storeQuery(created, counter);
 	if (!result) {
 		offer.id = 0;
 		offer.playerId = 0;
 		return offer;
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint64_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
+	offer.id = result->getNumber<uint32_t>(0);
+	offer.type = result->getNumber<MarketAction_t>(1);
+	offer.amount = result->getNumber<uint16_t>(3);
+	offer.counter = offer.id & 0xFFFF;
+	offer.timestamp = result->getNumber<uint32_t>(4);
+	offer.price = result->getNumber<uint64_t>(5);
+	offer.itemId = result->getNumber<uint16_t>(2);
+	offer.playerId = result->getNumber<uint32_t>(6);
+	if (result->getNumber<uint16_t>(7) == 0) {
+		offer.playerName = result->getString(8);
 	} else {
 		offer.playerName = "Anonymous";
 	}
@@ -246,29 +255,33 @@ MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter)
 void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price,
                  bool anonymous)
 {
-	Database::getInstance().executeQuery(fmt::format(
-	    "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
-	    playerId, tfs::to_underlying(action), itemId, amount, price, time(nullptr), anonymous));
+	Database::getInstance()
+	    .prepare(
+	        "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES (?, ?, ?, ?, ?, ?, ?)")
+	    .executeQuery(playerId, action, itemId, amount, price, time(nullptr), anonymous);
 }
 
 void acceptOffer(uint32_t offerId, uint16_t amount)
 {
-	Database::getInstance().executeQuery(
-	    fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	Database::getInstance()
+	    .prepare("UPDATE `market_offers` SET `amount` = `amount` - ? WHERE `id` = ?")
+	    .executeQuery(amount, offerId);
 }
 
 void deleteOffer(uint32_t offerId)
 {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	Database::getInstance().prepare("DELETE FROM `market_offers` WHERE `id` = ?").executeQuery(offerId);
 }
 
 void appendHistory(uint32_t playerId, MarketAction_t action, uint16_t itemId, uint16_t amount, uint64_t price,
                    time_t timestamp, MarketOfferState_t state)
 {
-	g_databaseTasks.addTask(fmt::format(
-	    "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
-	    playerId, tfs::to_underlying(action), itemId, amount, price, timestamp, time(nullptr),
-	    tfs::to_underlying(state)));
+	g_databaseTasks.addTask(
+	    fmt::format(
+	        "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
+	        playerId, tfs::to_underlying(action), itemId, amount, price, timestamp, time(nullptr),
+	        tfs::to_underlying(state)),
+	    nullptr, false, playerId);
 }
 
 bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
@@ -277,45 +290,47 @@ bool moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format(
-	    "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}",
-	    offerId));
+	DBResult_ptr result =
+	    db.prepare(
+	          "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = ?")
+	        .storeQuery(offerId);
 	if (!result) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
+	if (!db.prepare("DELETE FROM `market_offers` WHERE `id` = ?").executeQuery(offerId)) {
 		return false;
 	}
 
-	appendHistory(
-	    result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")),
-	    result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"),
-	    result->getNumber<uint64_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
+	appendHistory(result->getNumber<uint32_t>(0), result->getNumber<MarketAction_t>(1), result->getNumber<uint16_t>(2),
+	              result->getNumber<uint16_t>(3), result->getNumber<uint64_t>(4),
+	              result->getNumber<uint32_t>(5) + marketOfferDuration, state);
 	return true;
 }
 
 void updateStatistics()
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = {:d} GROUP BY `itemtype`, `sale`",
-	    tfs::to_underlying(OFFERSTATE_ACCEPTED)));
+	DBResult_ptr result =
+	    Database::getInstance()
+	        .prepare(
+	            "SELECT `sale` AS `sale`, `itemtype` AS `itemtype`, COUNT(`price`) AS `num`, MIN(`price`) AS `min`, MAX(`price`) AS `max`, SUM(`price`) AS `sum` FROM `market_history` WHERE `state` = ? GROUP BY `itemtype`, `sale`")
+	        .storeQuery(OFFERSTATE_ACCEPTED);
 	if (!result) {
 		return;
 	}
 
 	do {
 		MarketStatistics* statistics;
-		if (result->getNumber<uint16_t>("sale") == MARKETACTION_BUY) {
-			statistics = &purchaseStatistics[result->getNumber<uint16_t>("itemtype")];
+		if (result->getNumber<uint16_t>(0) == MARKETACTION_BUY) {
+			statistics = &purchaseStatistics[result->getNumber<uint16_t>(1)];
 		} else {
-			statistics = &saleStatistics[result->getNumber<uint16_t>("itemtype")];
+			statistics = &saleStatistics[result->getNumber<uint16_t>(1)];
 		}
 
-		statistics->numTransactions = result->getNumber<uint32_t>("num");
-		statistics->lowestPrice = result->getNumber<uint64_t>("min");
-		statistics->totalPrice = result->getNumber<uint64_t>("sum");
-		statistics->highestPrice = result->getNumber<uint64_t>("max");
+		statistics->numTransactions = result->getNumber<uint32_t>(2);
+		statistics->lowestPrice = result->getNumber<uint64_t>(3);
+		statistics->totalPrice = result->getNumber<uint64_t>(5);
+		statistics->highestPrice = result->getNumber<uint64_t>(4);
 	} while (result->next());
 }
 
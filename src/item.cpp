@@ -148,6 +148,9 @@ Item::Item(const Item& i) : Thing(), id(i.id), count(i.count), loadedFromMap(i.l
 {
 	if (i.attributes) {
 		attributes.reset(new ItemAttributes(*i.attributes));
+		if (i.isDecayScheduled()) {
+			setDuration(i.getDuration());
+		}
 	}
 }
 
@@ -156,10 +159,12 @@ Item* Item::clone() const
 	Item* item = Item::CreateItem(id, count);
 	if (attributes) {
 		item->attributes.reset(new ItemAttributes(*attributes));
+		if (isDecayScheduled()) {
+			item->setDuration(getDuration());
+		}
+
 		if (item->getDuration() > 0) {
-			item->incrementReferenceCounter();
-			item->setDecaying(DECAYING_TRUE);
-			g_game.toDecayItems.push_front(item);
+			g_game.scheduleDecay(item);
 		}
 	}
 	return item;
@@ -234,6 +239,10 @@ void Item::onRemoved()
 
 void Item::setID(uint16_t newid)
 {
+	// the remaining time is kept while the type changes, and counts on below if the new type decays as well
+	const bool wasDecaying = isDecayScheduled();
+	g_game.stopDecay(this);
+
 	const ItemType& prevIt = Item::items[id];
 	id = newid;
 
@@ -251,6 +260,23 @@ void Item::setID(uint16_t newid)
 		setDecaying(DECAYING_FALSE);
 		setDuration(newDuration);
 	}
+
+	if (wasDecaying && getDuration() > 0 && getDecayTo() >= 0 && (getDecayTimeMin() != 0 || getDecayTimeMax() != 0)) {
+		g_game.scheduleDecay(this);
+	}
+}
+
+void Item::setDuration(int32_t time)
+{
+	if (!isDecayScheduled()) {
+		setIntAttr(ITEM_ATTRIBUTE_DURATION, time);
+		return;
+	}
+
+	// a decaying item counts down from the new duration
+	g_game.stopDecay(this);
+	setIntAttr(ITEM_ATTRIBUTE_DURATION, time);
+	g_game.scheduleDecay(this);
 }
 
 Cylinder* Item::getTopParent()
@@ -788,7 +814,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 
 	if (hasAttribute(ITEM_ATTRIBUTE_DURATION)) {
 		propWriteStream.write<uint8_t>(ATTR_DURATION);
-		propWriteStream.write<uint32_t>(getIntAttr(ITEM_ATTRIBUTE_DURATION));
+		propWriteStream.write<uint32_t>(getDuration());
 	}
 
 	ItemDecayState_t decayState = getDecaying();
@@ -1203,6 +1229,16 @@ void ItemAttributes::setIntAttr(itemAttrTypes type, int64_t value)
 
 void ItemAttributes::increaseIntAttr(itemAttrTypes type, int64_t value) { setIntAttr(type, getIntAttr(type) + value); }
 
+uint32_t ItemAttributes::getDuration() const
+{
+	if (!decayTimer.isScheduled()) {
+		return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+	}
+
+	const int64_t remaining = static_cast<int64_t>(decayTimer.getExpiration()) - OTSYS_TIME();
+	return static_cast<uint32_t>(std::max<int64_t>(remaining, 0));
+}
+
 const ItemAttributes::Attribute* ItemAttributes::getExistingAttr(itemAttrTypes type) const
 {
 	if (hasAttribute(type)) {
@@ -1258,8 +1294,7 @@ bool Item::hasMarketAttributes() const
 				return false;
 			}
 		} else if (attr.type == ITEM_ATTRIBUTE_DURATION) {
-			uint32_t duration = static_cast<uint32_t>(attr.value.integer);
-			if (duration <= getDefaultDurationMin()) {
+			if (getDuration() <= getDefaultDurationMin()) {
 				return false;
 			}
 		} else {
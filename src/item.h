@@ -8,6 +8,7 @@
 #include "items.h"
 #include "luascript.h"
 #include "thing.h"
+#include "timingwheel.h"
 
 class BedItem;
 class Container;
@@ -102,6 +103,19 @@ enum Attr_ReadValue
 	ATTR_READ_END,
 };
 
+/**
+ * @brief Link of a decaying item in the decay wheel of Game. Copies start unscheduled, so copying the attributes of
+ * a decaying item never links the copy into the wheel.
+ */
+struct DecayTimer : TimerNode
+{
+	DecayTimer() = default;
+	DecayTimer(const DecayTimer&) : TimerNode() {}
+	DecayTimer& operator=(const DecayTimer&) { return *this; }
+
+	Item* item = nullptr;
+};
+
 class ItemAttributes
 {
 public:
@@ -141,8 +155,7 @@ public:
 	uint32_t getCorpseOwner() const { return getIntAttr(ITEM_ATTRIBUTE_CORPSEOWNER); }
 
 	void setDuration(int32_t time) { setIntAttr(ITEM_ATTRIBUTE_DURATION, time); }
-	void decreaseDuration(int32_t time) { increaseIntAttr(ITEM_ATTRIBUTE_DURATION, -time); }
-	uint32_t getDuration() const { return getIntAttr(ITEM_ATTRIBUTE_DURATION); }
+	uint32_t getDuration() const;
 
 	void setDecaying(ItemDecayState_t decayState) { setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState); }
 	ItemDecayState_t getDecaying() const
@@ -357,6 +370,9 @@ private:
 	std::map<CombatType_t, Reflect> reflect;
 	std::map<CombatType_t, uint16_t> boostPercent;
 
+	// while it is scheduled the duration attribute is stale, the remaining time follows from the expiration
+	DecayTimer decayTimer;
+
 	const Reflect& getReflect(CombatType_t combatType)
 	{
 		auto it = reflect.find(combatType);
@@ -678,16 +694,18 @@ public:
 		return getIntAttr(ITEM_ATTRIBUTE_CORPSEOWNER);
 	}
 
-	void setDuration(int32_t time) { setIntAttr(ITEM_ATTRIBUTE_DURATION, time); }
-	void decreaseDuration(int32_t time) { increaseIntAttr(ITEM_ATTRIBUTE_DURATION, -time); }
+	void setDuration(int32_t time);
 	uint32_t getDuration() const
 	{
 		if (!attributes) {
 			return 0;
 		}
-		return getIntAttr(ITEM_ATTRIBUTE_DURATION);
+		return attributes->getDuration();
 	}
 
+	DecayTimer& getDecayTimer() { return getAttributes()->decayTimer; }
+	bool isDecayScheduled() const { return attributes && attributes->decayTimer.isScheduled(); }
+
 	void setDecaying(ItemDecayState_t decayState) { setIntAttr(ITEM_ATTRIBUTE_DECAYSTATE, decayState); }
 	ItemDecayState_t getDecaying() const
 	{
@@ -94,6 +94,18 @@ void setField(lua_State* L, const char* index, std::string_view value)
 	lua_setfield(L, -2, index);
 }
 
+// times in milliseconds, the percentiles are the upper bounds of their histogram buckets
+void pushProfilerStats(lua_State* L, const tfs::profiler::Stats& stats)
+{
+	lua_createtable(L, 0, 6);
+	setField(L, "count", stats.count);
+	setField(L, "total", stats.totalMicroseconds / 1000.0);
+	setField(L, "average", stats.count != 0 ? stats.totalMicroseconds / 1000.0 / stats.count : 0.0);
+	setField(L, "p50", stats.getPercentile(0.5) / 1000.0);
+	setField(L, "p99", stats.getPercentile(0.99) / 1000.0);
+	setField(L, "max", stats.maxMicroseconds / 1000.0);
+}
+
 void registerClass(lua_State* L, std::string_view className, std::string_view baseClass,
                    lua_CFunction newFunction = nullptr)
 {
@@ -696,6 +708,7 @@ bool LuaScriptInterface::closeState()
 	}
 
 	cacheFiles.clear();
+	eventHistograms.clear();
 	if (eventTableRef != -1) {
 		luaL_unref(L, LUA_REGISTRYINDEX, eventTableRef);
 		eventTableRef = -1;
@@ -705,8 +718,38 @@ bool LuaScriptInterface::closeState()
 	return true;
 }
 
+tfs::profiler::Histogram* LuaScriptInterface::getEventHistogram(int params)
+{
+	if (!tfs::profiler::isEnabled()) {
+		return nullptr;
+	}
+
+	// combat callbacks run without a script id, their function is the one of the callback id
+	auto [scriptId, scriptInterface, callbackId, timerEvent] = tfs::lua::getScriptEnv()->getEventInfo();
+	const uint64_t key = uint64_t{static_cast<uint32_t>(scriptId)} << 32 |
+	                     uint64_t{static_cast<uint32_t>(callbackId)} << 1 | (timerEvent ? 1 : 0);
+	auto it = eventHistograms.find(key);
+	if (it == eventHistograms.end()) {
+		std::string name;
+		if (timerEvent) {
+			// every addEvent may pass another function, they are counted together per script
+			name = getFileById(scriptId) + " (addEvent)";
+		} else {
+			// the events of a revscript all come from one file, the line their function starts at tells them apart
+			lua_Debug ar;
+			lua_pushvalue(L, -(params + 1));
+			lua_getinfo(L, ">S", &ar);
+			name = fmt::format("{:s}:{:d}", getFileById(callbackId != 0 ? callbackId : scriptId), ar.linedefined);
+		}
+		it = eventHistograms.emplace(key, &tfs::profiler::getLuaHistogram(name)).first;
+	}
+	return it->second;
+}
+
 bool LuaScriptInterface::callFunction(int params)
 {
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::LUA, getEventHistogram(params)};
+
 	bool result = false;
 	int size = lua_gettop(L);
 	if (tfs::lua::protectedCall(L, params, 1) != 0) {
@@ -726,6 +769,8 @@ bool LuaScriptInterface::callFunction(int params)
 
 void LuaScriptInterface::callVoidFunction(int params)
 {
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::LUA, getEventHistogram(params)};
+
 	int size = lua_gettop(L);
 	if (tfs::lua::protectedCall(L, params, 0) != 0) {
 		reportErrorFunc(nullptr, tfs::lua::popString(L));
@@ -2416,6 +2461,9 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod(L, "Game", "startEvent", LuaScriptInterface::luaGameStartEvent);
 
 	registerMethod(L, "Game", "getClientVersion", LuaScriptInterface::luaGameGetClientVersion);
+	registerMethod(L, "Game", "getProfile", LuaScriptInterface::luaGameGetProfile);
+	registerMethod(L, "Game", "resetProfile", LuaScriptInterface::luaGameResetProfile);
+	registerMethod(L, "Game", "setProfilerEnabled", LuaScriptInterface::luaGameSetProfilerEnabled);
 
 	registerMethod(L, "Game", "reload", LuaScriptInterface::luaGameReload);
 
@@ -4207,9 +4255,12 @@ int LuaScriptInterface::luaDatabaseExecute(lua_State* L)
 
 int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L)
 {
-	// db.asyncQuery(query, callback)
+	// db.asyncQuery(query[, callback[, key]])
+	// queries with the same key run in the order they were added
+	const uint64_t key = tfs::lua::getNumber<uint64_t>(L, 3, 0);
 	std::function<void(const DBResult_ptr&, bool)> callback;
-	if (lua_gettop(L) > 1) {
+	if (lua_isfunction(L, 2)) {
+		lua_pushvalue(L, 2);
 		int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
 		auto scriptId = tfs::lua::getScriptEnv()->getScriptId();
 		callback = [ref, scriptId](const DBResult_ptr&, bool success) {
@@ -4232,7 +4283,7 @@ int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L)
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(tfs::lua::getString(L, -1), callback);
+	g_databaseTasks.addTask(tfs::lua::getString(L, 1), callback, false, key);
 	return 0;
 }
 
@@ -4249,9 +4300,12 @@ int LuaScriptInterface::luaDatabaseStoreQuery(lua_State* L)
 
 int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 {
-	// db.asyncStoreQuery(query, callback)
+	// db.asyncStoreQuery(query[, callback[, key]])
+	// queries with the same key run in the order they were added
+	const uint64_t key = tfs::lua::getNumber<uint64_t>(L, 3, 0);
 	std::function<void(const DBResult_ptr&, bool)> callback;
-	if (lua_gettop(L) > 1) {
+	if (lua_isfunction(L, 2)) {
+		lua_pushvalue(L, 2);
 		int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
 		auto scriptId = tfs::lua::getScriptEnv()->getScriptId();
 		callback = [ref, scriptId](const DBResult_ptr& result, bool) {
@@ -4278,7 +4332,7 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 			luaL_unref(L, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(tfs::lua::getString(L, -1), callback, true);
+	g_databaseTasks.addTask(tfs::lua::getString(L, 1), callback, true, key);
 	return 0;
 }
 
@@ -5154,6 +5208,56 @@ int LuaScriptInterface::luaGameGetClientVersion(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetProfile(lua_State* L)
+{
+	// Game.getProfile()
+	// totals since startup or the last reset
+	lua_createtable(L, 0, 4);
+	tfs::lua::pushBoolean(L, tfs::profiler::isEnabled());
+	lua_setfield(L, -2, "enabled");
+
+	lua_createtable(L, 0, tfs::profiler::SECTIONS);
+	for (size_t i = 0; i < tfs::profiler::SECTIONS; ++i) {
+		const auto section = static_cast<tfs::profiler::Section>(i);
+		pushProfilerStats(L, tfs::profiler::getHistogram(section).getStats());
+		lua_setfield(L, -2, tfs::profiler::getSectionName(section).data());
+	}
+	lua_setfield(L, -2, "sections");
+
+	const auto events = tfs::profiler::getLuaStats();
+	lua_createtable(L, 0, events.size());
+	for (const auto& [name, stats] : events) {
+		pushProfilerStats(L, stats);
+		lua_setfield(L, -2, name.data());
+	}
+	lua_setfield(L, -2, "events");
+
+	lua_createtable(L, tfs::profiler::CREATURE_BUCKETS, 0);
+	for (size_t i = 0; i < tfs::profiler::CREATURE_BUCKETS; ++i) {
+		pushProfilerStats(L, tfs::profiler::getCreatureBucketHistogram(i).getStats());
+		setField(L, "creatures", g_game.getCheckCreatureCount(i));
+		lua_rawseti(L, -2, i + 1);
+	}
+	lua_setfield(L, -2, "creatureBuckets");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameResetProfile(lua_State* L)
+{
+	// Game.resetProfile()
+	tfs::profiler::reset();
+	tfs::lua::pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameSetProfilerEnabled(lua_State* L)
+{
+	// Game.setProfilerEnabled(enabled)
+	tfs::profiler::setEnabled(tfs::lua::getBoolean(L, 1));
+	tfs::lua::pushBoolean(L, true);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameReload(lua_State* L)
 {
 	// Game.reload(reloadType)
@@ -6953,7 +7057,9 @@ int LuaScriptInterface::luaItemGetAttribute(lua_State* L)
 		attribute = ITEM_ATTRIBUTE_NONE;
 	}
 
-	if (ItemAttributes::isIntAttrType(attribute)) {
+	if (attribute == ITEM_ATTRIBUTE_DURATION) {
+		lua_pushnumber(L, item->getDuration());
+	} else if (ItemAttributes::isIntAttrType(attribute)) {
 		lua_pushnumber(L, item->getIntAttr(attribute));
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		tfs::lua::pushString(L, item->getStrAttr(attribute));
@@ -6988,7 +7094,14 @@ int LuaScriptInterface::luaItemSetAttribute(lua_State* L)
 			return 1;
 		}
 
-		item->setIntAttr(attribute, tfs::lua::getNumber<int32_t>(L, 3));
+		const int32_t value = tfs::lua::getNumber<int32_t>(L, 3);
+		if (attribute == ITEM_ATTRIBUTE_DURATION) {
+			item->setDuration(value);
+		} else if (attribute == ITEM_ATTRIBUTE_DECAYSTATE && value == DECAYING_FALSE) {
+			g_game.stopDecay(item);
+		} else {
+			item->setIntAttr(attribute, value);
+		}
 		tfs::lua::pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, tfs::lua::getString(L, 3));
@@ -7019,6 +7132,9 @@ int LuaScriptInterface::luaItemRemoveAttribute(lua_State* L)
 
 	bool ret = attribute != ITEM_ATTRIBUTE_UNIQUEID;
 	if (ret) {
+		if (attribute == ITEM_ATTRIBUTE_DURATION || attribute == ITEM_ATTRIBUTE_DECAYSTATE) {
+			g_game.stopDecay(item);
+		}
 		item->removeAttribute(attribute);
 	} else {
 		reportErrorFunc(L, "Attempt to erase protected key \"uid\"");
@@ -10840,11 +10956,39 @@ int LuaScriptInterface::luaPlayerAddMapMark(lua_State* L)
 
 int LuaScriptInterface::luaPlayerSave(lua_State* L)
 {
-	// player:save()
+	// player:save([callback])
+	// the save is written later, the callback gets whether it was
 	Player* player = tfs::lua::getUserdata<Player>(L, 1);
 	if (player) {
+		std::function<void(bool)> callback;
+		if (lua_isfunction(L, 2)) {
+			lua_pushvalue(L, 2);
+			int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
+			auto scriptId = tfs::lua::getScriptEnv()->getScriptId();
+			callback = [ref, scriptId](bool saved) {
+				lua_State* L = g_luaEnvironment.getLuaState();
+				if (!L) {
+					return;
+				}
+
+				if (!tfs::lua::reserveScriptEnv()) {
+					luaL_unref(L, LUA_REGISTRYINDEX, ref);
+					return;
+				}
+
+				lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+				tfs::lua::pushBoolean(L, saved);
+				auto env = tfs::lua::getScriptEnv();
+				env->setScriptId(scriptId, &g_luaEnvironment);
+				g_luaEnvironment.callFunction(1);
+
+				luaL_unref(L, LUA_REGISTRYINDEX, ref);
+			};
+		}
+
 		player->loginPosition = player->getPosition();
-		tfs::lua::pushBoolean(L, IOLoginData::savePlayer(player));
+		IOLoginData::savePlayer(player, std::move(callback));
+		tfs::lua::pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
 	}
@@ -18743,6 +18887,7 @@ bool LuaEnvironment::closeState()
 	areaIdMap.clear();
 	timerEvents.clear();
 	cacheFiles.clear();
+	eventHistograms.clear();
 
 	lua_close(L);
 	L = nullptr;
@@ -7,6 +7,7 @@
 #include "database.h"
 #include "enums.h"
 #include "position.h"
+#include "profiler.h"
 
 #if LUA_VERSION_NUM >= 502
 #ifndef LUA_COMPAT_ALL
@@ -166,8 +167,13 @@ protected:
 
 	// script file cache
 	std::map<int32_t, std::string> cacheFiles;
+	// profiler histograms of the events, by script id, callback id and whether it ran as an addEvent timer
+	std::unordered_map<uint64_t, tfs::profiler::Histogram*> eventHistograms;
 
 private:
+	// the function about to be called is on the stack below its parameters
+	tfs::profiler::Histogram* getEventHistogram(int params);
+
 	// lua functions
 	static int luaDoPlayerAddItem(lua_State* L);
 
@@ -308,6 +314,9 @@ private:
 	static int luaGameStartEvent(lua_State* L);
 
 	static int luaGameGetClientVersion(lua_State* L);
+	static int luaGameGetProfile(lua_State* L);
+	static int luaGameResetProfile(lua_State* L);
+	static int luaGameSetProfilerEnabled(lua_State* L);
 
 	static int luaGameReload(lua_State* L);
 
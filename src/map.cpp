@@ -11,10 +11,67 @@
 #include "iomap.h"
 #include "iomapserialize.h"
 #include "monster.h"
+#include "networkmessage.h"
+#include "profiler.h"
 #include "spectators.h"
 
 extern Game g_game;
 
+namespace {
+
+// the largest floor distance between the center and a spectator of a multifloor query (floor 0 seen from 7)
+constexpr int32_t maxSpectatorOffsetZ = 7;
+
+std::pair<int32_t, int32_t> getSpectatorRangeZ(const Position& centerPos, bool multifloor)
+{
+	if (!multifloor) {
+		return {centerPos.z, centerPos.z};
+	}
+
+	if (centerPos.z > 7) {
+		// underground (8->15)
+		return {std::max(centerPos.getZ() - 2, 0), std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1)};
+	} else if (centerPos.z == 6) {
+		return {0, 8};
+	} else if (centerPos.z == 7) {
+		return {0, 9};
+	}
+	return {0, 7};
+}
+
+// whether a creature at pos is part of the full viewport, multifloor spectators of centerPos
+bool isInSpectatorRange(const Position& centerPos, const Position& pos)
+{
+	auto [minRangeZ, maxRangeZ] = getSpectatorRangeZ(centerPos, true);
+	if (minRangeZ > pos.z || maxRangeZ < pos.z) {
+		return false;
+	}
+
+	int32_t offsetZ = centerPos.getOffsetZ(pos);
+	return centerPos.x - Map::maxViewportX + offsetZ <= pos.x && centerPos.x + Map::maxViewportX + offsetZ >= pos.x &&
+	       centerPos.y - Map::maxViewportY + offsetZ <= pos.y && centerPos.y + Map::maxViewportY + offsetZ >= pos.y;
+}
+
+// a path search gives up after expanding this many nodes
+constexpr int32_t maxPathIterations = Map::maxViewportX * Map::maxViewportY;
+
+// every node is at most one step further from the start than the node it was expanded from, so no search reaches a
+// tile further away than this
+constexpr int32_t pathSearchRadius = maxPathIterations;
+constexpr int32_t pathSearchWindowSize = pathSearchRadius * 2 + 1;
+
+static_assert(TileDescriptionCache::MAX_ITEMS == MAX_STACKPOS);
+
+// items whose bytes change without the tile being told, such as a decaying duration or the ammo in a quiver
+bool hasVolatileDescription(const Item* item)
+{
+	const ItemType& it = Item::items[item->getID()];
+	return it.showClientCharges || it.showClientDuration || it.isPodium() ||
+	       (it.isContainer() && it.weaponType == WEAPON_QUIVER);
+}
+
+} // namespace
+
 bool Map::loadMap(const std::string& identifier, bool loadHouses, bool isCalledByLua)
 {
 	IOMap loader;
@@ -405,34 +462,27 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 	minRangeY = (minRangeY == 0 ? -maxViewportY : -minRangeY);
 	maxRangeY = (maxRangeY == 0 ? maxViewportY : maxRangeY);
 
+	const uint64_t cacheKey = SpectatorCache::packPosition(centerPos);
 	if (minRangeX == -maxViewportX && maxRangeX == maxViewportX && minRangeY == -maxViewportY &&
 	    maxRangeY == maxViewportY && multifloor) {
-		if (onlyPlayers) {
-			auto it = playersSpectatorCache.find(centerPos);
-			if (it != playersSpectatorCache.end()) {
+		if (SpectatorCache::Entry* entry = spectatorCache.find(cacheKey)) {
+			if (onlyPlayers && entry->hasPlayers) {
 				if (!spectators.empty()) {
-					spectators.addSpectators(it->second);
+					spectators.addSpectators(entry->players);
 				} else {
-					spectators = it->second;
+					spectators = entry->players;
 				}
 
 				foundCache = true;
-			}
-		}
-
-		if (!foundCache) {
-			auto it = spectatorCache.find(centerPos);
-			if (it != spectatorCache.end()) {
+			} else if (entry->hasSpectators) {
 				if (!onlyPlayers) {
 					if (!spectators.empty()) {
-						const SpectatorVec& cachedSpectators = it->second;
-						spectators.addSpectators(cachedSpectators);
+						spectators.addSpectators(entry->spectators);
 					} else {
-						spectators = it->second;
+						spectators = entry->spectators;
 					}
 				} else {
-					const SpectatorVec& cachedSpectators = it->second;
-					for (Creature* spectator : cachedSpectators) {
+					for (Creature* spectator : entry->spectators) {
 						if (spectator->getPlayer()) {
 							spectators.emplace_back(spectator);
 						}
@@ -440,52 +490,98 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, boo
 				}
 
 				foundCache = true;
-			} else {
-				cacheResult = true;
 			}
 		}
-	}
 
-	if (!foundCache) {
-		int32_t minRangeZ;
-		int32_t maxRangeZ;
-
-		if (multifloor) {
-			if (centerPos.z > 7) {
-				// underground (8->15)
-				minRangeZ = std::max(centerPos.getZ() - 2, 0);
-				maxRangeZ = std::min(centerPos.getZ() + 2, MAP_MAX_LAYERS - 1);
-			} else if (centerPos.z == 6) {
-				minRangeZ = 0;
-				maxRangeZ = 8;
-			} else if (centerPos.z == 7) {
-				minRangeZ = 0;
-				maxRangeZ = 9;
-			} else {
-				minRangeZ = 0;
-				maxRangeZ = 7;
-			}
+		if (foundCache) {
+			spectatorCache.hits.fetch_add(1, std::memory_order_relaxed);
 		} else {
-			minRangeZ = centerPos.z;
-			maxRangeZ = centerPos.z;
+			spectatorCache.misses.fetch_add(1, std::memory_order_relaxed);
+			// results appended to a non-empty vector would carry the caller's creatures into the cache
+			cacheResult = spectators.empty();
 		}
+	}
 
+	if (!foundCache) {
+		auto [minRangeZ, maxRangeZ] = getSpectatorRangeZ(centerPos, multifloor);
 		getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ,
 		                      onlyPlayers);
 
 		if (cacheResult) {
-			if (onlyPlayers) {
-				playersSpectatorCache[centerPos] = spectators;
-			} else {
-				spectatorCache[centerPos] = spectators;
+			if (QTreeLeafNode* leaf = getQTNode(centerPos.x, centerPos.y)) {
+				SpectatorCache::Entry& entry = spectatorCache.emplace(cacheKey, leaf);
+				if (onlyPlayers) {
+					entry.players = spectators;
+					entry.hasPlayers = true;
+				} else {
+					entry.spectators = spectators;
+					entry.hasSpectators = true;
+				}
 			}
 		}
 	}
 }
 
-void Map::clearSpectatorCache() { spectatorCache.clear(); }
+void Map::clearSpectatorCache(const Position& pos, bool isPlayer)
+{
+	if (spectatorCache.size() == 0) {
+		return;
+	}
+
+	// only centers in this area can have pos inside their viewport
+	const int32_t x1 = std::max<int32_t>(0, pos.x - maxViewportX - maxSpectatorOffsetZ);
+	const int32_t y1 = std::max<int32_t>(0, pos.y - maxViewportY - maxSpectatorOffsetZ);
+	const int32_t x2 = std::min<int32_t>(0xFFFF, pos.x + maxViewportX + maxSpectatorOffsetZ);
+	const int32_t y2 = std::min<int32_t>(0xFFFF, pos.y + maxViewportY + maxSpectatorOffsetZ);
+
+	const int32_t startx1 = x1 - (x1 % FLOOR_SIZE);
+	const int32_t starty1 = y1 - (y1 % FLOOR_SIZE);
+	const int32_t endx2 = x2 - (x2 % FLOOR_SIZE);
+	const int32_t endy2 = y2 - (y2 % FLOOR_SIZE);
+
+	QTreeLeafNode* leafS = QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, startx1, starty1);
+	QTreeLeafNode* leafE;
+
+	for (int_fast32_t ny = starty1; ny <= endy2; ny += FLOOR_SIZE) {
+		leafE = leafS;
+		for (int_fast32_t nx = startx1; nx <= endx2; nx += FLOOR_SIZE) {
+			if (leafE) {
+				auto& keys = leafE->spectatorCacheKeys;
+				for (size_t i = 0; i < keys.size();) {
+					const uint64_t key = keys[i];
+					SpectatorCache::Entry* entry = spectatorCache.find(key);
+					if (entry && isInSpectatorRange(SpectatorCache::unpackPosition(key), pos)) {
+						entry->hasSpectators = false;
+						if (isPlayer) {
+							entry->hasPlayers = false;
+						}
+
+						if (!entry->hasPlayers) {
+							spectatorCache.erase(key);
+							entry = nullptr;
+						}
+					}
 
-void Map::clearPlayersSpectatorCache() { playersSpectatorCache.clear(); }
+					if (!entry) {
+						keys[i] = keys.back();
+						keys.pop_back();
+					} else {
+						++i;
+					}
+				}
+				leafE = leafE->leafE;
+			} else {
+				leafE = QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, nx + FLOOR_SIZE, ny);
+			}
+		}
+
+		if (leafS) {
+			leafS = leafS->leafS;
+		} else {
+			leafS = QTreeNode::getLeafStatic<QTreeLeafNode*, QTreeNode*>(&root, startx1, ny + FLOOR_SIZE);
+		}
+	}
+}
 
 bool Map::canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight /*= true*/,
                            bool sameFloor /*= false*/, int32_t rangex /*= Map::maxClientViewportX*/,
@@ -673,6 +769,9 @@ static uint16_t calculateHeuristic(const Position& p1, const Position& p2)
 bool Map::getPathMatching(const Creature& creature, const Position& targetPos, std::vector<Direction>& dirList,
                           const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp) const
 {
+	// on the dispatcher and on the pathfinding threads
+	tfs::profiler::ScopedTimer timer{tfs::profiler::Section::PATHFINDING};
+
 	Position pos = creature.getPosition();
 	const Position startPos = pos;
 
@@ -706,7 +805,8 @@ bool Map::getPathMatching(const Creature& creature, const Position& targetPos, s
 	bool sightClear = isSightClear(startPos, targetPos, true, true);
 
 	Position endPos;
-	AStarNodes nodes(pos.x, pos.y);
+	AStarNodes& nodes = AStarNodes::getInstance();
+	nodes.reset(pos.x, pos.y);
 
 	AStarNode* found = nullptr;
 	int32_t bestMatch = 0;
@@ -715,7 +815,7 @@ bool Map::getPathMatching(const Creature& creature, const Position& targetPos, s
 	while (n) {
 		iterations++;
 
-		if (iterations >= Map::maxViewportX * Map::maxViewportY) {
+		if (iterations >= maxPathIterations) {
 			return false;
 		}
 
@@ -805,9 +905,7 @@ bool Map::getPathMatching(const Creature& creature, const Position& targetPos, s
 					continue;
 				}
 
-				neighborNode->g = g;
-				neighborNode->f = newf;
-				neighborNode->parent = n;
+				nodes.updateNode(neighborNode, n, g, newf);
 			} else {
 				// Does not exist in the open/closed list, create a new node
 				if (!nodes.createNode(n, pos.x, pos.y, g, newf)) {
@@ -863,46 +961,143 @@ bool Map::getPathMatching(const Creature& creature, const Position& targetPos, s
 }
 
 // AStarNodes
-AStarNodes::AStarNodes(uint16_t x, uint16_t y) : nodes(), nodeMap()
+AStarNodes::AStarNodes() :
+    nodes(Map::nodeReserveSize),
+    openSet(Map::nodeReserveSize),
+    grid(pathSearchWindowSize * pathSearchWindowSize, INVALID_INDEX)
+{}
+
+AStarNodes& AStarNodes::getInstance()
+{
+	static thread_local AStarNodes instance;
+	return instance;
+}
+
+void AStarNodes::reset(uint16_t x, uint16_t y)
 {
-	nodes.reserve(Map::nodeReserveSize);
-	nodeMap.reserve(Map::nodeReserveSize);
-	visited.reserve(Map::nodeReserveSize);
+	// only the tiles touched by the previous search need to be cleared
+	for (int16_t i = 0; i < nodeCount; ++i) {
+		grid[getGridIndex(nodes[i].x, nodes[i].y)] = INVALID_INDEX;
+	}
+
+	nodeCount = 0;
+	openSetSize = 0;
+	originX = x;
+	originY = y;
 	createNode(nullptr, x, y, 0, 0);
 }
 
 AStarNode* AStarNodes::createNode(AStarNode* parent, uint16_t x, uint16_t y, uint16_t g, uint16_t f)
 {
-	if (nodes.size() == Map::nodeReserveSize) {
+	if (nodeCount == Map::nodeReserveSize) {
+		return nullptr;
+	}
+
+	int32_t gridIndex = getGridIndex(x, y);
+	if (gridIndex < 0) {
 		return nullptr;
 	}
 
-	uint32_t key = hashCoord(x, y);
-	nodes.emplace_back(AStarNode{parent, x, y, g, f});
-	AStarNode* node = &nodes.back();
-	nodeMap[key] = node;
-	openSet.push(node);
+	AStarNode* node = &nodes[nodeCount];
+	*node = AStarNode{parent, x, y, g, f, openSetSize};
+	grid[gridIndex] = nodeCount++;
+
+	openSet[openSetSize++] = node;
+	siftUp(node->heapIndex);
 	return node;
 }
 
 AStarNode* AStarNodes::getBestNode()
 {
-	while (!openSet.empty()) {
-		AStarNode* node = openSet.top();
-		openSet.pop();
-		uint32_t key = hashCoord(node->x, node->y);
-		if (visited.find(key) == visited.end()) {
-			visited.insert(key);
-			return node;
-		}
+	if (openSetSize == 0) {
+		return nullptr;
 	}
-	return nullptr;
+
+	AStarNode* node = openSet[0];
+	node->heapIndex = INVALID_INDEX;
+	if (--openSetSize > 0) {
+		openSet[0] = openSet[openSetSize];
+		openSet[0]->heapIndex = 0;
+		siftDown(0);
+	}
+	return node;
 }
 
 AStarNode* AStarNodes::getNodeByPosition(uint16_t x, uint16_t y)
 {
-	auto it = nodeMap.find(hashCoord(x, y));
-	return (it != nodeMap.end()) ? it->second : nullptr;
+	int32_t gridIndex = getGridIndex(x, y);
+	if (gridIndex < 0 || grid[gridIndex] == INVALID_INDEX) {
+		return nullptr;
+	}
+	return &nodes[grid[gridIndex]];
+}
+
+void AStarNodes::updateNode(AStarNode* node, AStarNode* parent, uint16_t g, uint16_t f)
+{
+	node->parent = parent;
+	node->g = g;
+	node->f = f;
+
+	// closed nodes are not expanded again, same as before the open set was indexed
+	if (node->heapIndex != INVALID_INDEX) {
+		siftUp(node->heapIndex);
+	}
+}
+
+int32_t AStarNodes::getGridIndex(uint16_t x, uint16_t y) const
+{
+	int32_t dx = x - originX + pathSearchRadius;
+	int32_t dy = y - originY + pathSearchRadius;
+	if (dx < 0 || dx >= pathSearchWindowSize || dy < 0 || dy >= pathSearchWindowSize) {
+		return -1;
+	}
+	return dy * pathSearchWindowSize + dx;
+}
+
+void AStarNodes::siftUp(int16_t index)
+{
+	AStarNode* node = openSet[index];
+	while (index > 0) {
+		int16_t parentIndex = (index - 1) / 2;
+		AStarNode* parent = openSet[parentIndex];
+		if (parent->f <= node->f) {
+			break;
+		}
+
+		openSet[index] = parent;
+		parent->heapIndex = index;
+		index = parentIndex;
+	}
+
+	openSet[index] = node;
+	node->heapIndex = index;
+}
+
+void AStarNodes::siftDown(int16_t index)
+{
+	AStarNode* node = openSet[index];
+	while (true) {
+		int16_t childIndex = index * 2 + 1;
+		if (childIndex >= openSetSize) {
+			break;
+		}
+
+		if (childIndex + 1 < openSetSize && openSet[childIndex + 1]->f < openSet[childIndex]->f) {
+			++childIndex;
+		}
+
+		AStarNode* child = openSet[childIndex];
+		if (node->f <= child->f) {
+			break;
+		}
+
+		openSet[index] = child;
+		child->heapIndex = index;
+		index = childIndex;
+	}
+
+	openSet[index] = node;
+	node->heapIndex = index;
 }
 
 uint16_t AStarNodes::getMapWalkCost(AStarNode* node, const Position& neighborPos)
@@ -933,6 +1128,175 @@ uint16_t AStarNodes::getTileWalkCost(const Creature& creature, const Tile* tile)
 	return cost;
 }
 
+// TileDescriptionCache
+const TileDescriptionCache::Entry* TileDescriptionCache::get(const Tile* tile)
+{
+	if (auto it = entries.find(tile); it != entries.end()) {
+		hits.fetch_add(1, std::memory_order_relaxed);
+		return &it->second;
+	}
+
+	misses.fetch_add(1, std::memory_order_relaxed);
+
+	// the items a description can send with no creature on the tile, in the order it sends them
+	std::array<const Item*, MAX_ITEMS> items;
+	size_t count = 0;
+	size_t topItems = 0;
+
+	if (const Item* ground = tile->getGround()) {
+		items[count++] = ground;
+	}
+
+	if (const TileItemVector* itemList = tile->getItemList()) {
+		for (auto it = itemList->getBeginTopItem(), end = itemList->getEndTopItem(); it != end && count < MAX_ITEMS;
+		     ++it) {
+			items[count++] = *it;
+		}
+
+		topItems = count;
+		for (auto it = itemList->getBeginDownItem(), end = itemList->getEndDownItem(); it != end && count < MAX_ITEMS;
+		     ++it) {
+			items[count++] = *it;
+		}
+	} else {
+		topItems = count;
+	}
+
+	if (std::any_of(items.begin(), items.begin() + count, hasVolatileDescription)) {
+		return nullptr;
+	}
+
+	if (entries.size() >= MAX_ENTRIES) {
+		entries.clear();
+	}
+
+	// map descriptions are built on the dispatcher thread only
+	static NetworkMessage scratch;
+	scratch.reset();
+
+	Entry& entry = entries[tile];
+	entryCount.store(entries.size(), std::memory_order_relaxed);
+	for (size_t i = 0; i < count; ++i) {
+		scratch.addItem(items[i]);
+		entry.itemEnds[i] = scratch.getLength();
+	}
+
+	const uint8_t* body = scratch.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	entry.bytes.assign(body, body + scratch.getLength());
+	entry.topItems = static_cast<uint8_t>(topItems);
+	entry.items = static_cast<uint8_t>(count);
+	return &entry;
+}
+
+// SpectatorCache
+SpectatorCache::Entry* SpectatorCache::find(uint64_t key)
+{
+	if (slots.empty()) {
+		return nullptr;
+	}
+
+	const Slot& slot = slots[findSlot(key)];
+	if (slot.key == EMPTY_KEY) {
+		return nullptr;
+	}
+	return &entries[slot.index];
+}
+
+SpectatorCache::Entry& SpectatorCache::emplace(uint64_t key, QTreeLeafNode* leaf)
+{
+	if (Entry* entry = find(key)) {
+		return *entry;
+	}
+
+	if (entries.size() >= MAX_ENTRIES) {
+		clear();
+	}
+
+	// keep the load factor at or below 1/2
+	if ((entries.size() + 1) * 2 > slots.size()) {
+		rehash(std::max<size_t>(slots.size() * 2, 1024));
+	}
+
+	Slot& slot = slots[findSlot(key)];
+	slot.key = key;
+	slot.index = static_cast<uint32_t>(entries.size());
+
+	leaf->spectatorCacheKeys.push_back(key);
+	Entry& entry = entries.emplace_back(Entry{key, leaf, {}, {}});
+	entryCount.store(entries.size(), std::memory_order_relaxed);
+	return entry;
+}
+
+void SpectatorCache::erase(uint64_t key)
+{
+	if (slots.empty()) {
+		return;
+	}
+
+	size_t hole = findSlot(key);
+	if (slots[hole].key == EMPTY_KEY) {
+		return;
+	}
+
+	// move the last entry into the erased one to keep them dense
+	const uint32_t index = slots[hole].index;
+	if (index + 1 != entries.size()) {
+		entries[index] = std::move(entries.back());
+		slots[findSlot(entries[index].key)].index = index;
+	}
+	entries.pop_back();
+	entryCount.store(entries.size(), std::memory_order_relaxed);
+
+	// backward shift deletion, so lookups never need tombstones
+	const size_t mask = slots.size() - 1;
+	for (size_t next = (hole + 1) & mask; slots[next].key != EMPTY_KEY; next = (next + 1) & mask) {
+		const size_t home = getHomeSlot(slots[next].key);
+		// the element can fill the hole if its home slot does not lie cyclically in (hole, next]
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			slots[hole] = slots[next];
+			hole = next;
+		}
+	}
+	slots[hole] = Slot{};
+}
+
+void SpectatorCache::clear()
+{
+	for (Entry& entry : entries) {
+		entry.leaf->spectatorCacheKeys.clear();
+	}
+
+	entries.clear();
+	entryCount.store(0, std::memory_order_relaxed);
+	std::fill(slots.begin(), slots.end(), Slot{});
+}
+
+size_t SpectatorCache::getHomeSlot(uint64_t key) const
+{
+	// fibonacci hashing, x and y are packed in the upper bits so spread them over the whole table
+	return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (slots.size() - 1);
+}
+
+size_t SpectatorCache::findSlot(uint64_t key) const
+{
+	const size_t mask = slots.size() - 1;
+	size_t index = getHomeSlot(key);
+	while (slots[index].key != key && slots[index].key != EMPTY_KEY) {
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+void SpectatorCache::rehash(size_t capacity)
+{
+	slots.assign(capacity, Slot{});
+	for (uint32_t index = 0; index < entries.size(); ++index) {
+		Slot& slot = slots[findSlot(entries[index].key)];
+		slot.key = entries[index].key;
+		slot.index = index;
+	}
+}
+
 // Floor
 Floor::~Floor()
 {
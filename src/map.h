@@ -23,39 +23,164 @@ struct AStarNode
 	AStarNode* parent;
 	uint16_t x, y;
 	uint16_t g, f;
+	// position in the open set, closed nodes are not in it
+	int16_t heapIndex;
 };
 
 inline uint32_t hashCoord(uint16_t x, uint16_t y) { return (static_cast<uint32_t>(x) << 16) | y; }
 
+/**
+ * Node storage of a path search. Nodes live in a fixed arena and are looked up through a grid covering every tile
+ * a search can reach from its start, the open set is an indexed binary heap. Each thread keeps one instance that is
+ * reset for every search, so searching does not allocate.
+ */
 class AStarNodes
 {
 public:
-	AStarNodes(uint16_t x, uint16_t y);
+	static constexpr int16_t INVALID_INDEX = -1;
+
+	AStarNodes();
+
+	// non-copyable
+	AStarNodes(const AStarNodes&) = delete;
+	AStarNodes& operator=(const AStarNodes&) = delete;
+
+	static AStarNodes& getInstance();
+
+	void reset(uint16_t x, uint16_t y);
 
 	AStarNode* createNode(AStarNode* parent, uint16_t x, uint16_t y, uint16_t g, uint16_t f);
 	AStarNode* getBestNode();
 	AStarNode* getNodeByPosition(uint16_t x, uint16_t y);
+	void updateNode(AStarNode* node, AStarNode* parent, uint16_t g, uint16_t f);
 
 	static uint16_t getMapWalkCost(AStarNode* node, const Position& neighborPos);
 	static uint16_t getTileWalkCost(const Creature& creature, const Tile* tile);
 
 private:
+	int32_t getGridIndex(uint16_t x, uint16_t y) const;
+
+	void siftUp(int16_t index);
+	void siftDown(int16_t index);
+
 	std::vector<AStarNode> nodes;
-	std::unordered_map<uint32_t, AStarNode*> nodeMap;
-	std::unordered_set<uint32_t> visited;
+	std::vector<AStarNode*> openSet;
+	// arena index of the node on each tile of the search window
+	std::vector<int16_t> grid;
+	int16_t nodeCount = 0;
+	int16_t openSetSize = 0;
+	uint16_t originX = 0;
+	uint16_t originY = 0;
+};
+
+class QTreeLeafNode;
+
+/**
+ * Cached results of full viewport, multifloor spectator queries.
+ * Entries live in a dense vector, indexed by an open-addressing (linear probing) hash keyed by the packed center
+ * position. Every entry is also registered in the quadtree leaf holding its center, so a creature appearing or
+ * disappearing only drops the entries that can actually see it.
+ */
+class SpectatorCache
+{
+public:
+	struct Entry
+	{
+		uint64_t key;
+		QTreeLeafNode* leaf;
+		SpectatorVec spectators;
+		SpectatorVec players;
+		bool hasSpectators = false;
+		bool hasPlayers = false;
+	};
 
-	struct NodeCompare
+	static constexpr uint64_t packPosition(const Position& pos)
 	{
-		bool operator()(AStarNode* a, AStarNode* b) const
-		{
-			return a->f > b->f; // Min-heap based on f score
-		}
+		return (static_cast<uint64_t>(pos.x) << 24) | (static_cast<uint64_t>(pos.y) << 8) | pos.z;
+	}
+	static constexpr Position unpackPosition(uint64_t key)
+	{
+		return Position(static_cast<uint16_t>(key >> 24), static_cast<uint16_t>(key >> 8), static_cast<uint8_t>(key));
+	}
+
+	Entry* find(uint64_t key);
+	Entry& emplace(uint64_t key, QTreeLeafNode* leaf);
+	void erase(uint64_t key);
+	void clear();
+
+	size_t size() const { return entryCount.load(std::memory_order_relaxed); }
+
+	// only the dispatcher thread changes these, /metrics reads them from the http thread
+	std::atomic<uint64_t> hits{0};
+	std::atomic<uint64_t> misses{0};
+
+private:
+	static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+	// past this many centers the whole cache is dropped instead of growing further
+	static constexpr size_t MAX_ENTRIES = 1 << 15;
+
+	struct Slot
+	{
+		uint64_t key = EMPTY_KEY;
+		uint32_t index = 0;
 	};
 
-	std::priority_queue<AStarNode*, std::vector<AStarNode*>, NodeCompare> openSet;
+	size_t getHomeSlot(uint64_t key) const;
+	size_t findSlot(uint64_t key) const;
+	void rehash(size_t capacity);
+
+	std::vector<Slot> slots;
+	std::vector<Entry> entries;
+	std::atomic<size_t> entryCount{0};
 };
 
-using SpectatorCache = std::map<Position, SpectatorVec>;
+/**
+ * The items of tiles serialized the way a map description sends them, shared by every player.
+ * Creatures are left out since they depend on who is looking. A tile drops its entry whenever an item on it is added,
+ * changed or removed, so logins, teleports and floor changes only serialize the tiles that changed since.
+ */
+class TileDescriptionCache
+{
+public:
+	// the most items a tile description sends, MAX_STACKPOS
+	static constexpr size_t MAX_ITEMS = 10;
+
+	struct Entry
+	{
+		// ground and top items, followed by the down items
+		std::vector<uint8_t> bytes;
+		// where every item ends in bytes
+		std::array<uint16_t, MAX_ITEMS> itemEnds;
+		uint8_t topItems = 0;
+		uint8_t items = 0;
+	};
+
+	// past this many tiles the whole cache is dropped instead of growing further
+	static constexpr size_t MAX_ENTRIES = 1 << 18;
+
+	/**
+	 * @brief The serialized items of a tile, serialized into the cache if they are not in it yet.
+	 *
+	 * nullptr for a tile holding an item whose bytes change without the tile being told, such as a decaying duration or
+	 * the ammo in a quiver, those tiles are serialized on every description.
+	 */
+	const Entry* get(const Tile* tile);
+	void erase(const Tile* tile)
+	{
+		entries.erase(tile);
+		entryCount.store(entries.size(), std::memory_order_relaxed);
+	}
+
+	size_t size() const { return entryCount.load(std::memory_order_relaxed); }
+
+	// only the dispatcher thread changes these, /metrics reads them from the http thread
+	std::atomic<uint64_t> hits{0};
+	std::atomic<uint64_t> misses{0};
+
+private:
+	std::unordered_map<const Tile*, Entry> entries;
+	std::atomic<size_t> entryCount{0};
+};
 
 static constexpr int32_t FLOOR_BITS = 3;
 static constexpr int32_t FLOOR_SIZE = (1 << FLOOR_BITS);
@@ -74,7 +199,6 @@ struct Floor
 };
 
 class FrozenPathingConditionCall;
-class QTreeLeafNode;
 
 class QTreeNode
 {
@@ -143,9 +267,11 @@ private:
 	Floor* array[MAP_MAX_LAYERS] = {};
 	CreatureVector creature_list;
 	CreatureVector player_list;
+	std::vector<uint64_t> spectatorCacheKeys;
 
 	friend class Map;
 	friend class QTreeNode;
+	friend class SpectatorCache;
 };
 
 /**
@@ -212,8 +338,54 @@ public:
 	                   bool onlyPlayers = false, int32_t minRangeX = 0, int32_t maxRangeX = 0, int32_t minRangeY = 0,
 	                   int32_t maxRangeY = 0);
 
-	void clearSpectatorCache();
-	void clearPlayersSpectatorCache();
+	/**
+	 * Drops the cached spectators of every center that can see the given position.
+	 * \param pos The position where a creature appeared or disappeared
+	 * \param isPlayer Whether the creature is a player, only then players-only results are affected
+	 */
+	void clearSpectatorCache(const Position& pos, bool isPlayer);
+
+	/**
+	 * Calls f with the tile at every position of a width x height area of floor z, column by column, or with nullptr
+	 * where there is none. Steps from leaf to leaf instead of walking the quadtree for every position.
+	 */
+	template <typename F>
+	void forEachTile(int32_t x, int32_t y, uint8_t z, int32_t width, int32_t height, F&& f) const
+	{
+		for (int32_t nx = 0; nx < width; ++nx) {
+			const uint16_t tileX = static_cast<uint16_t>(x + nx);
+			const QTreeLeafNode* leaf = nullptr;
+			const Floor* floor = nullptr;
+			int32_t leafY = -1;
+
+			for (int32_t ny = 0; ny < height; ++ny) {
+				const uint16_t tileY = static_cast<uint16_t>(y + ny);
+				if ((tileY & ~FLOOR_MASK) != leafY) {
+					if (leaf && leafY + FLOOR_SIZE == (tileY & ~FLOOR_MASK)) {
+						leaf = leaf->leafS;
+					} else {
+						leaf = QTreeNode::getLeafStatic<const QTreeLeafNode*, const QTreeNode*>(&root, tileX, tileY);
+					}
+					leafY = tileY & ~FLOOR_MASK;
+					floor = leaf && z < MAP_MAX_LAYERS ? leaf->getFloor(z) : nullptr;
+				}
+
+				f(floor ? floor->tiles[tileX & FLOOR_MASK][tileY & FLOOR_MASK] : nullptr);
+			}
+		}
+	}
+
+	/**
+	 * Drops the cached description of the items on a tile.
+	 * \param tile The tile an item was added to, changed on or removed from
+	 */
+	void clearTileDescription(const Tile* tile) { tileDescriptionCache.erase(tile); }
+
+	TileDescriptionCache& getTileDescriptionCache() { return tileDescriptionCache; }
+
+	uint64_t getSpectatorCacheHits() const { return spectatorCache.hits; }
+	uint64_t getSpectatorCacheMisses() const { return spectatorCache.misses; }
+	size_t getSpectatorCacheSize() const { return spectatorCache.size(); }
 
 	/**
 	 * Checks if you can throw an object to that position
@@ -265,7 +437,7 @@ public:
 
 private:
 	SpectatorCache spectatorCache;
-	SpectatorCache playersSpectatorCache;
+	TileDescriptionCache tileDescriptionCache;
 
 	QTreeNode root;
 
@@ -611,6 +611,20 @@ void Monster::goToFollowCreature()
 	onFollowCreatureComplete();
 }
 
+bool Monster::willSearchFollowPath() const
+{
+	if (!followCreature) {
+		return false;
+	}
+
+	if (isSummon()) {
+		return true;
+	}
+
+	// fleeing and closing in take single steps, the path is only searched if the target is out of reach
+	return !isFleeing() && !canStepTowards(followCreature->getPosition());
+}
+
 void Monster::onFollowCreatureComplete()
 {
 	auto it = std::find(targetList.begin(), targetList.end(), followCreature);
@@ -1358,6 +1372,13 @@ bool Monster::getDanceStep(const Position& creaturePos, Direction& direction, bo
 	return false;
 }
 
+bool Monster::canStepTowards(const Position& targetPos) const
+{
+	const Position& creaturePos = getPosition();
+	const int32_t distance = std::max(creaturePos.getDistanceX(targetPos), creaturePos.getDistanceY(targetPos));
+	return distance <= mType->info.targetDistance && g_game.isSightClear(creaturePos, targetPos, true);
+}
+
 bool Monster::getDistanceStep(const Position& targetPos, Direction& direction, bool flee /* = false */)
 {
 	const Position& creaturePos = getPosition();
@@ -1367,7 +1388,7 @@ bool Monster::getDistanceStep(const Position& targetPos, Direction& direction, b
 
 	int32_t distance = std::max(dx, dy);
 
-	if (!flee && (distance > mType->info.targetDistance || !g_game.isSightClear(creaturePos, targetPos, true))) {
+	if (!flee && !canStepTowards(targetPos)) {
 		return false; // let the A* calculate it
 	} else if (!flee && distance == mType->info.targetDistance) {
 		return true; // we don't really care here, since it's what we wanted to reach (a dance-step will take of dancing
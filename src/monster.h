@@ -99,6 +99,7 @@ public:
 	void onWalkComplete() override;
 	bool getNextStep(Direction& direction, uint32_t& flags) override;
 	void goToFollowCreature() override;
+	bool willSearchFollowPath() const override;
 	void onFollowCreatureComplete();
 
 	void onThink(uint32_t interval) override;
@@ -124,6 +125,8 @@ public:
 	}
 
 	bool getDistanceStep(const Position& targetPos, Direction& direction, bool flee = false);
+	// whether getDistanceStep can close in on the target, otherwise the A* has to find the way
+	bool canStepTowards(const Position& targetPos) const;
 	bool isTargetNearby() const { return stepDuration >= 1; }
 	bool isIgnoringFieldDamage() const { return ignoreFieldDamage; }
 
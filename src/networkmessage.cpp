@@ -10,7 +10,20 @@
 
 #include <boost/locale.hpp>
 
-std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/)
+std::string NetworkMessageBase::getString(uint16_t stringLen /* = 0*/)
+{
+	auto latin1Str = getStringView(stringLen);
+
+	// ISO-8859-1 and UTF-8 share the ASCII range, most of what clients send needs no conversion
+	if (std::all_of(latin1Str.begin(), latin1Str.end(), [](char c) { return static_cast<uint8_t>(c) < 0x80; })) {
+		return std::string{latin1Str};
+	}
+
+	return boost::locale::conv::to_utf<char>(latin1Str.data(), latin1Str.data() + latin1Str.size(), "ISO-8859-1",
+	                                         boost::locale::conv::skip);
+}
+
+std::string_view NetworkMessageBase::getStringView(uint16_t stringLen /* = 0*/)
 {
 	if (stringLen == 0) {
 		stringLen = get<uint16_t>();
@@ -20,15 +33,12 @@ std::string NetworkMessage::getString(uint16_t stringLen /* = 0*/)
 		return {};
 	}
 
-	auto it = buffer.data() + info.position;
+	auto it = buffer + info.position;
 	info.position += stringLen;
-
-	std::string_view latin1Str{reinterpret_cast<char*>(it), stringLen};
-	return boost::locale::conv::to_utf<char>(latin1Str.data(), latin1Str.data() + latin1Str.size(), "ISO-8859-1",
-	                                         boost::locale::conv::skip);
+	return {reinterpret_cast<char*>(it), stringLen};
 }
 
-Position NetworkMessage::getPosition()
+Position NetworkMessageBase::getPosition()
 {
 	Position pos;
 	pos.x = get<uint16_t>();
@@ -37,7 +47,7 @@ Position NetworkMessage::getPosition()
 	return pos;
 }
 
-void NetworkMessage::addString(std::string_view value)
+void NetworkMessageBase::addString(std::string_view value)
 {
 	std::string latin1Str = boost::locale::conv::from_utf<char>(value.data(), value.data() + value.size(), "ISO-8859-1",
 	                                                            boost::locale::conv::skip);
@@ -47,47 +57,47 @@ void NetworkMessage::addString(std::string_view value)
 	}
 
 	add<uint16_t>(stringLen);
-	std::memcpy(buffer.data() + info.position, latin1Str.data(), stringLen);
+	std::memcpy(buffer + info.position, latin1Str.data(), stringLen);
 	info.position += stringLen;
 	info.length += stringLen;
 }
 
-void NetworkMessage::addDouble(double value, uint8_t precision /* = 2*/)
+void NetworkMessageBase::addDouble(double value, uint8_t precision /* = 2*/)
 {
 	addByte(precision);
 	add<uint32_t>(static_cast<uint32_t>((value * std::pow(static_cast<float>(10), precision)) +
 	                                    std::numeric_limits<int32_t>::max()));
 }
 
-void NetworkMessage::addBytes(const char* bytes, size_t size)
+void NetworkMessageBase::addBytes(const char* bytes, size_t size)
 {
 	if (!canAdd(size) || size > 8192) {
 		return;
 	}
 
-	std::memcpy(buffer.data() + info.position, bytes, size);
+	std::memcpy(buffer + info.position, bytes, size);
 	info.position += size;
 	info.length += size;
 }
 
-void NetworkMessage::addPaddingBytes(size_t n)
+void NetworkMessageBase::addPaddingBytes(size_t n)
 {
 	if (!canAdd(n)) {
 		return;
 	}
 
-	std::fill_n(buffer.data() + info.position, n, 0x33);
+	std::fill_n(buffer + info.position, n, 0x33);
 	info.length += n;
 }
 
-void NetworkMessage::addPosition(const Position& pos)
+void NetworkMessageBase::addPosition(const Position& pos)
 {
 	add<uint16_t>(pos.x);
 	add<uint16_t>(pos.y);
 	addByte(pos.z);
 }
 
-void NetworkMessage::addItem(uint16_t id, uint8_t count)
+void NetworkMessageBase::addItem(uint16_t id, uint8_t count)
 {
 	const ItemType& it = Item::items[id];
 
@@ -118,7 +128,7 @@ void NetworkMessage::addItem(uint16_t id, uint8_t count)
 	}
 }
 
-void NetworkMessage::addItem(const Item* item)
+void NetworkMessageBase::addItem(const Item* item)
 {
 	const ItemType& it = Item::items[item->getID()];
 
@@ -190,4 +200,4 @@ void NetworkMessage::addItem(const Item* item)
 	}
 }
 
-void NetworkMessage::addItemId(uint16_t itemId) { add<uint16_t>(Item::items[itemId].clientId); }
+void NetworkMessageBase::addItemId(uint16_t itemId) { add<uint16_t>(Item::items[itemId].clientId); }
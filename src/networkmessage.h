@@ -12,7 +12,13 @@ struct Position;
 class NetworkMessage;
 using NetworkMessage_ptr = std::unique_ptr<NetworkMessage>;
 
-class NetworkMessage
+/**
+ * @brief Reads and writes protocol messages in a buffer owned by the derived class.
+ *
+ * NetworkMessage keeps the largest message a client can take inline, output messages take their buffer from a pool of
+ * size classes and grow it when a write does not fit.
+ */
+class NetworkMessageBase
 {
 public:
 	using MsgSize_t = uint16_t;
@@ -42,8 +48,6 @@ public:
 		MAX_PROTOCOL_BODY_LENGTH = MAX_BODY_LENGTH - 10
 	};
 
-	NetworkMessage() = default;
-
 	void reset() { info = {}; }
 
 	// simply read functions for incoming message
@@ -68,12 +72,14 @@ public:
 		}
 
 		T value;
-		std::memcpy(&value, buffer.data() + info.position, sizeof(T));
+		std::memcpy(&value, buffer + info.position, sizeof(T));
 		info.position += sizeof(T);
 		return value;
 	}
 
 	std::string getString(uint16_t stringLen = 0);
+	// the string as the client sent it, in ISO-8859-1, valid as long as the message is
+	std::string_view getStringView(uint16_t stringLen = 0);
 	Position getPosition();
 
 	// skips count unknown/unused bytes in an incoming message
@@ -97,7 +103,7 @@ public:
 			return;
 		}
 
-		std::memcpy(buffer.data() + info.position, &value, sizeof(T));
+		std::memcpy(buffer + info.position, &value, sizeof(T));
 		info.position += sizeof(T);
 		info.length += sizeof(T);
 	}
@@ -127,7 +133,7 @@ public:
 
 	bool setBufferPosition(MsgSize_t pos)
 	{
-		if (pos < NETWORKMESSAGE_MAXSIZE - INITIAL_BUFFER_POSITION) {
+		if (pos < capacity - INITIAL_BUFFER_POSITION) {
 			info.position = pos + INITIAL_BUFFER_POSITION;
 			return true;
 		}
@@ -138,11 +144,11 @@ public:
 
 	bool isOverrun() const { return info.overrun; }
 
-	uint8_t* getBuffer() { return &buffer[0]; }
+	uint8_t* getBuffer() { return buffer; }
 
-	const uint8_t* getBuffer() const { return &buffer[0]; }
+	const uint8_t* getBuffer() const { return buffer; }
 
-	uint8_t* getRemainingBuffer() { return &buffer[0] + info.position; }
+	uint8_t* getRemainingBuffer() { return buffer + info.position; }
 
 	uint8_t* getBodyBuffer()
 	{
@@ -158,15 +164,30 @@ protected:
 		bool overrun = false;
 	};
 
+	NetworkMessageBase(uint8_t* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {}
+	~NetworkMessageBase() = default;
+
+	// non-copyable, the buffer belongs to the derived class
+	NetworkMessageBase(const NetworkMessageBase&) = delete;
+	NetworkMessageBase& operator=(const NetworkMessageBase&) = delete;
+
+	// called when a write does not fit, moves the message to a buffer with room for size more bytes
+	virtual bool grow(size_t) { return false; }
+
+	// the room after the body that the crypto headers and the XTEA padding need
+	static constexpr size_t BODY_RESERVE = NETWORKMESSAGE_MAXSIZE - MAX_BODY_LENGTH;
+
 	NetworkMessageInfo info;
-	std::array<uint8_t, NETWORKMESSAGE_MAXSIZE> buffer;
+	uint8_t* buffer;
+	size_t capacity;
 
-private:
-	bool canAdd(size_t size) const { return (size + info.position) < MAX_BODY_LENGTH; }
+	bool canAdd(size_t size) { return (size + info.position) < capacity - BODY_RESERVE || grow(size); }
 
+private:
 	bool canRead(int32_t size)
 	{
-		if ((info.position + size) > (info.length + 8) || size >= (NETWORKMESSAGE_MAXSIZE - info.position)) {
+		if ((info.position + size) > (info.length + 8) ||
+		    size >= static_cast<int32_t>(capacity) - static_cast<int32_t>(info.position)) {
 			info.overrun = true;
 			return false;
 		}
@@ -174,4 +195,27 @@ private:
 	}
 };
 
+class NetworkMessage final : public NetworkMessageBase
+{
+public:
+	NetworkMessage() : NetworkMessageBase(nullptr, NETWORKMESSAGE_MAXSIZE) { buffer = storage.data(); }
+
+	NetworkMessage(const NetworkMessage& other) : NetworkMessageBase(nullptr, NETWORKMESSAGE_MAXSIZE)
+	{
+		buffer = storage.data();
+		info = other.info;
+		storage = other.storage;
+	}
+
+	NetworkMessage& operator=(const NetworkMessage& other)
+	{
+		info = other.info;
+		storage = other.storage;
+		return *this;
+	}
+
+private:
+	std::array<uint8_t, NETWORKMESSAGE_MAXSIZE> storage;
+};
+
 #endif // FS_NETWORKMESSAGE_H
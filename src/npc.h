@@ -158,6 +158,8 @@ public:
 
 	void goToFollowCreature() override;
 
+	void onThink(uint32_t interval) override;
+
 private:
 	explicit Npc(const std::string& name);
 
@@ -167,7 +169,6 @@ private:
 	                    const Position& oldPos, bool teleport) override;
 
 	void onCreatureSay(Creature* creature, SpeakClasses type, const std::string& text) override;
-	void onThink(uint32_t interval) override;
 	std::string getDescription(int32_t lookDistance) const override;
 
 	bool isImmune(CombatType_t) const override { return !attackable; }
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
 #include <bitset>
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
@@ -18,6 +19,7 @@
 #include <boost/lockfree/stack.hpp>
 #include <boost/variant.hpp>
 #include <cassert>
+#include <charconv>
 #include <concepts>
 #include <condition_variable>
 #include <cstdint>
@@ -39,6 +41,7 @@
 #include <queue>
 #include <random>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
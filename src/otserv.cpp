@@ -13,6 +13,8 @@
 #include "iomarket.h"
 #include "monsters.h"
 #include "outfit.h"
+#include "playersaver.h"
+#include "profiler.h"
 #include "protocollogin.h"
 #include "protocolold.h"
 #include "protocolstatus.h"
@@ -29,6 +31,7 @@
 #endif
 
 DatabaseTasks g_databaseTasks;
+PlayerSaver g_playerSaver;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
 
@@ -91,6 +94,8 @@ void mainLoader(ServiceManager* services)
 		return;
 	}
 
+	tfs::profiler::setEnabled(getBoolean(ConfigManager::PROFILER));
+
 #ifdef _WIN32
 	const std::string& defaultPriority = getString(ConfigManager::DEFAULT_PRIORITY);
 	if (caseInsensitiveEqual(defaultPriority, "high")) {
@@ -128,7 +133,15 @@ void mainLoader(ServiceManager* services)
 		    "The database you have specified in config.lua is empty, please import the schema.sql to your database.");
 		return;
 	}
-	g_databaseTasks.start();
+	if (!g_databaseTasks.start(std::max(getNumber(ConfigManager::DATABASE_WORKERS), 1))) {
+		startupErrorMessage("Failed to connect the database workers.");
+		return;
+	}
+
+	if (!g_playerSaver.start()) {
+		startupErrorMessage("Failed to connect the player saver to the database.");
+		return;
+	}
 
 	DatabaseManager::updateDatabase();
 
@@ -295,11 +308,13 @@ void startServer()
 		std::cout << ">> No services running. The server is NOT online." << std::endl;
 		g_scheduler.shutdown();
 		g_databaseTasks.shutdown();
+		g_playerSaver.shutdown();
 		g_dispatcher.shutdown();
 	}
 
 	g_scheduler.join();
 	g_databaseTasks.join();
+	g_playerSaver.join();
 	g_dispatcher.join();
 }
 
@@ -7,43 +7,199 @@
 
 #include "lockfree.h"
 #include "protocol.h"
-#include "scheduler.h"
-
-extern Scheduler g_scheduler;
 
 namespace {
 
+using tfs::net::BUFFER_CLASSES;
+using tfs::net::BufferClass;
+
 const uint16_t OUTPUTMESSAGE_FREE_LIST_CAPACITY = 2048;
-const std::chrono::milliseconds OUTPUTMESSAGE_AUTOSEND_DELAY{10};
 
-// NOTE: A vector is used here because this container is mostly read and relatively rarely modified (only when a
-// client connects/disconnects)
-std::vector<Protocol_ptr> bufferedProtocols;
+constexpr std::array<size_t, BUFFER_CLASSES> BUFFER_SIZES = {1024, 8192, NETWORKMESSAGE_MAXSIZE};
+
+// Buffers are mostly allocated by the dispatcher and freed by the network threads after the write, so every thread
+// keeps a magazine of buffers and hands whole magazines to the shared pool, one lock per MAGAZINE_SIZE buffers.
+constexpr size_t MAGAZINE_SIZE = 32;
+// full magazines the shared pool keeps per class, at most about 4 MB, 8 MB and 6 MB of idle buffers
+constexpr std::array<size_t, BUFFER_CLASSES> POOL_MAGAZINES = {128, 32, 8};
+
+struct Magazine
+{
+	std::array<uint8_t*, MAGAZINE_SIZE> buffers;
+	size_t count = 0;
+};
+
+struct AtomicStats
+{
+	std::atomic<uint64_t> allocations{0};
+	std::atomic<uint64_t> refills{0};
+	std::atomic<uint64_t> misses{0};
+	std::atomic<uint64_t> grows{0};
+	std::atomic<uint64_t> resident{0};
+};
+
+struct Pool
+{
+	std::mutex mutex;
+	std::vector<Magazine> magazines;
+	AtomicStats stats;
+};
 
-void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols);
+std::array<Pool, BUFFER_CLASSES> pools;
 
-void scheduleSendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
+uint8_t* allocateBuffer(size_t index)
 {
-	g_scheduler.addEvent(
-	    createSchedulerTask(OUTPUTMESSAGE_AUTOSEND_DELAY.count(), [&]() { sendAll(bufferedProtocols); }));
+	pools[index].stats.resident.fetch_add(1, std::memory_order_relaxed);
+	return static_cast<uint8_t*>(operator new(BUFFER_SIZES[index]));
 }
 
-void sendAll(const std::vector<Protocol_ptr>& bufferedProtocols)
+void freeBuffer(size_t index, uint8_t* buffer)
 {
-	// dispatcher thread
-	for (auto& protocol : bufferedProtocols) {
-		if (auto& msg = protocol->getCurrentBuffer()) {
-			protocol->send(std::move(msg));
+	pools[index].stats.resident.fetch_sub(1, std::memory_order_relaxed);
+	operator delete(buffer);
+}
+
+// buffers freed after the cache of their thread is gone go straight back to the heap
+thread_local bool threadCacheDestroyed = false;
+
+class ThreadCache
+{
+public:
+	ThreadCache() = default;
+
+	~ThreadCache()
+	{
+		threadCacheDestroyed = true;
+		for (size_t i = 0; i < BUFFER_CLASSES; ++i) {
+			Magazine& magazine = magazines[i];
+			if (magazine.count != 0 && !giveMagazine(i, magazine)) {
+				while (magazine.count != 0) {
+					freeBuffer(i, magazine.buffers[--magazine.count]);
+				}
+			}
+		}
+	}
+
+	// non-copyable
+	ThreadCache(const ThreadCache&) = delete;
+	ThreadCache& operator=(const ThreadCache&) = delete;
+
+	uint8_t* acquire(size_t index)
+	{
+		Magazine& magazine = magazines[index];
+		if (magazine.count == 0 && !takeMagazine(index, magazine)) {
+			pools[index].stats.misses.fetch_add(1, std::memory_order_relaxed);
+			return allocateBuffer(index);
 		}
+		return magazine.buffers[--magazine.count];
 	}
 
-	if (!bufferedProtocols.empty()) {
-		scheduleSendAll(bufferedProtocols);
+	void release(size_t index, uint8_t* buffer)
+	{
+		Magazine& magazine = magazines[index];
+		if (magazine.count == MAGAZINE_SIZE && !giveMagazine(index, magazine)) {
+			freeBuffer(index, buffer);
+			return;
+		}
+		magazine.buffers[magazine.count++] = buffer;
 	}
+
+private:
+	static bool takeMagazine(size_t index, Magazine& magazine)
+	{
+		Pool& pool = pools[index];
+		std::lock_guard<std::mutex> lockClass(pool.mutex);
+		if (pool.magazines.empty()) {
+			return false;
+		}
+
+		magazine = pool.magazines.back();
+		pool.magazines.pop_back();
+		pool.stats.refills.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	static bool giveMagazine(size_t index, Magazine& magazine)
+	{
+		Pool& pool = pools[index];
+		std::lock_guard<std::mutex> lockClass(pool.mutex);
+		if (pool.magazines.size() >= POOL_MAGAZINES[index]) {
+			return false;
+		}
+
+		pool.magazines.push_back(magazine);
+		magazine.count = 0;
+		return true;
+	}
+
+	std::array<Magazine, BUFFER_CLASSES> magazines;
+};
+
+ThreadCache& getThreadCache()
+{
+	static thread_local ThreadCache threadCache;
+	return threadCache;
+}
+
+uint8_t* acquireBuffer(BufferClass bufferClass)
+{
+	const size_t index = tfs::to_underlying(bufferClass);
+	pools[index].stats.allocations.fetch_add(1, std::memory_order_relaxed);
+	if (threadCacheDestroyed) {
+		pools[index].stats.misses.fetch_add(1, std::memory_order_relaxed);
+		return allocateBuffer(index);
+	}
+	return getThreadCache().acquire(index);
 }
 
+void releaseBuffer(BufferClass bufferClass, uint8_t* buffer)
+{
+	const size_t index = tfs::to_underlying(bufferClass);
+	if (threadCacheDestroyed) {
+		freeBuffer(index, buffer);
+		return;
+	}
+	getThreadCache().release(index, buffer);
+}
+
+// Protocols are added when their output buffer gets its first message, so a flush only visits the ones with something
+// to send. The vectors are swapped on every flush and keep their capacity.
+std::vector<Protocol_ptr> pendingProtocols;
+std::vector<Protocol_ptr> flushingProtocols;
+
 } // namespace
 
+OutputMessage::OutputMessage() :
+    NetworkMessageBase(acquireBuffer(tfs::net::BufferClass::SMALL), BUFFER_SIZES[0])
+{}
+
+OutputMessage::~OutputMessage() { releaseBuffer(bufferClass, buffer); }
+
+bool OutputMessage::grow(size_t size)
+{
+	// canAdd wants the body to end before the room kept for the headers and the padding
+	const size_t needed = info.position + size + BODY_RESERVE + 1;
+	for (size_t i = tfs::to_underlying(bufferClass) + 1; i < BUFFER_CLASSES; ++i) {
+		if (BUFFER_SIZES[i] < needed) {
+			continue;
+		}
+
+		pools[tfs::to_underlying(bufferClass)].stats.grows.fetch_add(1, std::memory_order_relaxed);
+
+		const auto newClass = static_cast<BufferClass>(i);
+		uint8_t* newBuffer = acquireBuffer(newClass);
+		// the room for the headers in front is part of the copy
+		std::memcpy(newBuffer, buffer, info.position);
+		releaseBuffer(bufferClass, buffer);
+
+		buffer = newBuffer;
+		capacity = BUFFER_SIZES[i];
+		bufferClass = newClass;
+		return true;
+	}
+	return false;
+}
+
 OutputMessage_ptr tfs::net::make_output_message()
 {
 	// LockfreePoolingAllocator<void,...> will leave (void* allocate) ill-formed because of sizeof(T), so this
@@ -51,21 +207,39 @@ OutputMessage_ptr tfs::net::make_output_message()
 	return std::allocate_shared<OutputMessage>(LockfreePoolingAllocator<void, OUTPUTMESSAGE_FREE_LIST_CAPACITY>());
 }
 
-void tfs::net::insert_protocol_to_autosend(const Protocol_ptr& protocol)
+void tfs::net::add_pending_output(const Protocol_ptr& protocol)
 {
 	// dispatcher thread
-	if (bufferedProtocols.empty()) {
-		scheduleSendAll(bufferedProtocols);
-	}
-	bufferedProtocols.emplace_back(protocol);
+	pendingProtocols.emplace_back(protocol);
 }
 
-void tfs::net::remove_protocol_from_autosend(const Protocol_ptr& protocol)
+void tfs::net::flush_pending_output()
 {
 	// dispatcher thread
-	auto it = std::find(bufferedProtocols.begin(), bufferedProtocols.end(), protocol);
-	if (it != bufferedProtocols.end()) {
-		std::swap(*it, bufferedProtocols.back());
-		bufferedProtocols.pop_back();
+	if (pendingProtocols.empty()) {
+		return;
 	}
+
+	pendingProtocols.swap(flushingProtocols);
+	for (auto& protocol : flushingProtocols) {
+		// already sent if it went over the flush threshold, or dropped when the protocol was released
+		if (auto& msg = protocol->getCurrentBuffer()) {
+			protocol->send(std::move(msg));
+		}
+	}
+	flushingProtocols.clear();
+}
+
+tfs::net::BufferPoolStats tfs::net::get_buffer_pool_stats(BufferClass bufferClass)
+{
+	const size_t index = tfs::to_underlying(bufferClass);
+	const AtomicStats& stats = pools[index].stats;
+	return {
+	    .bufferSize = BUFFER_SIZES[index],
+	    .allocations = stats.allocations.load(std::memory_order_relaxed),
+	    .refills = stats.refills.load(std::memory_order_relaxed),
+	    .misses = stats.misses.load(std::memory_order_relaxed),
+	    .grows = stats.grows.load(std::memory_order_relaxed),
+	    .resident = stats.resident.load(std::memory_order_relaxed),
+	};
 }
@@ -8,23 +8,56 @@
 #include "networkmessage.h"
 #include "tools.h"
 
-class OutputMessage : public NetworkMessage
+namespace tfs::net {
+
+/**
+ * @brief Output messages start in a small buffer and move to the next class when a write does not fit.
+ */
+enum class BufferClass : uint8_t
+{
+	SMALL,
+	MEDIUM,
+	FULL,
+};
+
+constexpr size_t BUFFER_CLASSES = 3;
+
+struct BufferPoolStats
+{
+	size_t bufferSize = 0;
+	uint64_t allocations = 0;
+	// the cache of the allocating thread was empty and took a batch of buffers from the shared pool
+	uint64_t refills = 0;
+	// the shared pool was empty as well and the buffer came from the heap
+	uint64_t misses = 0;
+	// messages that outgrew a buffer of this class
+	uint64_t grows = 0;
+	// buffers taken from the heap and not given back, whether in use or cached
+	uint64_t resident = 0;
+};
+
+BufferPoolStats get_buffer_pool_stats(BufferClass bufferClass);
+
+} // namespace tfs::net
+
+class OutputMessage final : public NetworkMessageBase
 {
 public:
-	OutputMessage() = default;
+	OutputMessage();
+	~OutputMessage();
 
 	// non-copyable
 	OutputMessage(const OutputMessage&) = delete;
 	OutputMessage& operator=(const OutputMessage&) = delete;
 
-	uint8_t* getOutputBuffer() { return &buffer[outputBufferStart]; }
+	uint8_t* getOutputBuffer() { return buffer + outputBufferStart; }
 
 	void writeMessageLength() { add_header(info.length); }
 
 	void addCryptoHeader(checksumMode_t mode)
 	{
 		if (mode == CHECKSUM_ADLER) {
-			add_header(adlerChecksum(&buffer[outputBufferStart], info.length));
+			add_header(adlerChecksum(buffer + outputBufferStart, info.length));
 		} else if (mode == CHECKSUM_SEQUENCE) {
 			add_header(getSequenceId());
 		}
@@ -32,45 +65,54 @@ public:
 		writeMessageLength();
 	}
 
-	void append(const NetworkMessage& msg)
-	{
-		auto msgLen = msg.getLength();
-		std::memcpy(buffer.data() + info.position, msg.getBuffer() + 8, msgLen);
-		info.length += msgLen;
-		info.position += msgLen;
-	}
+	void append(const NetworkMessage& msg) { append(msg.getBuffer() + 8, msg.getLength()); }
+
+	void append(const OutputMessage_ptr& msg) { append(msg->getBuffer() + 8, msg->getLength()); }
+
+	void setSequenceId(uint32_t sequence) { sequenceId = sequence; }
+	uint32_t getSequenceId() const { return sequenceId; }
+
+	// the time it waits for the socket write is counted from here
+	std::chrono::steady_clock::time_point getCreationTime() const { return creationTime; }
 
-	void append(const OutputMessage_ptr& msg)
+private:
+	void append(const uint8_t* data, MsgSize_t msgLen)
 	{
-		auto msgLen = msg->getLength();
-		std::memcpy(buffer.data() + info.position, msg->getBuffer() + 8, msgLen);
+		if (!canAdd(msgLen)) {
+			return;
+		}
+
+		std::memcpy(buffer + info.position, data, msgLen);
 		info.length += msgLen;
 		info.position += msgLen;
 	}
 
-	void setSequenceId(uint32_t sequence) { sequenceId = sequence; }
-	uint32_t getSequenceId() const { return sequenceId; }
+	bool grow(size_t size) override;
 
-private:
 	template <typename T>
 	void add_header(T add)
 	{
 		assert(outputBufferStart >= sizeof(T));
 		outputBufferStart -= sizeof(T);
-		std::memcpy(buffer.data() + outputBufferStart, &add, sizeof(T));
+		std::memcpy(buffer + outputBufferStart, &add, sizeof(T));
 		// added header size to the message size
 		info.length += sizeof(T);
 	}
 
+	tfs::net::BufferClass bufferClass = tfs::net::BufferClass::SMALL;
 	MsgSize_t outputBufferStart = INITIAL_BUFFER_POSITION;
 	uint32_t sequenceId;
+	const std::chrono::steady_clock::time_point creationTime = std::chrono::steady_clock::now();
 };
 
 namespace tfs::net {
 
 OutputMessage_ptr make_output_message();
-void insert_protocol_to_autosend(const Protocol_ptr& protocol);
-void remove_protocol_from_autosend(const Protocol_ptr& protocol);
+
+// the output buffer of the protocol is sent when the dispatcher finishes the current batch of tasks
+void add_pending_output(const Protocol_ptr& protocol);
+// dispatcher thread, sends every output buffer that got messages since the last call
+void flush_pending_output();
 
 } // namespace tfs::net
 
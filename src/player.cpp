@@ -710,6 +710,9 @@ void Player::setStorageValue(uint32_t key, std::optional<int32_t> value, bool is
 	}
 
 	Creature::setStorageValue(key, value, isSpawn);
+	if (!isSpawn) {
+		dirtyStorageKeys.insert(key);
+	}
 }
 
 bool Player::canSee(const Position& pos) const
@@ -1276,18 +1279,7 @@ void Player::onRemoveCreature(Creature* creature, bool isLogout)
 		}
 
 		IOLoginData::updateOnlineStatus(guid, false);
-
-		bool saved = false;
-		for (uint32_t tries = 0; tries < 3; ++tries) {
-			if (IOLoginData::savePlayer(this)) {
-				saved = true;
-				break;
-			}
-		}
-
-		if (!saved) {
-			std::cout << "Error while saving player: " << getName() << std::endl;
-		}
+		IOLoginData::savePlayer(this, nullptr, true);
 	}
 }
 
@@ -3353,11 +3345,7 @@ void Player::removeAttackedCreature()
 
 void Player::goToFollowCreature()
 {
-	if (walkTask || !followCreature) {
-		return;
-	}
-
-	if ((OTSYS_TIME() - lastFailedFollow) < 2000) {
+	if (!willSearchFollowPath()) {
 		return;
 	}
 
@@ -3370,6 +3358,14 @@ void Player::goToFollowCreature()
 	}
 }
 
+bool Player::willSearchFollowPath() const
+{
+	if (walkTask || !followCreature) {
+		return false;
+	}
+	return (OTSYS_TIME() - lastFailedFollow) >= 2000;
+}
+
 void Player::getPathSearchParams(const Creature* creature, FindPathParams& fpp) const
 {
 	Creature::getPathSearchParams(creature, fpp);
@@ -415,6 +415,7 @@ public:
 	// follow functions
 	void setFollowCreature(Creature* creature) override;
 	void goToFollowCreature() override;
+	bool willSearchFollowPath() const override;
 
 	// follow events
 	void onUnfollowCreature() override;
@@ -1172,6 +1173,8 @@ private:
 
 	std::unordered_set<uint32_t> attackedSet;
 	std::unordered_set<uint32_t> VIPList;
+	// storage keys changed since the last save
+	std::unordered_set<uint32_t> dirtyStorageKeys;
 
 	std::map<uint8_t, OpenContainer> openContainers;
 	std::map<uint32_t, DepotChest_ptr> depotChests;
@@ -0,0 +1,290 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "playersaver.h"
+
+#include "tasks.h"
+
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+constexpr size_t MAX_BATCH_SIZE = 100;
+constexpr uint32_t MAX_SAVE_TRIES = 3;
+
+// approximate size of a row besides its attributes
+constexpr uint64_t ITEM_ROW_SIZE = 12;
+constexpr uint64_t STORAGE_ROW_SIZE = 8;
+
+constexpr std::array<PlayerSaveItems PlayerSaveData::*, 4> ITEM_TABLES = {
+    &PlayerSaveData::items, &PlayerSaveData::depotItems, &PlayerSaveData::inboxItems,
+    &PlayerSaveData::storeInboxItems};
+
+// FNV-1a
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325;
+constexpr uint64_t FNV_PRIME = 0x100000001b3;
+
+void hashBytes(uint64_t& hash, const void* data, size_t size)
+{
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ static_cast<const uint8_t*>(data)[i]) * FNV_PRIME;
+	}
+}
+
+template <typename T>
+void hashValue(uint64_t& hash, T value)
+{
+	hashBytes(hash, &value, sizeof(value));
+}
+
+uint64_t hashRows(const std::vector<PlayerSaveItem>& rows)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	hashValue(hash, rows.size());
+	for (const PlayerSaveItem& row : rows) {
+		hashValue(hash, row.pid);
+		hashValue(hash, row.sid);
+		hashValue(hash, row.itemType);
+		hashValue(hash, row.count);
+		hashValue(hash, row.attributes.size());
+		hashBytes(hash, row.attributes.data(), row.attributes.size());
+	}
+	return hash;
+}
+
+uint64_t getRowsSize(const std::vector<PlayerSaveItem>& rows)
+{
+	uint64_t size = 0;
+	for (const PlayerSaveItem& row : rows) {
+		size += ITEM_ROW_SIZE + row.attributes.size();
+	}
+	return size;
+}
+
+} // namespace
+
+bool PlayerSaver::start()
+{
+	if (!db.connect()) {
+		return false;
+	}
+
+	ThreadHolder::start();
+	return true;
+}
+
+void PlayerSaver::threadMain()
+{
+	std::vector<PendingSave> batch;
+	batch.reserve(MAX_BATCH_SIZE);
+
+	std::unique_lock<std::mutex> lock(saveLock);
+	while (true) {
+		saveSignal.wait(lock, [this]() { return !saves.empty() || getState() == THREAD_STATE_TERMINATED; });
+		if (saves.empty()) {
+			// terminated, and everything queued is written
+			break;
+		}
+
+		const size_t count = std::min(saves.size(), MAX_BATCH_SIZE);
+		std::move(saves.begin(), saves.begin() + count, std::back_inserter(batch));
+		saves.erase(saves.begin(), saves.begin() + count);
+		lock.unlock();
+
+		writeSaves(batch);
+
+		lock.lock();
+		finishSaves(batch);
+		batch.clear();
+	}
+}
+
+void PlayerSaver::addSave(PlayerSaveData&& save, std::function<void(bool)> callback /* = nullptr*/)
+{
+	std::unique_lock<std::mutex> lock(saveLock);
+	if (getState() != THREAD_STATE_RUNNING) {
+		// nothing writes the queue anymore, write it right away once the saver thread is done with it
+		doneSignal.wait(lock, [this]() { return pendingSaves == 0; });
+
+		std::vector<PendingSave> batch;
+		batch.push_back({std::move(save), std::move(callback), Clock::now()});
+		++pendingPlayers[batch.front().data.guid];
+		++pendingSaves;
+
+		lock.unlock();
+		writeSaves(batch);
+		lock.lock();
+		finishSaves(batch);
+		return;
+	}
+
+	++pendingPlayers[save.guid];
+	++pendingSaves;
+	saves.push_back({std::move(save), std::move(callback), Clock::now()});
+	lock.unlock();
+
+	saveSignal.notify_one();
+}
+
+void PlayerSaver::writeSaves(std::vector<PendingSave>& batch)
+{
+	struct Write
+	{
+		PlayerSaveData* save;
+		ItemDigests digests = {};
+		uint64_t rowsAvoided = 0;
+		uint64_t bytesAvoided = 0;
+	};
+
+	// only the newest save of a player is written, it contains everything the older ones would have except for the
+	// storage changes, those are merged into it with the newer values taking precedence
+	std::vector<Write> writes;
+	std::unordered_map<uint32_t, PlayerSaveData*> newest;
+	for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+		auto [player, inserted] = newest.emplace(it->data.guid, &it->data);
+		if (inserted) {
+			writes.push_back({&it->data});
+		} else {
+			player->second->storage.merge(it->data.storage);
+		}
+	}
+	std::reverse(writes.begin(), writes.end());
+
+	std::vector<const PlayerSaveData*> players;
+	players.reserve(writes.size());
+	for (Write& write : writes) {
+		PlayerSaveData& save = *write.save;
+		if (auto it = failedStorage.find(save.guid); it != failedStorage.end()) {
+			save.storage.merge(it->second);
+			failedStorage.erase(it);
+		}
+
+		const auto digests = itemDigests.find(save.guid);
+		for (size_t i = 0; i < ITEM_TABLES.size(); ++i) {
+			PlayerSaveItems& items = save.*ITEM_TABLES[i];
+			write.digests[i] = hashRows(items.rows);
+			if (digests != itemDigests.end() && digests->second[i] == write.digests[i]) {
+				items.changed = false;
+				write.rowsAvoided += items.rows.size();
+				write.bytesAvoided += getRowsSize(items.rows);
+			}
+		}
+
+		const uint64_t storageAvoided = save.storageSize - std::min(save.storage.size(), save.storageSize);
+		write.rowsAvoided += storageAvoided;
+		write.bytesAvoided += storageAvoided * STORAGE_ROW_SIZE;
+
+		players.push_back(&save);
+	}
+
+	uint64_t rowsAvoided = 0;
+	uint64_t bytesAvoided = 0;
+	uint64_t failures = 0;
+
+	std::unordered_set<const PlayerSaveData*> saved;
+	std::vector<const PlayerSaveData*> written;
+	if (IOLoginData::savePlayerData(db, players, written)) {
+		saved.insert(players.begin(), players.end());
+	} else {
+		// find out which of them failed
+		for (const PlayerSaveData* save : players) {
+			std::vector<const PlayerSaveData*> writtenSave;
+			for (uint32_t tries = 0; tries < MAX_SAVE_TRIES; ++tries) {
+				if (IOLoginData::savePlayerData(db, {save}, writtenSave)) {
+					saved.insert(save);
+					written.insert(written.end(), writtenSave.begin(), writtenSave.end());
+					break;
+				}
+			}
+		}
+	}
+
+	const std::unordered_set<const PlayerSaveData*> writtenSaves(written.begin(), written.end());
+	std::unordered_set<uint32_t> failedPlayers;
+	for (Write& write : writes) {
+		if (!saved.contains(write.save)) {
+			std::cout << "Error while saving player: " << write.save->name << std::endl;
+			failedPlayers.insert(write.save->guid);
+			failedStorage[write.save->guid] = std::move(write.save->storage);
+			++failures;
+			continue;
+		}
+
+		if (writtenSaves.contains(write.save)) {
+			rowsAvoided += write.rowsAvoided;
+			bytesAvoided += write.bytesAvoided;
+		}
+
+		// digests of players that left would pile up, the first save after logging in again writes every table
+		if (write.save->loggedOut) {
+			itemDigests.erase(write.save->guid);
+		} else if (writtenSaves.contains(write.save)) {
+			itemDigests[write.save->guid] = write.digests;
+		}
+	}
+
+	// the older saves of a player went with its newest one, they share its result
+	for (PendingSave& save : batch) {
+		if (save.callback) {
+			g_dispatcher.addTask([callback = std::move(save.callback),
+			                      saved = !failedPlayers.contains(save.data.guid)]() { callback(saved); });
+		}
+	}
+
+	std::lock_guard<std::mutex> lockGuard(saveLock);
+	stats.failures += failures;
+	stats.rowsAvoided += rowsAvoided;
+	stats.bytesAvoided += bytesAvoided;
+}
+
+void PlayerSaver::finishSaves(const std::vector<PendingSave>& batch)
+{
+	const auto now = Clock::now();
+	for (const PendingSave& save : batch) {
+		auto it = pendingPlayers.find(save.data.guid);
+		if (--it->second == 0) {
+			pendingPlayers.erase(it);
+		}
+
+		const uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(now - save.queuedAt).count();
+		stats.totalLatency += latency;
+		stats.maxLatency = std::max(stats.maxLatency, latency);
+	}
+
+	pendingSaves -= batch.size();
+	stats.saves += batch.size();
+	++stats.batches;
+
+	doneSignal.notify_all();
+}
+
+void PlayerSaver::waitForPlayer(uint32_t guid)
+{
+	std::unique_lock<std::mutex> lock(saveLock);
+	doneSignal.wait(lock, [&]() { return !pendingPlayers.contains(guid); });
+}
+
+void PlayerSaver::flush()
+{
+	std::unique_lock<std::mutex> lock(saveLock);
+	doneSignal.wait(lock, [this]() { return pendingSaves == 0; });
+}
+
+void PlayerSaver::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(saveLock);
+		setState(THREAD_STATE_TERMINATED);
+	}
+	saveSignal.notify_one();
+}
+
+PlayerSaver::Stats PlayerSaver::getStats() const
+{
+	std::lock_guard<std::mutex> lockGuard(saveLock);
+	Stats result = stats;
+	result.pending = pendingSaves;
+	return result;
+}
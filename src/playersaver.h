@@ -0,0 +1,96 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PLAYERSAVER_H
+#define FS_PLAYERSAVER_H
+
+#include "database.h"
+#include "iologindata.h"
+#include "thread_holder_base.h"
+
+/**
+ * @brief Writes player saves on its own thread and database connection.
+ *
+ * Saves are snapshots taken on the dispatcher by IOLoginData::savePlayer. They are written in batches, one
+ * transaction and one multi-row INSERT per table for the whole batch. A newer save of a player supersedes the older
+ * ones still queued. Anything reading or changing the rows of a player has to wait for its pending saves first.
+ *
+ * Only what changed since the last written save goes to the database: item tables whose rows hash to the same digest
+ * as last time are skipped, and storage is written per changed key.
+ */
+class PlayerSaver : public ThreadHolder<PlayerSaver>
+{
+public:
+	struct Stats
+	{
+		uint64_t saves = 0;
+		uint64_t failures = 0;
+		uint64_t batches = 0;
+		// microseconds from queueing a save until it is written
+		uint64_t totalLatency = 0;
+		uint64_t maxLatency = 0;
+		// rows, and their approximate size, that did not have to be written because they were unchanged
+		uint64_t rowsAvoided = 0;
+		uint64_t bytesAvoided = 0;
+		size_t pending = 0;
+	};
+
+	PlayerSaver() = default;
+	// connects the saver's own database connection, the saver thread is not started if it cannot connect
+	bool start();
+	void flush();
+	void shutdown();
+
+	/**
+	 * @brief Queues a save, the callback is handed to the dispatcher with whether the save was written.
+	 */
+	void addSave(PlayerSaveData&& save, std::function<void(bool)> callback = nullptr);
+
+	/**
+	 * @brief Blocks until no save of the player is pending anymore.
+	 */
+	void waitForPlayer(uint32_t guid);
+
+	Stats getStats() const;
+
+	void threadMain();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct PendingSave
+	{
+		PlayerSaveData data;
+		std::function<void(bool)> callback;
+		Clock::time_point queuedAt;
+	};
+
+	// digests of the rows last written to player_items, player_depotitems, player_inboxitems and
+	// player_storeinboxitems
+	using ItemDigests = std::array<uint64_t, 4>;
+
+	void writeSaves(std::vector<PendingSave>& batch);
+	void finishSaves(const std::vector<PendingSave>& batch);
+
+	Database db;
+
+	// only touched by whoever writes the saves, the saver thread or addSave once it stopped, players are dropped with
+	// their logout save
+	std::unordered_map<uint32_t, ItemDigests> itemDigests;
+	// storage changes of saves that could not be written, they go with the next save of the player
+	std::unordered_map<uint32_t, std::map<uint32_t, std::optional<int32_t>>> failedStorage;
+
+	std::deque<PendingSave> saves;
+	// players with queued or in progress saves, and how many
+	std::unordered_map<uint32_t, uint32_t> pendingPlayers;
+	size_t pendingSaves = 0;
+	Stats stats;
+
+	mutable std::mutex saveLock;
+	std::condition_variable saveSignal;
+	std::condition_variable doneSignal;
+};
+
+extern PlayerSaver g_playerSaver;
+
+#endif // FS_PLAYERSAVER_H
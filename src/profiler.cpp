@@ -0,0 +1,220 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "profiler.h"
+
+#include "configmanager.h"
+#include "tools.h"
+
+namespace tfs::profiler {
+
+namespace {
+
+// in the order of Section, these are the names the metrics use too
+constexpr std::array<std::string_view, SECTIONS> SECTION_NAMES = {
+    "tick",
+    "dispatcher_task",
+    "scheduler_task",
+    "check_creatures",
+    "check_decay",
+    "lua",
+    "pathfinding",
+    "database_task",
+    "network_receive",
+    "network_send",
+    "output_flush",
+};
+
+std::array<Histogram, SECTIONS> histograms;
+std::array<Histogram, CREATURE_BUCKETS> creatureBucketHistograms;
+
+// nodes of a map never move, so the histograms handed out stay valid
+std::map<std::string, Histogram, std::less<>> luaHistograms;
+std::mutex luaLock;
+
+struct Tick
+{
+	std::chrono::steady_clock::time_point start;
+	std::array<uint64_t, SECTIONS> microseconds = {};
+	const Histogram* slowestDetail = nullptr;
+	uint64_t slowestDetailMicroseconds = 0;
+};
+
+// the tick of the calling thread, only the dispatcher has one
+thread_local Tick* currentTick = nullptr;
+
+std::string_view getLuaName(const Histogram* histogram)
+{
+	std::lock_guard<std::mutex> lock(luaLock);
+	for (const auto& [name, luaHistogram] : luaHistograms) {
+		if (&luaHistogram == histogram) {
+			return name;
+		}
+	}
+	return "unknown";
+}
+
+void logSlowTick(const Tick& tick, uint64_t microseconds, size_t tasks)
+{
+	std::array<size_t, SECTIONS> order;
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(),
+	          [&tick](size_t lhs, size_t rhs) { return tick.microseconds[lhs] > tick.microseconds[rhs]; });
+
+	std::string breakdown;
+	for (size_t section : order) {
+		// anything below a tenth of a millisecond does not explain a slow tick
+		if (section != tfs::to_underlying(Section::TICK) && tick.microseconds[section] >= 100) {
+			breakdown += fmt::format(", {:s} {:.1f} ms", SECTION_NAMES[section], tick.microseconds[section] / 1000.0);
+		}
+	}
+
+	if (tick.slowestDetail) {
+		breakdown += fmt::format(", slowest Lua event {:s} {:.1f} ms", getLuaName(tick.slowestDetail),
+		                         tick.slowestDetailMicroseconds / 1000.0);
+	}
+
+	std::cout << fmt::format("> Slow tick: {:.1f} ms for {:d} tasks{:s}", microseconds / 1000.0, tasks, breakdown)
+	          << std::endl;
+}
+
+} // namespace
+
+uint64_t Stats::getPercentile(double share) const
+{
+	const auto rank = static_cast<uint64_t>(std::ceil(count * share));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKETS - 1; ++i) {
+		seen += buckets[i];
+		if (seen >= rank) {
+			return std::min<uint64_t>((uint64_t{1} << i) - 1, maxMicroseconds);
+		}
+	}
+	return maxMicroseconds;
+}
+
+void Histogram::add(uint64_t microseconds)
+{
+	count.fetch_add(1, std::memory_order_relaxed);
+	totalMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+	buckets[std::min<size_t>(std::bit_width(microseconds), BUCKETS - 1)].fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max = maxMicroseconds.load(std::memory_order_relaxed);
+	while (microseconds > max && !maxMicroseconds.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {
+	}
+}
+
+void Histogram::reset()
+{
+	count.store(0, std::memory_order_relaxed);
+	totalMicroseconds.store(0, std::memory_order_relaxed);
+	maxMicroseconds.store(0, std::memory_order_relaxed);
+	for (auto& bucket : buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+Stats Histogram::getStats() const
+{
+	Stats stats{
+	    .count = count.load(std::memory_order_relaxed),
+	    .totalMicroseconds = totalMicroseconds.load(std::memory_order_relaxed),
+	    .maxMicroseconds = maxMicroseconds.load(std::memory_order_relaxed),
+	};
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		stats.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+std::string_view getSectionName(Section section) { return SECTION_NAMES[tfs::to_underlying(section)]; }
+
+Histogram& getHistogram(Section section) { return histograms[tfs::to_underlying(section)]; }
+
+Histogram& getCreatureBucketHistogram(size_t bucket) { return creatureBucketHistograms[bucket]; }
+
+Histogram& getLuaHistogram(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(luaLock);
+	return luaHistograms.try_emplace(name).first->second;
+}
+
+std::vector<std::pair<std::string, Stats>> getLuaStats()
+{
+	std::vector<std::pair<std::string, Stats>> result;
+	std::lock_guard<std::mutex> lock(luaLock);
+	for (const auto& [name, histogram] : luaHistograms) {
+		if (auto stats = histogram.getStats(); stats.count != 0) {
+			result.emplace_back(name, stats);
+		}
+	}
+	return result;
+}
+
+void reset()
+{
+	for (auto& histogram : histograms) {
+		histogram.reset();
+	}
+	for (auto& histogram : creatureBucketHistograms) {
+		histogram.reset();
+	}
+
+	std::lock_guard<std::mutex> lock(luaLock);
+	for (auto& [name, histogram] : luaHistograms) {
+		histogram.reset();
+	}
+}
+
+void beginTick()
+{
+	static thread_local Tick tick;
+	if (!isEnabled()) {
+		currentTick = nullptr;
+		return;
+	}
+
+	tick = {.start = std::chrono::steady_clock::now()};
+	currentTick = &tick;
+}
+
+void endTick(size_t tasks)
+{
+	if (!currentTick) {
+		return;
+	}
+
+	const Tick& tick = *currentTick;
+	currentTick = nullptr;
+
+	const uint64_t microseconds =
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tick.start).count();
+	getHistogram(Section::TICK).add(microseconds);
+
+	const int32_t threshold = getNumber(ConfigManager::SLOW_TICK_THRESHOLD);
+	if (threshold > 0 && microseconds >= static_cast<uint64_t>(threshold) * 1000) {
+		logSlowTick(tick, microseconds, tasks);
+	}
+}
+
+void ScopedTimer::stop()
+{
+	const uint64_t microseconds =
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	getHistogram(section).add(microseconds);
+	if (detail) {
+		detail->add(microseconds);
+	}
+
+	if (currentTick) {
+		currentTick->microseconds[tfs::to_underlying(section)] += microseconds;
+		if (section == Section::LUA && detail && microseconds > currentTick->slowestDetailMicroseconds) {
+			currentTick->slowestDetail = detail;
+			currentTick->slowestDetailMicroseconds = microseconds;
+		}
+	}
+}
+
+} // namespace tfs::profiler
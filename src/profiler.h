@@ -0,0 +1,131 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PROFILER_H
+#define FS_PROFILER_H
+
+namespace tfs::profiler {
+
+// durations are counted in buckets of [2^(i-1), 2^i) microseconds, the last one takes everything above
+constexpr size_t BUCKETS = 24;
+
+/**
+ * @brief The parts of the server that are timed. Sections nest, a Lua event run by a creature think is counted in both.
+ */
+enum class Section : uint8_t
+{
+	// one batch of dispatcher tasks, from waking up until the output is flushed
+	TICK,
+	DISPATCHER_TASK,
+	SCHEDULER_TASK,
+	CHECK_CREATURES,
+	CHECK_DECAY,
+	LUA,
+	PATHFINDING,
+	DATABASE_TASK,
+	NETWORK_RECEIVE,
+	NETWORK_SEND,
+	OUTPUT_FLUSH,
+};
+
+constexpr size_t SECTIONS = 11;
+
+// the think buckets of Game::checkCreatures, EVENT_CREATURECOUNT
+constexpr size_t CREATURE_BUCKETS = 10;
+
+struct Stats
+{
+	uint64_t count = 0;
+	uint64_t totalMicroseconds = 0;
+	uint64_t maxMicroseconds = 0;
+	std::array<uint64_t, BUCKETS> buckets = {};
+
+	// upper bound, in microseconds, of the bucket that holds the given share of the samples
+	uint64_t getPercentile(double share) const;
+};
+
+class Histogram
+{
+public:
+	void add(uint64_t microseconds);
+	void reset();
+
+	Stats getStats() const;
+
+private:
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> totalMicroseconds{0};
+	std::atomic<uint64_t> maxMicroseconds{0};
+	std::array<std::atomic<uint64_t>, BUCKETS> buckets = {};
+};
+
+inline std::atomic<bool> enabled{true};
+
+inline bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+inline void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+
+std::string_view getSectionName(Section section);
+
+Histogram& getHistogram(Section section);
+
+/**
+ * @brief The histogram of a Lua event, named after its script and event.
+ *
+ * Created on first use and kept across script reloads, so the same event keeps adding to it.
+ */
+Histogram& getLuaHistogram(const std::string& name);
+
+// every Lua event that ran at least once, sorted by name
+std::vector<std::pair<std::string, Stats>> getLuaStats();
+
+// the passes over one creature think bucket, compared to the others they show how well the buckets are balanced
+Histogram& getCreatureBucketHistogram(size_t bucket);
+
+void reset();
+
+/**
+ * @brief Marks a tick of the calling thread, the dispatcher.
+ *
+ * Sections timed on this thread between the two calls are summed up, and a tick slower than slowTickThreshold is
+ * logged with that breakdown and its slowest Lua event.
+ */
+void beginTick();
+void endTick(size_t tasks);
+
+/**
+ * @brief Times its scope into the histogram of a section, and into a second one for details like the Lua event.
+ */
+class ScopedTimer
+{
+public:
+	explicit ScopedTimer(Section section, Histogram* detail = nullptr) :
+	    section(section), detail(detail), running(isEnabled())
+	{
+		if (running) {
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	~ScopedTimer()
+	{
+		if (running) {
+			stop();
+		}
+	}
+
+	// non-copyable
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+	void stop();
+
+	Section section;
+	Histogram* detail;
+	bool running;
+	std::chrono::steady_clock::time_point start;
+};
+
+} // namespace tfs::profiler
+
+#endif // FS_PROFILER_H
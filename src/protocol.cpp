@@ -5,6 +5,7 @@
 
 #include "protocol.h"
 
+#include "compression.h"
 #include "outputmessage.h"
 #include "rsa.h"
 #include "xtea.h"
@@ -43,16 +44,6 @@ bool XTEA_decrypt(NetworkMessage& msg, const xtea::round_keys& key)
 
 } // namespace
 
-Protocol::~Protocol()
-{
-	const auto zlibEndResult = deflateEnd(&zstream);
-	if (zlibEndResult == Z_DATA_ERROR) {
-		std::cout << "ZLIB discarded pending output or unprocessed input while cleaning up stream state" << std::endl;
-	} else if (zlibEndResult == Z_STREAM_ERROR) {
-		std::cout << "ZLIB encountered an error while cleaning up stream state" << std::endl;
-	}
-}
-
 void Protocol::onSendMessage(const OutputMessage_ptr& msg)
 {
 	if (!rawMessages) {
@@ -88,6 +79,7 @@ OutputMessage_ptr Protocol::getOutputBuffer(int32_t size)
 	// dispatcher thread
 	if (!outputBuffer) {
 		outputBuffer = tfs::net::make_output_message();
+		tfs::net::add_pending_output(shared_from_this());
 	} else if ((outputBuffer->getLength() + size) > NetworkMessage::MAX_PROTOCOL_BODY_LENGTH) {
 		send(outputBuffer);
 		outputBuffer = tfs::net::make_output_message();
@@ -107,31 +99,13 @@ bool Protocol::RSA_decrypt(NetworkMessage& msg)
 
 bool Protocol::deflateMessage(OutputMessage& msg)
 {
-	static thread_local std::vector<uint8_t> buffer(NETWORKMESSAGE_MAXSIZE);
-
-	zstream.next_in = msg.getOutputBuffer();
-	zstream.avail_in = msg.getLength();
-	zstream.next_out = buffer.data();
-	zstream.avail_out = buffer.size();
-
-	const auto result = deflate(&zstream, Z_FINISH);
-	if (result != Z_OK && result != Z_STREAM_END) {
-		std::cout << "Error while deflating packet data error: " << (zstream.msg ? zstream.msg : "unknown")
-		          << std::endl;
-		return false;
-	}
-
-	const auto size = zstream.total_out;
-	deflateReset(&zstream);
-
-	if (size <= 0) {
-		std::cout << "Deflated packet data had invalid size: " << size
-		          << " error: " << (zstream.msg ? zstream.msg : "unknown") << std::endl;
+	const auto compressed = tfs::compression::deflate(msg.getOutputBuffer(), msg.getLength());
+	if (compressed.empty()) {
 		return false;
 	}
 
 	msg.reset();
-	msg.addBytes(reinterpret_cast<const char*>(buffer.data()), size);
+	msg.addBytes(compressed.data(), compressed.size());
 
 	return true;
 }
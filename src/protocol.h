@@ -7,18 +7,11 @@
 #include "connection.h"
 #include "xtea.h"
 
-#include <zlib.h>
-
 class Protocol : public std::enable_shared_from_this<Protocol>
 {
 public:
-	explicit Protocol(Connection_ptr connection) : connection(connection)
-	{
-		if (deflateInit2(&zstream, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-			std::cout << "ZLIB initialization error: " << (zstream.msg ? zstream.msg : "unknown") << std::endl;
-		}
-	}
-	virtual ~Protocol();
+	explicit Protocol(Connection_ptr connection) : connection(connection) {}
+	virtual ~Protocol() = default;
 
 	// non-copyable
 	Protocol(const Protocol&) = delete;
@@ -37,7 +30,7 @@ public:
 
 	Connection::Address getIP() const;
 
-	// Use this function for autosend messages only
+	// Use this function for autosend messages only, they are sent at the end of the dispatcher batch
 	OutputMessage_ptr getOutputBuffer(int32_t size);
 
 	OutputMessage_ptr& getCurrentBuffer() { return outputBuffer; }
@@ -74,7 +67,7 @@ protected:
 
 	static bool RSA_decrypt(NetworkMessage& msg);
 
-	bool deflateMessage(OutputMessage& msg);
+	static bool deflateMessage(OutputMessage& msg);
 
 	void setRawMessages(bool value) { rawMessages = value; }
 
@@ -91,8 +84,6 @@ private:
 	bool encryptionEnabled = false;
 	checksumMode_t checksumMode = CHECKSUM_ADLER;
 	bool rawMessages = false;
-
-	z_stream zstream{};
 };
 
 #endif // FS_PROTOCOL_H
@@ -146,7 +146,8 @@ void ProtocolGame::release()
 		player = nullptr;
 	}
 
-	tfs::net::remove_protocol_from_autosend(shared_from_this());
+	// whatever is still buffered has nobody to go to
+	getCurrentBuffer().reset();
 
 	Protocol::release();
 }
@@ -256,8 +257,6 @@ void ProtocolGame::login(uint32_t characterId, uint32_t accountId, OperatingSyst
 			connect(foundPlayer->getID(), operatingSystem);
 		}
 	}
-
-	tfs::net::insert_protocol_to_autosend(shared_from_this());
 }
 
 void ProtocolGame::connect(uint32_t playerId, OperatingSystem_t operatingSystem)
@@ -352,7 +351,7 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 	// String client version
 	if (version >= 1240) {
 		if (msg.getRemainingBufferLength() > 132) {
-			msg.getString();
+			msg.getStringView();
 		}
 	}
 
@@ -402,8 +401,8 @@ void ProtocolGame::onRecvFirstMessage(NetworkMessage& msg)
 	}
 
 	if (operatingSystem == CLIENTOS_QT_LINUX) {
-		msg.getString(); // OS name (?)
-		msg.getString(); // OS version (?)
+		msg.getStringView(); // OS name (?)
+		msg.getStringView(); // OS version (?)
 	}
 
 	auto characterName = msg.getString();
@@ -498,6 +497,12 @@ void ProtocolGame::writeToOutputBuffer(const NetworkMessage& msg)
 {
 	auto out = getOutputBuffer(msg.getLength());
 	out->append(msg);
+
+	// latency first, do not wait for the end of the dispatcher batch once there is enough to send
+	const auto threshold = getNumber(ConfigManager::OUTPUT_FLUSH_THRESHOLD);
+	if (threshold > 0 && out->getLength() >= threshold) {
+		send(std::move(getCurrentBuffer()));
+	}
 }
 
 void ProtocolGame::parsePacket(NetworkMessage& msg)
@@ -808,51 +813,78 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 
 void ProtocolGame::GetTileDescription(const Tile* tile, NetworkMessage& msg)
 {
-	int32_t count;
-	Item* ground = tile->getGround();
-	if (ground) {
-		msg.addItem(ground);
-		count = 1;
-	} else {
-		count = 0;
-	}
+	const TileDescriptionCache::Entry* cached = g_game.map.getTileDescriptionCache().get(tile);
+	if (!cached) {
+		int32_t count;
+		Item* ground = tile->getGround();
+		if (ground) {
+			msg.addItem(ground);
+			count = 1;
+		} else {
+			count = 0;
+		}
 
-	const TileItemVector* items = tile->getItemList();
-	if (items) {
-		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
-			msg.addItem(*it);
+		const TileItemVector* items = tile->getItemList();
+		if (items) {
+			for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it) {
+				msg.addItem(*it);
 
-			if (++count == MAX_STACKPOS) {
-				break;
+				if (++count == MAX_STACKPOS) {
+					break;
+				}
 			}
 		}
-	}
 
-	const CreatureVector* creatures = tile->getCreatures();
-	if (creatures) {
-		for (auto it = creatures->rbegin(), end = creatures->rend(); it != end; ++it) {
-			const Creature* creature = (*it);
-			if (!player->canSeeCreature(creature)) {
-				continue;
-			}
+		count += AddTileCreatures(msg, tile);
 
-			bool known;
-			uint32_t removedKnown;
-			checkCreatureAsKnown(creature->getID(), known, removedKnown);
-			AddCreature(msg, creature, known, removedKnown);
-			++count;
+		if (items && count < MAX_STACKPOS) {
+			for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
+				msg.addItem(*it);
+
+				if (++count == MAX_STACKPOS) {
+					return;
+				}
+			}
 		}
+		return;
 	}
 
-	if (items && count < MAX_STACKPOS) {
-		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it) {
-			msg.addItem(*it);
+	const auto* bytes = reinterpret_cast<const char*>(cached->bytes.data());
+	const uint16_t topEnd = cached->topItems > 0 ? cached->itemEnds[cached->topItems - 1] : 0;
+	// a tile with no items has no bytes, and no buffer behind them either
+	if (topEnd > 0) {
+		msg.addBytes(bytes, topEnd);
+	}
 
-			if (++count == MAX_STACKPOS) {
-				return;
-			}
+	const int32_t count = cached->topItems + AddTileCreatures(msg, tile);
+	if (count < MAX_STACKPOS && cached->items > cached->topItems) {
+		const int32_t downItems = std::min<int32_t>(cached->items - cached->topItems, MAX_STACKPOS - count);
+		const uint16_t downEnd = cached->itemEnds[cached->topItems + downItems - 1];
+		msg.addBytes(bytes + topEnd, downEnd - topEnd);
+	}
+}
+
+int32_t ProtocolGame::AddTileCreatures(NetworkMessage& msg, const Tile* tile)
+{
+	const CreatureVector* creatures = tile->getCreatures();
+	if (!creatures) {
+		return 0;
+	}
+
+	int32_t count = 0;
+	for (auto it = creatures->rbegin(), end = creatures->rend(); it != end; ++it) {
+		const Creature* creature = (*it);
+		if (!player->canSeeCreature(creature)) {
+			continue;
 		}
+
+		bool known;
+		uint32_t removedKnown;
+		checkCreatureAsKnown(creature->getID(), known, removedKnown);
+		AddCreature(msg, creature, known, removedKnown);
+		++count;
 	}
+	return count;
 }
 
 void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t width, int32_t height,
@@ -884,26 +916,23 @@ void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t wi
 void ProtocolGame::GetFloorDescription(NetworkMessage& msg, int32_t x, int32_t y, int32_t z, int32_t width,
                                        int32_t height, int32_t offset, int32_t& skip)
 {
-	for (int32_t nx = 0; nx < width; nx++) {
-		for (int32_t ny = 0; ny < height; ny++) {
-			Tile* tile = g_game.map.getTile(x + nx + offset, y + ny + offset, z);
-			if (tile) {
-				if (skip >= 0) {
-					msg.addByte(skip);
-					msg.addByte(0xFF);
-				}
-
-				skip = 0;
-				GetTileDescription(tile, msg);
-			} else if (skip == 0xFE) {
-				msg.addByte(0xFF);
+	g_game.map.forEachTile(x + offset, y + offset, z, width, height, [&](const Tile* tile) {
+		if (tile) {
+			if (skip >= 0) {
+				msg.addByte(skip);
 				msg.addByte(0xFF);
-				skip = -1;
-			} else {
-				++skip;
 			}
+
+			skip = 0;
+			GetTileDescription(tile, msg);
+		} else if (skip == 0xFE) {
+			msg.addByte(0xFF);
+			msg.addByte(0xFF);
+			skip = -1;
+		} else {
+			++skip;
 		}
-	}
+	});
 }
 
 void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& removedKnown)
@@ -1259,9 +1288,10 @@ void ProtocolGame::parseSay(NetworkMessage& msg)
 		return;
 	}
 
-	g_dispatcher.addTask([=, playerID = player->getID(), receiver = std::string{receiver}, text = std::string{text}]() {
-		g_game.playerSay(playerID, channelId, type, receiver, text);
-	});
+	g_dispatcher.addTask(
+	    [=, playerID = player->getID(), receiver = std::move(receiver), text = std::move(text)]() {
+		    g_game.playerSay(playerID, channelId, type, receiver, text);
+	    });
 }
 
 void ProtocolGame::parseFightModes(NetworkMessage& msg)
@@ -2423,29 +2453,7 @@ void ProtocolGame::sendCreatureSay(const Creature* creature, SpeakClasses type,
                                    const Position* pos /* = nullptr*/)
 {
 	NetworkMessage msg;
-	msg.addByte(0xAA);
-
-	static uint32_t statementId = 0;
-	msg.add<uint32_t>(++statementId);
-
-	msg.addString(creature->getName());
-	msg.addByte(0x00); // "(Traded)" suffix after player name
-
-	// Add level only for players
-	if (const Player* speaker = creature->getPlayer()) {
-		msg.add<uint16_t>(speaker->getLevel());
-	} else {
-		msg.add<uint16_t>(0x00);
-	}
-
-	msg.addByte(type);
-	if (pos) {
-		msg.addPosition(*pos);
-	} else {
-		msg.addPosition(creature->getPosition());
-	}
-
-	msg.addString(text);
+	AddCreatureSay(msg, creature, type, text, pos);
 	writeToOutputBuffer(msg);
 }
 
@@ -2508,10 +2516,7 @@ void ProtocolGame::sendCancelTarget()
 void ProtocolGame::sendChangeSpeed(const Creature* creature, uint32_t speed)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8F);
-	msg.add<uint32_t>(creature->getID());
-	msg.add<uint16_t>(creature->getBaseSpeed() / 2);
-	msg.add<uint16_t>(speed / 2);
+	AddChangeSpeed(msg, creature, speed);
 	writeToOutputBuffer(msg);
 }
 
@@ -2547,13 +2552,7 @@ void ProtocolGame::sendPingBack()
 void ProtocolGame::sendDistanceShoot(const Position& from, const Position& to, uint8_t type)
 {
 	NetworkMessage msg;
-	msg.addByte(0x83);
-	msg.addPosition(from);
-	msg.addByte(MAGIC_EFFECTS_CREATE_DISTANCEEFFECT);
-	msg.addByte(type);
-	msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.x) - static_cast<int32_t>(from.x))));
-	msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.y) - static_cast<int32_t>(from.y))));
-	msg.addByte(MAGIC_EFFECTS_END_LOOP);
+	AddDistanceShoot(msg, from, to, type);
 	writeToOutputBuffer(msg);
 }
 
@@ -2564,26 +2563,14 @@ void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type)
 	}
 
 	NetworkMessage msg;
-	msg.addByte(0x83);
-	msg.addPosition(pos);
-	msg.addByte(MAGIC_EFFECTS_CREATE_EFFECT);
-	msg.addByte(type);
-	msg.addByte(MAGIC_EFFECTS_END_LOOP);
+	AddMagicEffect(msg, pos, type);
 	writeToOutputBuffer(msg);
 }
 
 void ProtocolGame::sendCreatureHealth(const Creature* creature)
 {
 	NetworkMessage msg;
-	msg.addByte(0x8C);
-	msg.add<uint32_t>(creature->getID());
-
-	if (creature->isHealthHidden()) {
-		msg.addByte(0x00);
-	} else {
-		msg.addByte(std::ceil(
-		    (static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
-	}
+	AddCreatureHealth(msg, creature);
 	writeToOutputBuffer(msg);
 }
 
@@ -3636,6 +3623,77 @@ void ProtocolGame::AddOutfit(NetworkMessage& msg, const Outfit_t& outfit)
 	}
 }
 
+// spectator messages
+void ProtocolGame::AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type)
+{
+	msg.addByte(0x83);
+	msg.addPosition(pos);
+	msg.addByte(MAGIC_EFFECTS_CREATE_EFFECT);
+	msg.addByte(type);
+	msg.addByte(MAGIC_EFFECTS_END_LOOP);
+}
+
+void ProtocolGame::AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type)
+{
+	msg.addByte(0x83);
+	msg.addPosition(from);
+	msg.addByte(MAGIC_EFFECTS_CREATE_DISTANCEEFFECT);
+	msg.addByte(type);
+	msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.x) - static_cast<int32_t>(from.x))));
+	msg.addByte(static_cast<uint8_t>(static_cast<int8_t>(static_cast<int32_t>(to.y) - static_cast<int32_t>(from.y))));
+	msg.addByte(MAGIC_EFFECTS_END_LOOP);
+}
+
+void ProtocolGame::AddCreatureHealth(NetworkMessage& msg, const Creature* creature)
+{
+	msg.addByte(0x8C);
+	msg.add<uint32_t>(creature->getID());
+
+	if (creature->isHealthHidden()) {
+		msg.addByte(0x00);
+	} else {
+		msg.addByte(std::ceil(
+		    (static_cast<double>(creature->getHealth()) / std::max<int32_t>(creature->getMaxHealth(), 1)) * 100));
+	}
+}
+
+void ProtocolGame::AddChangeSpeed(NetworkMessage& msg, const Creature* creature, uint32_t speed)
+{
+	msg.addByte(0x8F);
+	msg.add<uint32_t>(creature->getID());
+	msg.add<uint16_t>(creature->getBaseSpeed() / 2);
+	msg.add<uint16_t>(speed / 2);
+}
+
+void ProtocolGame::AddCreatureSay(NetworkMessage& msg, const Creature* creature, SpeakClasses type,
+                                  const std::string& text, const Position* pos /* = nullptr*/)
+{
+	msg.addByte(0xAA);
+
+	// one id per statement, every spectator of it gets the same one
+	static uint32_t statementId = 0;
+	msg.add<uint32_t>(++statementId);
+
+	msg.addString(creature->getName());
+	msg.addByte(0x00); // "(Traded)" suffix after player name
+
+	// Add level only for players
+	if (const Player* speaker = creature->getPlayer()) {
+		msg.add<uint16_t>(speaker->getLevel());
+	} else {
+		msg.add<uint16_t>(0x00);
+	}
+
+	msg.addByte(type);
+	if (pos) {
+		msg.addPosition(*pos);
+	} else {
+		msg.addPosition(creature->getPosition());
+	}
+
+	msg.addString(text);
+}
+
 // tile
 void ProtocolGame::RemoveTileThing(NetworkMessage& msg, const Position& pos, uint32_t stackpos)
 {
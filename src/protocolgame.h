@@ -69,6 +69,14 @@ public:
 
 	uint16_t getVersion() const { return version; }
 
+	// messages that read the same for every spectator, built once and sent to each with Player::sendNetworkMessage
+	static void AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type);
+	static void AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type);
+	static void AddCreatureHealth(NetworkMessage& msg, const Creature* creature);
+	static void AddChangeSpeed(NetworkMessage& msg, const Creature* creature, uint32_t speed);
+	static void AddCreatureSay(NetworkMessage& msg, const Creature* creature, SpeakClasses type,
+	                           const std::string& text, const Position* pos = nullptr);
+
 private:
 	ProtocolGame_ptr getThis() { return std::static_pointer_cast<ProtocolGame>(shared_from_this()); }
 	void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
@@ -282,6 +290,9 @@ private:
 	// translate a tile to client-readable format
 	void GetTileDescription(const Tile* tile, NetworkMessage& msg);
 
+	// adds the creatures on a tile the player can see, returns how many
+	int32_t AddTileCreatures(NetworkMessage& msg, const Tile* tile);
+
 	// translate a floor to client-readable format
 	void GetFloorDescription(NetworkMessage& msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height,
 	                         int32_t offset, int32_t& skip);
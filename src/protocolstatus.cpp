@@ -14,6 +14,7 @@
 extern Game g_game;
 
 std::map<Connection::Address, int64_t> ProtocolStatus::ipConnectMap;
+std::mutex ProtocolStatus::ipConnectMapLock;
 const uint64_t ProtocolStatus::start = OTSYS_TIME();
 
 enum RequestedInfo_t : uint16_t
@@ -34,15 +35,19 @@ void ProtocolStatus::onRecvFirstMessage(NetworkMessage& msg)
 
 	const auto& ip = getIP();
 
-	if (!ip.is_loopback() && ip != acceptorAddress) {
-		if (auto it = ipConnectMap.find(ip);
-		    it != ipConnectMap.end() && (OTSYS_TIME() < (it->second + getNumber(ConfigManager::STATUSQUERY_TIMEOUT)))) {
-			disconnect();
-			return;
+	{
+		std::lock_guard<std::mutex> lockGuard(ipConnectMapLock);
+		if (!ip.is_loopback() && ip != acceptorAddress) {
+			if (auto it = ipConnectMap.find(ip);
+			    it != ipConnectMap.end() &&
+			    (OTSYS_TIME() < (it->second + getNumber(ConfigManager::STATUSQUERY_TIMEOUT)))) {
+				disconnect();
+				return;
+			}
 		}
-	}
 
-	ipConnectMap[ip] = OTSYS_TIME();
+		ipConnectMap[ip] = OTSYS_TIME();
+	}
 
 	switch (msg.getByte()) {
 		// XML info protocol
@@ -37,6 +37,8 @@ public:
 
 private:
 	static std::map<Connection::Address, int64_t> ipConnectMap;
+	// status requests are parsed by every network thread
+	static std::mutex ipConnectMapLock;
 };
 
 #endif // FS_PROTOCOLSTATUS_H
@@ -5,33 +5,82 @@
 
 #include "scheduler.h"
 
+uint64_t Scheduler::getTick(std::chrono::steady_clock::time_point time) const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(time - startTime).count();
+}
+
+void Scheduler::threadMain()
+{
+	std::vector<Task*> expiredTasks;
+	std::unique_lock<std::mutex> eventLockUnique(eventLock);
+
+	while (getState() != THREAD_STATE_TERMINATED) {
+		timingWheel.advance(getTick(std::chrono::steady_clock::now()), [&](TimerNode* node) {
+			auto task = static_cast<SchedulerTask*>(node);
+			eventIdTaskMap.erase(task->getEventId());
+			expiredTasks.push_back(task);
+		});
+
+		if (!expiredTasks.empty()) {
+			// hand everything that expired in this pass to the dispatcher at once
+			eventLockUnique.unlock();
+			g_dispatcher.addTasks(expiredTasks);
+			expiredTasks.clear();
+			eventLockUnique.lock();
+		}
+
+		nextWakeupTick = timingWheel.getNextTick();
+		if (nextWakeupTick == std::numeric_limits<uint64_t>::max()) {
+			eventSignal.wait(eventLockUnique);
+		} else {
+			eventSignal.wait_until(eventLockUnique, startTime + std::chrono::milliseconds(nextWakeupTick));
+		}
+	}
+
+	// Scheduler::shutdown has been called, the remaining events will never run
+	for (auto& it : eventIdTaskMap) {
+		timingWheel.remove(it.second);
+		delete it.second;
+	}
+	eventIdTaskMap.clear();
+}
+
 uint32_t Scheduler::addEvent(SchedulerTask* task)
 {
+	// round up, an event must never run before its delay has passed
+	const uint64_t expiration = getTick(std::chrono::steady_clock::now() + std::chrono::milliseconds(1) -
+	                                    std::chrono::nanoseconds(1)) +
+	                            task->getDelay();
+
+	std::unique_lock<std::mutex> eventLockUnique(eventLock);
+
 	// check if the event has a valid id
 	if (task->getEventId() == 0) {
-		task->setEventId(++lastEventId);
+		// skip 0 on wrap around, it means "no event" everywhere
+		if (++lastEventId == 0) {
+			++lastEventId;
+		}
+		task->setEventId(lastEventId);
 	}
 
-	boost::asio::post(io_context, [this, task]() {
-		// insert the event id in the list of active events
-		auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
-		auto& timer = it.first->second;
+	// insert the event id in the list of active events
+	eventIdTaskMap.emplace(task->getEventId(), task);
+	timingWheel.insert(task, expiration);
 
-		timer.expires_after(std::chrono::milliseconds(task->getDelay()));
-		timer.async_wait([this, task](const boost::system::error_code& error) {
-			eventIdTimerMap.erase(task->getEventId());
-
-			if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
-				// the timer has been manually canceled(timer->cancel()) or Scheduler::shutdown has been called
-				delete task;
-				return;
-			}
+	// wake the scheduler up if it sleeps past the new event
+	bool do_signal = task->getExpiration() < nextWakeupTick;
+	if (do_signal) {
+		nextWakeupTick = task->getExpiration();
+	}
 
-			g_dispatcher.addTask(task);
-		});
-	});
+	const uint32_t eventId = task->getEventId();
+	eventLockUnique.unlock();
 
-	return task->getEventId();
+	if (do_signal) {
+		eventSignal.notify_one();
+	}
+	return eventId;
 }
 
 void Scheduler::stopEvent(uint32_t eventId)
@@ -40,26 +89,29 @@ void Scheduler::stopEvent(uint32_t eventId)
 		return;
 	}
 
-	boost::asio::post(io_context, [this, eventId]() {
-		// search the event id
-		auto it = eventIdTimerMap.find(eventId);
-		if (it != eventIdTimerMap.end()) {
-			it->second.cancel();
-		}
-	});
+	std::unique_lock<std::mutex> eventLockUnique(eventLock);
+
+	// search the event id
+	auto it = eventIdTaskMap.find(eventId);
+	if (it == eventIdTaskMap.end()) {
+		return;
+	}
+
+	SchedulerTask* task = it->second;
+	eventIdTaskMap.erase(it);
+	timingWheel.remove(task);
+	eventLockUnique.unlock();
+
+	delete task;
 }
 
 void Scheduler::shutdown()
 {
-	setState(THREAD_STATE_TERMINATED);
-	boost::asio::post(io_context, [this]() {
-		// cancel all active timers
-		for (auto& it : eventIdTimerMap) {
-			it.second.cancel();
-		}
-
-		io_context.stop();
-	});
+	{
+		std::lock_guard<std::mutex> lockClass(eventLock);
+		setState(THREAD_STATE_TERMINATED);
+	}
+	eventSignal.notify_one();
 }
 
 SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f) { return new SchedulerTask(delay, std::move(f)); }
@@ -6,10 +6,11 @@
 
 #include "tasks.h"
 #include "thread_holder_base.h"
+#include "timingwheel.h"
 
 static constexpr int32_t SCHEDULER_MINTICKS = 50;
 
-class SchedulerTask : public Task
+class SchedulerTask : public Task, public TimerNode
 {
 public:
 	void setEventId(uint32_t id) { eventId = id; }
@@ -18,7 +19,10 @@ public:
 	uint32_t getDelay() const { return delay; }
 
 private:
-	SchedulerTask(uint32_t delay, TaskFunc&& f) : Task(std::move(f)), delay(delay) {}
+	SchedulerTask(uint32_t delay, TaskFunc&& f) : Task(std::move(f)), delay(delay)
+	{
+		section = tfs::profiler::Section::SCHEDULER_TASK;
+	}
 
 	uint32_t eventId = 0;
 	uint32_t delay = 0;
@@ -36,13 +40,21 @@ public:
 
 	void shutdown();
 
-	void threadMain() { io_context.run(); }
+	void threadMain();
 
 private:
-	std::atomic<uint32_t> lastEventId{0};
-	std::unordered_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
-	boost::asio::io_context io_context;
-	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{io_context.get_executor()};
+	// the wheel ticks once per millisecond since the scheduler was created
+	uint64_t getTick(std::chrono::steady_clock::time_point time) const;
+
+	std::mutex eventLock;
+	std::condition_variable eventSignal;
+
+	uint32_t lastEventId = 0;
+	std::unordered_map<uint32_t, SchedulerTask*> eventIdTaskMap;
+	TimingWheel timingWheel;
+	uint64_t nextWakeupTick = std::numeric_limits<uint64_t>::max();
+
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 };
 
 extern Scheduler g_scheduler;
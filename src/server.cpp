@@ -72,15 +72,73 @@ void openAcceptor(std::weak_ptr<ServicePort> weak_service, uint16_t port)
 
 } // namespace
 
+void IoContextPool::start(size_t threads)
+{
+	if (started) {
+		return;
+	}
+
+	started = true;
+	if (threads <= 1) {
+		return;
+	}
+
+	contexts.reserve(threads);
+	workGuards.reserve(threads);
+	this->threads.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		auto& context = contexts.emplace_back(std::make_unique<boost::asio::io_context>(1));
+		workGuards.emplace_back(context->get_executor());
+		this->threads.emplace_back([&context = *context]() { context.run(); });
+	}
+}
+
+void IoContextPool::stop()
+{
+	workGuards.clear();
+	for (auto& context : contexts) {
+		context->stop();
+	}
+
+	for (auto& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+}
+
+boost::asio::io_context& IoContextPool::next()
+{
+	if (contexts.empty()) {
+		return io_context;
+	}
+	return *contexts[nextContext.fetch_add(1, std::memory_order_relaxed) % contexts.size()];
+}
+
 ServiceManager::~ServiceManager() { stop(); }
 
-void ServiceManager::die() { io_context.stop(); }
+void ServiceManager::die()
+{
+	io_context.stop();
+	connectionContexts.stop();
+}
 
 void ServiceManager::run()
 {
 	assert(!running);
 	running = true;
 	io_context.run();
+	connectionContexts.stop();
+}
+
+void ServiceManager::startConnectionContexts()
+{
+	size_t threads = std::max(getNumber(ConfigManager::NETWORK_THREADS), 0);
+	if (threads == 0) {
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	connectionContexts.start(threads);
 }
 
 void ServiceManager::stop()
@@ -130,7 +188,8 @@ void ServicePort::accept()
 		return;
 	}
 
-	auto connection = ConnectionManager::getInstance().createConnection(io_context, shared_from_this());
+	auto connection =
+	    ConnectionManager::getInstance().createConnection(connectionContexts.next(), shared_from_this());
 	acceptor->async_accept(connection->getSocket(),
 	                       [=, thisPtr = shared_from_this()](const boost::system::error_code& error) {
 		                       thisPtr->onAccept(connection, error);
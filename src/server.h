@@ -32,10 +32,44 @@ public:
 	Protocol_ptr make_protocol(const Connection_ptr& c) const override { return std::make_shared<ProtocolType>(c); }
 };
 
+/**
+ * @brief io_contexts the connections are spread over round-robin, each run by a thread of its own.
+ *
+ * Without threads every connection stays on the io_context of the acceptors. The handlers of one connection always
+ * run on the same thread either way, packets are still handed to the dispatcher from there.
+ */
+class IoContextPool
+{
+public:
+	explicit IoContextPool(boost::asio::io_context& io_context) : io_context(io_context) {}
+	~IoContextPool() { stop(); }
+
+	// non-copyable
+	IoContextPool(const IoContextPool&) = delete;
+	IoContextPool& operator=(const IoContextPool&) = delete;
+
+	void start(size_t threads);
+	void stop();
+
+	boost::asio::io_context& next();
+
+private:
+	using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+	boost::asio::io_context& io_context;
+	std::vector<std::unique_ptr<boost::asio::io_context>> contexts;
+	std::vector<WorkGuard> workGuards;
+	std::vector<std::thread> threads;
+	std::atomic<size_t> nextContext{0};
+	bool started = false;
+};
+
 class ServicePort : public std::enable_shared_from_this<ServicePort>
 {
 public:
-	explicit ServicePort(boost::asio::io_context& io_context) : io_context(io_context) {}
+	ServicePort(boost::asio::io_context& io_context, IoContextPool& connectionContexts) :
+	    io_context(io_context), connectionContexts(connectionContexts)
+	{}
 	~ServicePort();
 
 	// non-copyable
@@ -57,6 +91,7 @@ private:
 	void accept();
 
 	boost::asio::io_context& io_context;
+	IoContextPool& connectionContexts;
 	std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor;
 	std::vector<Service_ptr> services;
 
@@ -84,10 +119,12 @@ public:
 
 private:
 	void die();
+	void startConnectionContexts();
 
 	std::unordered_map<uint16_t, ServicePort_ptr> acceptors;
 
 	boost::asio::io_context io_context;
+	IoContextPool connectionContexts{io_context};
 	Signals signals{io_context};
 	boost::asio::steady_timer death_timer{io_context};
 	bool running = false;
@@ -107,7 +144,9 @@ bool ServiceManager::add(uint16_t port)
 	auto foundServicePort = acceptors.find(port);
 
 	if (foundServicePort == acceptors.end()) {
-		service_port = std::make_shared<ServicePort>(io_context);
+		startConnectionContexts();
+
+		service_port = std::make_shared<ServicePort>(io_context, connectionContexts);
 		service_port->open(port);
 		acceptors[port] = service_port;
 	} else {
@@ -7,6 +7,7 @@
 
 #include "enums.h"
 #include "game.h"
+#include "outputmessage.h"
 
 extern Game g_game;
 
@@ -30,15 +31,27 @@ void Dispatcher::threadMain()
 		tmpTaskList.swap(taskList);
 		taskLockUnique.unlock();
 
+		tfs::profiler::beginTick();
+
+		size_t tasks = 0;
 		for (Task* task : tmpTaskList) {
 			if (!task->hasExpired()) {
 				++dispatcherCycle;
+				++tasks;
 				// execute it
+				tfs::profiler::ScopedTimer timer{task->section};
 				(*task)();
 			}
 			delete task;
 		}
 		tmpTaskList.clear();
+
+		// everything the batch wrote for the clients goes out together, before waiting for more tasks
+		{
+			tfs::profiler::ScopedTimer timer{tfs::profiler::Section::OUTPUT_FLUSH};
+			tfs::net::flush_pending_output();
+		}
+		tfs::profiler::endTick(tasks);
 	}
 }
 
@@ -63,6 +76,33 @@ void Dispatcher::addTask(Task* task)
 	}
 }
 
+void Dispatcher::addTasks(const std::vector<Task*>& tasks)
+{
+	if (tasks.empty()) {
+		return;
+	}
+
+	bool do_signal = false;
+
+	taskLock.lock();
+
+	if (getState() == THREAD_STATE_RUNNING) {
+		do_signal = taskList.empty();
+		taskList.insert(taskList.end(), tasks.begin(), tasks.end());
+	} else {
+		for (Task* task : tasks) {
+			delete task;
+		}
+	}
+
+	taskLock.unlock();
+
+	// send a signal if the list was empty
+	if (do_signal) {
+		taskSignal.notify_one();
+	}
+}
+
 void Dispatcher::shutdown()
 {
 	Task* task = createTask([this]() {
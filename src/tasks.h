@@ -4,6 +4,7 @@
 #ifndef FS_TASKS_H
 #define FS_TASKS_H
 
+#include "profiler.h"
 #include "thread_holder_base.h"
 
 using TaskFunc = std::function<void(void)>;
@@ -34,11 +35,15 @@ public:
 
 protected:
 	std::chrono::system_clock::time_point expiration = SYSTEM_TIME_ZERO;
+	// what the dispatcher times it as
+	tfs::profiler::Section section = tfs::profiler::Section::DISPATCHER_TASK;
 
 private:
 	// Expiration has another meaning for scheduler tasks, then it is the time the task should be added to the
 	// dispatcher
 	TaskFunc func;
+
+	friend class Dispatcher;
 };
 
 Task* createTask(TaskFunc&& f);
@@ -53,6 +58,9 @@ public:
 
 	void addTask(uint32_t expiration, TaskFunc&& f) { addTask(new Task(expiration, std::move(f))); }
 
+	// queues a batch under a single lock, tasks run in the order they appear
+	void addTasks(const std::vector<Task*>& tasks);
+
 	void shutdown();
 
 	uint64_t getDispatcherCycle() const { return dispatcherCycle; }
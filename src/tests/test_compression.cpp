@@ -0,0 +1,85 @@
+#define BOOST_TEST_MODULE compression
+
+#include "../otpch.h"
+
+#include "../compression.h"
+
+#include <boost/test/unit_test.hpp>
+#include <zlib.h>
+
+using tfs::compression::MessageClass;
+
+namespace {
+
+// something in between the repetitive creature updates and the map descriptions the server sends
+std::vector<uint8_t> makeMessage(size_t size)
+{
+	std::vector<uint8_t> message(size);
+	uint32_t state = static_cast<uint32_t>(size);
+	for (size_t i = 0; i < size; ++i) {
+		state = state * 1664525 + 1013904223;
+		message[i] = i % 4 == 0 ? static_cast<uint8_t>(state >> 24) : static_cast<uint8_t>(i % 32);
+	}
+	return message;
+}
+
+// inflates the way the client does, raw deflate with the largest window
+std::vector<uint8_t> inflate(std::string_view compressed, size_t size)
+{
+	z_stream stream{};
+	BOOST_TEST_REQUIRE(inflateInit2(&stream, -MAX_WBITS) == Z_OK);
+
+	std::vector<uint8_t> output(size + 1);
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+	stream.avail_in = compressed.size();
+	stream.next_out = output.data();
+	stream.avail_out = output.size();
+
+	const int result = ::inflate(&stream, Z_FINISH);
+	output.resize(stream.total_out);
+	inflateEnd(&stream);
+
+	BOOST_TEST(result == Z_STREAM_END);
+	return output;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_compression_message_class)
+{
+	BOOST_TEST((tfs::compression::getMessageClass(128) == MessageClass::SMALL));
+	BOOST_TEST((tfs::compression::getMessageClass(1024) == MessageClass::SMALL));
+	BOOST_TEST((tfs::compression::getMessageClass(1025) == MessageClass::MEDIUM));
+	BOOST_TEST((tfs::compression::getMessageClass(8192) == MessageClass::MEDIUM));
+	BOOST_TEST((tfs::compression::getMessageClass(8193) == MessageClass::LARGE));
+	BOOST_TEST((tfs::compression::getMessageClass(65535) == MessageClass::LARGE));
+}
+
+BOOST_AUTO_TEST_CASE(test_compression_inflates_back)
+{
+	for (size_t size : {128, 1000, 1024, 1025, 5000, 8192, 8193, 24000, 65535}) {
+		const auto message = makeMessage(size);
+		const auto messageClass = tfs::compression::getMessageClass(size);
+		const auto before = tfs::compression::getStats(messageClass);
+
+		const auto compressed = tfs::compression::deflate(message.data(), message.size());
+		BOOST_TEST_REQUIRE(!compressed.empty(), "message of " << size << " bytes");
+		BOOST_TEST(compressed.size() < message.size());
+		BOOST_TEST(inflate(compressed, size) == message, "message of " << size << " bytes");
+
+		const auto after = tfs::compression::getStats(messageClass);
+		BOOST_TEST(after.messages == before.messages + 1);
+		BOOST_TEST(after.inputBytes == before.inputBytes + size);
+		BOOST_TEST(after.outputBytes == before.outputBytes + compressed.size());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_compression_streams_are_reset)
+{
+	// every message is inflated on its own, nothing may refer back to the message compressed before it
+	const auto message = makeMessage(3000);
+	const std::string first{tfs::compression::deflate(message.data(), message.size())};
+	const std::string second{tfs::compression::deflate(message.data(), message.size())};
+	BOOST_TEST(first == second);
+	BOOST_TEST(inflate(second, message.size()) == message);
+}
@@ -0,0 +1,50 @@
+#define BOOST_TEST_MODULE dbresult
+
+#include "../otpch.h"
+
+#include "../database.h"
+
+#include <boost/test/unit_test.hpp>
+
+using tfs::detail::parseNumber;
+
+BOOST_AUTO_TEST_CASE(test_parse_integers)
+{
+	BOOST_TEST(parseNumber<uint32_t>("4294967295") == 4294967295u);
+	BOOST_TEST(parseNumber<int32_t>("-2147483648") == -2147483648);
+	BOOST_TEST(parseNumber<uint64_t>("18446744073709551615") == 18446744073709551615ull);
+	BOOST_TEST(parseNumber<int64_t>("-42") == -42);
+	BOOST_TEST(parseNumber<uint8_t>("255") == 255);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_negative_unsigned)
+{
+	// negative values read into unsigned types wrap around
+	BOOST_TEST(parseNumber<uint32_t>("-1") == std::numeric_limits<uint32_t>::max());
+	BOOST_TEST(parseNumber<uint16_t>("-2") == std::numeric_limits<uint16_t>::max() - 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_invalid)
+{
+	BOOST_TEST(parseNumber<uint32_t>("") == 0u);
+	BOOST_TEST(parseNumber<int32_t>("abc") == 0);
+	BOOST_TEST(parseNumber<double>("") == 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_floating_point)
+{
+	BOOST_TEST(parseNumber<double>("1.5") == 1.5);
+	BOOST_TEST(parseNumber<float>("-0.25") == -0.25f);
+}
+
+BOOST_AUTO_TEST_CASE(test_parse_enum)
+{
+	enum class Value : uint16_t
+	{
+		A = 1,
+		B = 600,
+	};
+
+	BOOST_TEST((parseNumber<Value>("1") == Value::A));
+	BOOST_TEST((parseNumber<Value>("600") == Value::B));
+}
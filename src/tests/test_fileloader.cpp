@@ -0,0 +1,182 @@
+#define BOOST_TEST_MODULE fileloader
+
+#include "../otpch.h"
+
+#include "../fileloader.h"
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+namespace {
+
+constexpr OTB::Identifier identifier = {{'T', 'E', 'S', 'T'}};
+
+struct TestNode
+{
+	uint8_t type;
+	std::string props;
+	std::vector<TestNode> children;
+};
+
+void writeNode(std::string& out, const TestNode& node)
+{
+	out += static_cast<char>(OTB::Node::START);
+	out += static_cast<char>(node.type);
+	for (char byte : node.props) {
+		if (static_cast<uint8_t>(byte) >= OTB::Node::ESCAPE) {
+			out += static_cast<char>(OTB::Node::ESCAPE);
+		}
+		out += byte;
+	}
+	for (auto& child : node.children) {
+		writeNode(out, child);
+	}
+	out += static_cast<char>(OTB::Node::END);
+}
+
+class TestFile
+{
+public:
+	explicit TestFile(const TestNode& root) :
+	    path(std::filesystem::temp_directory_path() / fmt::format("tfs_test_fileloader_{:d}.otb", ++counter))
+	{
+		std::string contents{identifier.begin(), identifier.end()};
+		writeNode(contents, root);
+		std::ofstream{path, std::ios::binary} << contents;
+	}
+	~TestFile() { std::filesystem::remove(path); }
+
+	std::string getName() const { return path.string(); }
+
+private:
+	static inline int counter = 0;
+	std::filesystem::path path;
+};
+
+std::string getProps(const OTB::Loader& loader, const OTB::Node& node)
+{
+	PropStream props;
+	if (!loader.getProps(node, props)) {
+		return {};
+	}
+
+	std::string result;
+	char byte;
+	while (props.read(byte)) {
+		result += byte;
+	}
+	return result;
+}
+
+void checkTree(const OTB::Loader& loader, const OTB::Node& node, const TestNode& expected)
+{
+	BOOST_TEST(node.type == expected.type);
+	BOOST_TEST(getProps(loader, node) == expected.props);
+	BOOST_TEST_REQUIRE(node.children.size() == expected.children.size());
+	for (size_t i = 0; i < expected.children.size(); ++i) {
+		checkTree(loader, node.children[i], expected.children[i]);
+	}
+}
+
+// a root with a map data node, areas of tiles of items below it, and marker bytes in every property
+const TestNode world{
+    1,
+    "\xFF\x01\x02",
+    {{2,
+      "map\xFD",
+      {{4, "area\xFE\xFE", {{5, "tile", {{6, "item\xFF", {{6, "inner", {}}}}}}, {5, "\xFD\xFD\xFD", {}}}},
+       {4, "second", {{5, "", {}}}},
+       {12, "towns", {{13, "\xFE", {}}}}}}}};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_findmarker_finds_first_marker)
+{
+	std::string data(100, 'a');
+	for (char marker : {'\xFD', '\xFE', '\xFF'}) {
+		for (size_t position = 0; position < data.size(); ++position) {
+			std::string bytes = data;
+			bytes[position] = marker;
+			// 0xFC is just below the markers and must not be taken for one
+			if (position > 0) {
+				bytes[position - 1] = '\xFC';
+			}
+
+			for (size_t start = 0; start <= position; start += 3) {
+				auto first = OTB::findMarker(bytes.data() + start, bytes.data() + bytes.size());
+				BOOST_TEST(static_cast<size_t>(first - bytes.data()) == position);
+			}
+		}
+	}
+
+	BOOST_TEST(OTB::findMarker(data.data(), data.data() + data.size()) == data.data() + data.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_loader_parses_tree_and_unescapes_props)
+{
+	TestFile file{world};
+	OTB::Loader loader{file.getName(), identifier};
+	checkTree(loader, loader.parseTree(), world);
+}
+
+BOOST_AUTO_TEST_CASE(test_loader_parses_subtrees_lazily)
+{
+	TestFile file{world};
+	OTB::Loader loader{file.getName(), identifier};
+
+	auto& root = loader.parseTree(2);
+	BOOST_TEST_REQUIRE(root.children.size() == 1u);
+
+	auto& mapNode = root.children[0];
+	BOOST_TEST(getProps(loader, mapNode) == world.children[0].props);
+	BOOST_TEST_REQUIRE(mapNode.children.size() == world.children[0].children.size());
+	for (size_t i = 0; i < mapNode.children.size(); ++i) {
+		auto& node = mapNode.children[i];
+		auto& expected = world.children[0].children[i];
+
+		// only the node itself, its properties already end where its children start
+		BOOST_TEST(node.children.empty());
+		BOOST_TEST(getProps(loader, node) == expected.props);
+
+		checkTree(loader, loader.parseSubtree(node), expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_loader_reads_unescaped_props_in_place)
+{
+	using namespace std::string_literals;
+
+	TestFile file{{1, "root", {{2, "\x04\x00plain"s, {}}, {2, "\x04\x00\xFE\xFFok"s, {}}}}};
+	OTB::Loader loader{file.getName(), identifier};
+	auto& root = loader.parseTree();
+
+	PropStream props;
+	BOOST_TEST_REQUIRE(loader.getProps(root.children[0], props));
+	auto [plain, plainOk] = props.readString();
+	BOOST_TEST(plainOk);
+	BOOST_TEST(plain == "plai");
+	BOOST_TEST(static_cast<const void*>(plain.data()) ==
+	           static_cast<const void*>(root.children[0].propsBegin + sizeof(uint16_t)));
+
+	BOOST_TEST_REQUIRE(loader.getProps(root.children[1], props));
+	auto [escaped, escapedOk] = props.readString();
+	BOOST_TEST(escapedOk);
+	BOOST_TEST(escaped == "\xFE\xFFok");
+}
+
+BOOST_AUTO_TEST_CASE(test_loader_rejects_unterminated_nodes)
+{
+	TestNode root{1, "root", {{2, "child", {}}}};
+	std::string contents{identifier.begin(), identifier.end()};
+	writeNode(contents, root);
+	contents.pop_back();
+
+	auto path = std::filesystem::temp_directory_path() / "tfs_test_fileloader_unterminated.otb";
+	std::ofstream{path, std::ios::binary} << contents;
+
+	for (size_t depth : {size_t{0}, size_t{1}, std::numeric_limits<size_t>::max()}) {
+		OTB::Loader loader{path.string(), identifier};
+		BOOST_CHECK_THROW(loader.parseTree(depth), OTB::InvalidOTBFormat);
+	}
+	std::filesystem::remove(path);
+}
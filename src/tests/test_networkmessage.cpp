@@ -0,0 +1,52 @@
+#define BOOST_TEST_MODULE networkmessage
+
+#include "../otpch.h"
+
+#include "../networkmessage.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+// a message the way the connection hands it to the protocol, positioned at the start of the body
+void addClientString(NetworkMessage& msg, std::string_view latin1)
+{
+	msg.add<uint16_t>(latin1.size());
+	msg.addBytes(latin1.data(), latin1.size());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_get_string_view_reads_in_place)
+{
+	NetworkMessage msg;
+	addClientString(msg, "Hail King!");
+	msg.setBufferPosition(0);
+
+	const auto text = msg.getStringView();
+	BOOST_TEST(text == "Hail King!");
+	const uint8_t* body = msg.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	BOOST_TEST(reinterpret_cast<const uint8_t*>(text.data()) == body + 2);
+	BOOST_TEST(!msg.isOverrun());
+}
+
+BOOST_AUTO_TEST_CASE(test_get_string_converts_latin1)
+{
+	NetworkMessage msg;
+	addClientString(msg, "hi");
+	addClientString(msg, "\xE9p\xE9");
+	msg.setBufferPosition(0);
+
+	BOOST_TEST(msg.getString() == "hi");
+	BOOST_TEST(msg.getString() == "\xC3\xA9p\xC3\xA9");
+}
+
+BOOST_AUTO_TEST_CASE(test_get_string_view_overrun)
+{
+	NetworkMessage msg;
+	msg.add<uint16_t>(500);
+	msg.setBufferPosition(0);
+
+	BOOST_TEST(msg.getStringView().empty());
+	BOOST_TEST(msg.isOverrun());
+}
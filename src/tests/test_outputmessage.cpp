@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE outputmessage
+
+#include "../otpch.h"
+
+#include "../outputmessage.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+std::vector<uint8_t> makePayload(size_t size)
+{
+	std::vector<uint8_t> payload(size);
+	for (size_t i = 0; i < size; ++i) {
+		payload[i] = static_cast<uint8_t>(i * 31 + 7);
+	}
+	return payload;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_output_message_grows_through_classes)
+{
+	auto output = tfs::net::make_output_message();
+	const auto payload = makePayload(NetworkMessage::MAX_PROTOCOL_BODY_LENGTH);
+
+	// small writes until the message had to move to every larger class
+	for (size_t offset = 0; offset < payload.size(); offset += 100) {
+		const size_t size = std::min<size_t>(100, payload.size() - offset);
+		output->addBytes(reinterpret_cast<const char*>(payload.data() + offset), size);
+	}
+
+	BOOST_TEST(output->getLength() == payload.size());
+	BOOST_TEST(std::equal(payload.begin(), payload.end(), output->getOutputBuffer()));
+}
+
+BOOST_AUTO_TEST_CASE(test_output_message_append_grows)
+{
+	const auto payload = makePayload(5000);
+
+	NetworkMessage msg;
+	msg.addBytes(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+	auto output = tfs::net::make_output_message();
+	output->addByte(0xAB);
+	output->append(msg);
+
+	BOOST_TEST(output->getLength() == payload.size() + 1);
+	BOOST_TEST(output->getOutputBuffer()[0] == 0xAB);
+	BOOST_TEST(std::equal(payload.begin(), payload.end(), output->getOutputBuffer() + 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_output_message_headers_survive_growth)
+{
+	const auto payload = makePayload(2999);
+
+	auto output = tfs::net::make_output_message();
+	output->addBytes(reinterpret_cast<const char*>(payload.data()), payload.size());
+	// padded the way XTEA needs it, the length header goes in front of the body
+	output->addPaddingBytes(1);
+	output->writeMessageLength();
+
+	const uint8_t* buffer = output->getOutputBuffer();
+	BOOST_TEST((buffer[0] | buffer[1] << 8) == 3000);
+	BOOST_TEST(std::equal(payload.begin(), payload.end(), buffer + 2));
+}
+
+BOOST_AUTO_TEST_CASE(test_output_message_stops_at_full_class)
+{
+	auto output = tfs::net::make_output_message();
+	const auto payload = makePayload(8000);
+
+	for (int i = 0; i < 4; ++i) {
+		output->addBytes(reinterpret_cast<const char*>(payload.data()), payload.size());
+	}
+
+	// the fourth write does not fit in the largest message a client takes and is dropped, as before
+	BOOST_TEST(output->getLength() == 3 * payload.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_output_message_pool_reuses_buffers)
+{
+	const auto before = tfs::net::get_buffer_pool_stats(tfs::net::BufferClass::SMALL);
+	for (int i = 0; i < 1000; ++i) {
+		auto output = tfs::net::make_output_message();
+		output->addByte(0x01);
+	}
+	const auto after = tfs::net::get_buffer_pool_stats(tfs::net::BufferClass::SMALL);
+
+	BOOST_TEST(after.allocations - before.allocations == 1000u);
+	// the thread cache hands the same buffer out again
+	BOOST_TEST(after.misses - before.misses <= 1u);
+}
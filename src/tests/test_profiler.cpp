@@ -0,0 +1,149 @@
+#define BOOST_TEST_MODULE profiler
+
+#include "../otpch.h"
+
+#include "../luascript.h"
+#include "../profiler.h"
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+extern LuaEnvironment g_luaEnvironment;
+
+using namespace tfs::profiler;
+
+BOOST_AUTO_TEST_CASE(test_histogram_buckets)
+{
+	Histogram histogram;
+	histogram.add(0);
+	histogram.add(1);
+	histogram.add(3);
+	histogram.add(1000);
+	histogram.add(uint64_t{1} << 40);
+
+	const auto stats = histogram.getStats();
+	BOOST_TEST(stats.count == 5u);
+	BOOST_TEST(stats.totalMicroseconds == 1004 + (uint64_t{1} << 40));
+	BOOST_TEST(stats.maxMicroseconds == uint64_t{1} << 40);
+	BOOST_TEST(stats.buckets[0] == 1u);
+	BOOST_TEST(stats.buckets[1] == 1u);
+	BOOST_TEST(stats.buckets[2] == 1u);
+	// 1000 is in [512, 1024)
+	BOOST_TEST(stats.buckets[10] == 1u);
+	// everything too long for the buckets ends up in the last one
+	BOOST_TEST(stats.buckets[BUCKETS - 1] == 1u);
+
+	histogram.reset();
+	BOOST_TEST(histogram.getStats().count == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_percentiles)
+{
+	Histogram histogram;
+	for (int i = 0; i < 99; ++i) {
+		histogram.add(5);
+	}
+	histogram.add(3000);
+
+	const auto stats = histogram.getStats();
+	// the upper bound of [4, 8)
+	BOOST_TEST(stats.getPercentile(0.5) == 7u);
+	BOOST_TEST(stats.getPercentile(0.99) == 7u);
+	// never above the slowest sample
+	BOOST_TEST(stats.getPercentile(1.0) == 3000u);
+}
+
+BOOST_AUTO_TEST_CASE(test_scoped_timer)
+{
+	reset();
+	{
+		ScopedTimer timer{Section::PATHFINDING};
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+
+	const auto stats = getHistogram(Section::PATHFINDING).getStats();
+	BOOST_TEST(stats.count == 1u);
+	BOOST_TEST(stats.totalMicroseconds >= 2000u);
+}
+
+BOOST_AUTO_TEST_CASE(test_scoped_timer_disabled)
+{
+	reset();
+	setEnabled(false);
+	{
+		ScopedTimer timer{Section::PATHFINDING};
+	}
+	setEnabled(true);
+
+	BOOST_TEST(getHistogram(Section::PATHFINDING).getStats().count == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_lua_histograms)
+{
+	reset();
+	Histogram& onSay = getLuaHistogram("talkactions/position.lua:onSay");
+	BOOST_TEST(&getLuaHistogram("talkactions/position.lua:onSay") == &onSay);
+
+	{
+		ScopedTimer timer{Section::LUA, &onSay};
+	}
+	getLuaHistogram("creaturescripts/login.lua:onLogin");
+
+	// events that did not run since the reset are left out
+	const auto events = getLuaStats();
+	BOOST_TEST_REQUIRE(events.size() == 1u);
+	BOOST_TEST(events[0].first == "talkactions/position.lua:onSay");
+	BOOST_TEST(events[0].second.count == 1u);
+	BOOST_TEST(getHistogram(Section::LUA).getStats().count == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_lua_events_of_one_file)
+{
+	reset();
+
+	// two events registered by one revscript
+	const auto path = std::filesystem::temp_directory_path() / "tfs_test_profiler_events.lua";
+	std::ofstream{path} << "first = function() end\nsecond = function()\nend\n";
+
+	BOOST_TEST_REQUIRE(g_luaEnvironment.initState());
+	LuaScriptInterface scriptInterface{"test"};
+	BOOST_TEST_REQUIRE(scriptInterface.initState());
+	BOOST_TEST_REQUIRE(scriptInterface.loadFile(path.string()) == 0);
+
+	lua_State* L = scriptInterface.getLuaState();
+	std::vector<int32_t> events;
+	for (const char* name : {"first", "second"}) {
+		lua_getglobal(L, name);
+		events.push_back(scriptInterface.getEvent());
+	}
+
+	for (int32_t event : {events[0], events[1], events[1]}) {
+		BOOST_TEST_REQUIRE(tfs::lua::reserveScriptEnv());
+		tfs::lua::getScriptEnv()->setScriptId(event, &scriptInterface);
+		BOOST_TEST_REQUIRE(scriptInterface.pushFunction(event));
+		scriptInterface.callVoidFunction(0);
+	}
+	std::filesystem::remove(path);
+
+	const auto stats = getLuaStats();
+	BOOST_TEST_REQUIRE(stats.size() == 2u);
+	BOOST_TEST(stats[0].first == path.string() + ":callback:1");
+	BOOST_TEST(stats[0].second.count == 1u);
+	BOOST_TEST(stats[1].first == path.string() + ":callback:2");
+	BOOST_TEST(stats[1].second.count == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_creature_buckets)
+{
+	reset();
+	{
+		ScopedTimer timer{Section::CHECK_CREATURES, &getCreatureBucketHistogram(3)};
+	}
+
+	BOOST_TEST(getCreatureBucketHistogram(3).getStats().count == 1u);
+	BOOST_TEST(getCreatureBucketHistogram(4).getStats().count == 0u);
+	BOOST_TEST(getHistogram(Section::CHECK_CREATURES).getStats().count == 1u);
+
+	reset();
+	BOOST_TEST(getCreatureBucketHistogram(3).getStats().count == 0u);
+}
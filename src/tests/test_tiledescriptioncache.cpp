@@ -0,0 +1,301 @@
+#define BOOST_TEST_MODULE tiledescriptioncache
+
+#include "../otpch.h"
+
+#include "../creature.h"
+#include "../game.h"
+#include "../itemloader.h"
+#include "../tile.h"
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+extern Game g_game;
+
+namespace {
+
+enum : uint16_t
+{
+	GROUND = 100,
+	BORDER,
+	COINS,
+	VASE,
+	// shows its charges, its bytes change without the tile being told
+	RING,
+};
+
+struct TestNode
+{
+	uint8_t type;
+	std::string props;
+	std::vector<TestNode> children;
+};
+
+void writeNode(std::string& out, const TestNode& node)
+{
+	out += static_cast<char>(OTB::Node::START);
+	out += static_cast<char>(node.type);
+	for (char byte : node.props) {
+		if (static_cast<uint8_t>(byte) >= OTB::Node::ESCAPE) {
+			out += static_cast<char>(OTB::Node::ESCAPE);
+		}
+		out += byte;
+	}
+	for (auto& child : node.children) {
+		writeNode(out, child);
+	}
+	out += static_cast<char>(OTB::Node::END);
+}
+
+template <typename T>
+std::string bytes(T value)
+{
+	return {reinterpret_cast<const char*>(&value), sizeof(value)};
+}
+
+template <typename T>
+std::string attribute(uint8_t type, T value)
+{
+	return static_cast<char>(type) + bytes(static_cast<uint16_t>(sizeof(value))) + bytes(value);
+}
+
+TestNode itemType(itemgroup_t group, uint32_t flags, uint16_t id, std::string attributes = {})
+{
+	return {static_cast<uint8_t>(group),
+	        bytes(flags) + attribute(ITEM_ATTR_SERVERID, id) + attribute(ITEM_ATTR_CLIENTID, uint16_t(id + 1000)) +
+	            attributes,
+	        {}};
+}
+
+// the item types the tiles are made of, loaded into Item::items once
+struct ItemsFixture
+{
+	ItemsFixture()
+	{
+		if (Item::items.size() > RING) {
+			return;
+		}
+
+		TestNode root{0,
+		              bytes(uint32_t{0}) +
+		                  attribute(ROOT_ATTR_VERSION, VERSIONINFO{3, CLIENT_VERSION_LAST, 0, {}}),
+		              {itemType(ITEM_GROUP_GROUND, 0, GROUND),
+		               itemType(ITEM_GROUP_NONE, FLAG_ALWAYSONTOP, BORDER, attribute(ITEM_ATTR_TOPORDER, uint8_t{1})),
+		               itemType(ITEM_GROUP_NONE, FLAG_STACKABLE | FLAG_MOVEABLE, COINS),
+		               itemType(ITEM_GROUP_NONE, FLAG_MOVEABLE, VASE),
+		               itemType(ITEM_GROUP_NONE, FLAG_CLIENTCHARGES, RING)}};
+
+		std::string contents{"OTBI"};
+		writeNode(contents, root);
+
+		const auto path = std::filesystem::temp_directory_path() / "tfs_test_tiledescriptioncache.otb";
+		std::ofstream{path, std::ios::binary} << contents;
+		BOOST_TEST_REQUIRE(Item::items.loadFromOtb(path.string()));
+		std::filesystem::remove(path);
+	}
+};
+
+class TestCreature final : public Creature
+{
+public:
+	TestCreature() { setID(); }
+
+	const std::string& getName() const override { return name; }
+	const std::string& getNameDescription() const override { return name; }
+	std::string getDescription(int32_t) const override { return name; }
+	CreatureType_t getType() const override { return CREATURETYPE_MONSTER; }
+
+	void setID() override { id = 0x40000001; }
+	void addList() override {}
+	void removeList() override {}
+	void goToFollowCreature() override {}
+
+private:
+	std::string name = "Rat";
+};
+
+// the tiles of a test die with it, the map cache must not hand their entries to a tile allocated at the same address
+struct ForgetTile
+{
+	~ForgetTile() { g_game.map.clearTileDescription(tile); }
+
+	const Tile* tile;
+};
+
+Item* addItem(Tile& tile, uint16_t id, uint16_t count = 0)
+{
+	Item* item = Item::CreateItem(id, count);
+	tile.internalAddThing(item);
+	return item;
+}
+
+// whether the cache still had an entry for the tile, it has one afterwards either way
+bool isCached(TileDescriptionCache& cache, const Tile& tile)
+{
+	const uint64_t hits = cache.hits;
+	cache.get(&tile);
+	return cache.hits != hits;
+}
+
+// the entry of the tile against serializing the tile as it is now
+void checkDescription(TileDescriptionCache& cache, const Tile& tile)
+{
+	TileDescriptionCache fresh;
+	const TileDescriptionCache::Entry* expected = fresh.get(&tile);
+	const TileDescriptionCache::Entry* entry = cache.get(&tile);
+	BOOST_TEST_REQUIRE(expected);
+	BOOST_TEST_REQUIRE(entry);
+
+	BOOST_TEST(entry->bytes == expected->bytes);
+	BOOST_TEST(+entry->topItems == +expected->topItems);
+	BOOST_TEST_REQUIRE(+entry->items == +expected->items);
+	for (size_t i = 0; i < entry->items; ++i) {
+		BOOST_TEST(entry->itemEnds[i] == expected->itemEnds[i]);
+	}
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(test_tile_without_items_has_no_bytes, ItemsFixture)
+{
+	StaticTile tile{100, 100, 7};
+	TileDescriptionCache cache;
+
+	const TileDescriptionCache::Entry* entry = cache.get(&tile);
+	BOOST_TEST_REQUIRE(entry);
+	BOOST_TEST(entry->bytes.empty());
+	BOOST_TEST(+entry->topItems == 0);
+	BOOST_TEST(+entry->items == 0);
+	BOOST_TEST(isCached(cache, tile));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_items_are_kept_in_description_order, ItemsFixture)
+{
+	StaticTile tile{100, 100, 7};
+	addItem(tile, VASE);
+	addItem(tile, COINS, 7);
+	addItem(tile, BORDER);
+	addItem(tile, GROUND);
+	TileDescriptionCache cache;
+
+	const TileDescriptionCache::Entry* entry = cache.get(&tile);
+	BOOST_TEST_REQUIRE(entry);
+	BOOST_TEST(+entry->topItems == 2);
+	BOOST_TEST_REQUIRE(+entry->items == 4);
+
+	// client ids, the coins added last lie on top of the vase and have their count
+	const std::vector<uint8_t> expected = {
+	    (GROUND + 1000) & 0xFF, (GROUND + 1000) >> 8, (BORDER + 1000) & 0xFF, (BORDER + 1000) >> 8,
+	    (COINS + 1000) & 0xFF,  (COINS + 1000) >> 8,  7,                      (VASE + 1000) & 0xFF,
+	    (VASE + 1000) >> 8};
+	BOOST_TEST(entry->bytes == expected);
+	BOOST_TEST(entry->itemEnds[0] == 2);
+	BOOST_TEST(entry->itemEnds[1] == 4);
+	BOOST_TEST(entry->itemEnds[2] == 7);
+	BOOST_TEST(entry->itemEnds[3] == 9);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_changed_items_drop_the_entry, ItemsFixture)
+{
+	StaticTile tile{100, 100, 7};
+	ForgetTile forget{&tile};
+	addItem(tile, GROUND);
+	TileDescriptionCache& cache = g_game.map.getTileDescriptionCache();
+
+	checkDescription(cache, tile);
+	BOOST_TEST(isCached(cache, tile));
+
+	// placed while loading the map
+	Item* vase = addItem(tile, VASE);
+	BOOST_TEST(!isCached(cache, tile));
+	checkDescription(cache, tile);
+
+	// moved onto the tile
+	Item* coins = Item::CreateItem(COINS, 3);
+	tile.addThing(coins);
+	BOOST_TEST(!isCached(cache, tile));
+	checkDescription(cache, tile);
+
+	// a stack that changes its count changes its bytes
+	tile.updateThing(coins, COINS, 5);
+	BOOST_TEST(!isCached(cache, tile));
+	checkDescription(cache, tile);
+
+	tile.removeThing(vase, 1);
+	vase->decrementReferenceCounter();
+	BOOST_TEST(!isCached(cache, tile));
+	checkDescription(cache, tile);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_creatures_keep_the_entry, ItemsFixture)
+{
+	TestCreature creature;
+	StaticTile tile{100, 100, 7};
+	ForgetTile forget{&tile};
+	addItem(tile, GROUND);
+	addItem(tile, VASE);
+	TileDescriptionCache& cache = g_game.map.getTileDescriptionCache();
+	cache.get(&tile);
+
+	// creatures are added per player on top of the cached items
+	tile.internalAddThing(&creature);
+	BOOST_TEST(isCached(cache, tile));
+	checkDescription(cache, tile);
+
+	tile.removeThing(&creature, 1);
+	BOOST_TEST(isCached(cache, tile));
+	checkDescription(cache, tile);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_changed_flags_keep_the_entry, ItemsFixture)
+{
+	StaticTile tile{100, 100, 7};
+	ForgetTile forget{&tile};
+	addItem(tile, GROUND);
+	TileDescriptionCache& cache = g_game.map.getTileDescriptionCache();
+	cache.get(&tile);
+
+	// flags are not part of a description
+	tile.setFlag(TILESTATE_PROTECTIONZONE);
+	BOOST_TEST(isCached(cache, tile));
+	checkDescription(cache, tile);
+
+	tile.resetFlag(TILESTATE_PROTECTIONZONE);
+	BOOST_TEST(isCached(cache, tile));
+	checkDescription(cache, tile);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_volatile_items_are_not_cached, ItemsFixture)
+{
+	StaticTile tile{100, 100, 7};
+	addItem(tile, GROUND);
+	addItem(tile, RING);
+	TileDescriptionCache cache;
+
+	BOOST_TEST(!cache.get(&tile));
+	BOOST_TEST(!cache.get(&tile));
+	BOOST_TEST(cache.size() == 0u);
+	BOOST_TEST(cache.hits == 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_full_cache_is_dropped, ItemsFixture)
+{
+	std::vector<std::unique_ptr<StaticTile>> tiles;
+	tiles.reserve(TileDescriptionCache::MAX_ENTRIES + 1);
+	for (size_t i = 0; i <= TileDescriptionCache::MAX_ENTRIES; ++i) {
+		tiles.push_back(std::make_unique<StaticTile>(i % 1024, i / 1024, 7));
+	}
+
+	TileDescriptionCache cache;
+	for (size_t i = 0; i < TileDescriptionCache::MAX_ENTRIES; ++i) {
+		cache.get(tiles[i].get());
+	}
+	BOOST_TEST(cache.size() == TileDescriptionCache::MAX_ENTRIES);
+	BOOST_TEST(isCached(cache, *tiles.front()));
+
+	// one more starts over instead of growing
+	cache.get(tiles.back().get());
+	BOOST_TEST(cache.size() == 1u);
+	BOOST_TEST(isCached(cache, *tiles.back()));
+	BOOST_TEST(!isCached(cache, *tiles.front()));
+}
@@ -0,0 +1,163 @@
+#define BOOST_TEST_MODULE timingwheel
+
+#include "../otpch.h"
+
+#include "../timingwheel.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+struct TestTimer : TimerNode
+{
+	uint32_t id = 0;
+};
+
+std::vector<std::pair<uint64_t, uint32_t>> advanceTo(TimingWheel& wheel, uint64_t tick)
+{
+	std::vector<std::pair<uint64_t, uint32_t>> expired;
+	wheel.advance(tick, [&](TimerNode* node) {
+		expired.emplace_back(wheel.getCurrentTick(), static_cast<TestTimer*>(node)->id);
+	});
+	return expired;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(test_timingwheel_expires_on_time)
+{
+	// delays chosen around every level boundary
+	const std::vector<uint64_t> delays = {1,        2,        255,      256,      257,       16383,
+	                                      16384,    16385,    1048575,  1048576,  1048577,   67108863,
+	                                      67108864, 67108865, 300000000, 4294967295};
+
+	TimingWheel wheel{12345};
+	std::vector<TestTimer> timers(delays.size());
+	for (size_t i = 0; i < delays.size(); ++i) {
+		timers[i].id = static_cast<uint32_t>(i);
+		wheel.insert(&timers[i], 12345 + delays[i]);
+	}
+	BOOST_TEST(wheel.size() == delays.size());
+
+	auto expired = advanceTo(wheel, 12345 + 4294967295ull);
+	BOOST_TEST(wheel.empty());
+	BOOST_TEST_REQUIRE(expired.size() == delays.size());
+	for (size_t i = 0; i < delays.size(); ++i) {
+		BOOST_TEST(expired[i].first == 12345 + delays[i]);
+		BOOST_TEST(expired[i].second == i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_timingwheel_fifo_within_tick)
+{
+	TimingWheel wheel;
+	std::vector<TestTimer> timers(100);
+	for (uint32_t i = 0; i < timers.size(); ++i) {
+		timers[i].id = i;
+		wheel.insert(&timers[i], 1000);
+	}
+
+	BOOST_TEST(advanceTo(wheel, 999).empty());
+
+	auto expired = advanceTo(wheel, 1000);
+	BOOST_TEST_REQUIRE(expired.size() == timers.size());
+	for (uint32_t i = 0; i < timers.size(); ++i) {
+		BOOST_TEST(expired[i].second == i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_timingwheel_remove)
+{
+	TimingWheel wheel;
+	std::vector<TestTimer> timers(10);
+	for (uint32_t i = 0; i < timers.size(); ++i) {
+		timers[i].id = i;
+		wheel.insert(&timers[i], 100 + i * 1000);
+	}
+
+	wheel.remove(&timers[0]);
+	wheel.remove(&timers[5]);
+	wheel.remove(&timers[9]);
+	wheel.remove(&timers[9]);
+	BOOST_TEST(!timers[5].isScheduled());
+	BOOST_TEST(wheel.size() == 7);
+
+	auto expired = advanceTo(wheel, 100000);
+	BOOST_TEST(wheel.empty());
+	BOOST_TEST_REQUIRE(expired.size() == 7);
+	BOOST_TEST(expired[0].second == 1);
+	BOOST_TEST(expired[3].second == 4);
+	BOOST_TEST(expired[4].second == 6);
+}
+
+BOOST_AUTO_TEST_CASE(test_timingwheel_past_expiration)
+{
+	TimingWheel wheel{500};
+	TestTimer timer;
+	wheel.insert(&timer, 10);
+	BOOST_TEST(timer.getExpiration() == 501);
+	BOOST_TEST(wheel.getNextTick() == 501);
+
+	auto expired = advanceTo(wheel, 501);
+	BOOST_TEST(expired.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_timingwheel_next_tick)
+{
+	TimingWheel wheel;
+	BOOST_TEST(wheel.getNextTick() == std::numeric_limits<uint64_t>::max());
+
+	TestTimer timer;
+	wheel.insert(&timer, 70000);
+
+	// the timer sits in an upper level, so the next tick is the one cascading it down
+	uint64_t next = wheel.getNextTick();
+	BOOST_TEST(next <= 70000);
+	BOOST_TEST(advanceTo(wheel, next - 1).empty());
+
+	BOOST_TEST(advanceTo(wheel, 69999).empty());
+	BOOST_TEST(wheel.getNextTick() == 70000);
+	BOOST_TEST(advanceTo(wheel, 70000).size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_timingwheel_random)
+{
+	std::mt19937 generator{42};
+	TimingWheel wheel;
+	std::vector<TestTimer> timers(5000);
+	std::multimap<uint64_t, uint32_t> expected;
+
+	for (uint32_t i = 0; i < timers.size(); ++i) {
+		timers[i].id = i;
+		uint64_t expiration = 1 + std::uniform_int_distribution<uint64_t>{0, 200000}(generator);
+		wheel.insert(&timers[i], expiration);
+		expected.emplace(expiration, i);
+	}
+
+	// stop some of them half way through
+	auto expired = advanceTo(wheel, 50000);
+	for (uint32_t i = 0; i < timers.size(); i += 7) {
+		if (timers[i].isScheduled()) {
+			auto range = expected.equal_range(timers[i].getExpiration());
+			for (auto it = range.first; it != range.second; ++it) {
+				if (it->second == i) {
+					expected.erase(it);
+					break;
+				}
+			}
+			wheel.remove(&timers[i]);
+		}
+	}
+
+	auto rest = advanceTo(wheel, 300000);
+	expired.insert(expired.end(), rest.begin(), rest.end());
+	BOOST_TEST(wheel.empty());
+	BOOST_TEST_REQUIRE(expired.size() == expected.size());
+
+	auto it = expected.begin();
+	for (auto&& [tick, id] : expired) {
+		BOOST_TEST(tick == it->first);
+		BOOST_TEST(timers[id].getExpiration() == tick);
+		++it;
+	}
+}
@@ -42,3 +42,48 @@ BOOST_AUTO_TEST_CASE(test_xtea_decrypt)
 
 	BOOST_TEST(data == expected);
 }
+
+BOOST_AUTO_TEST_CASE(test_xtea_kernels_match_scalar)
+{
+	const auto key = xtea::expand_key({0x01234567, 0x89abcdef, 0xfedcba98, 0x76543210});
+
+	// lengths that leave every possible number of blocks to the scalar tail of the vector kernels
+	for (size_t blocks = 0; blocks <= 33; ++blocks) {
+		std::vector<uint8_t> plain(blocks * 8);
+		for (size_t i = 0; i < plain.size(); ++i) {
+			plain[i] = static_cast<uint8_t>(i * 31 + blocks);
+		}
+
+		auto expected = plain;
+		xtea::encrypt(xtea::kernel::scalar, expected.data(), expected.size(), key);
+
+		for (auto kernel : xtea::supported_kernels()) {
+			auto data = plain;
+			xtea::encrypt(kernel, data.data(), data.size(), key);
+			BOOST_TEST(data == expected, "encrypt, kernel " << static_cast<int>(kernel) << ", " << blocks << " blocks");
+
+			xtea::decrypt(kernel, data.data(), data.size(), key);
+			BOOST_TEST(data == plain, "decrypt, kernel " << static_cast<int>(kernel) << ", " << blocks << " blocks");
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_xtea_kernels_known_answer)
+{
+	const auto key = xtea::expand_key({0xdeadbeef, 0xdeadbeef, 0xdeadbeef, 0xdeadbeef});
+	const auto block = std::vector<uint8_t>{0xb5, 0x8c, 0xf2, 0xfa, 0xe0, 0xc0, 0x40, 0x09};
+
+	// enough copies of the block to fill the widest kernel
+	for (auto kernel : xtea::supported_kernels()) {
+		std::vector<uint8_t> data;
+		for (size_t i = 0; i < 8; ++i) {
+			data.insert(data.end(), {0xef, 0xbe, 0xad, 0xde, 0xef, 0xbe, 0xad, 0xde});
+		}
+
+		xtea::encrypt(kernel, data.data(), data.size(), key);
+		for (size_t i = 0; i < 8; ++i) {
+			BOOST_TEST(std::equal(block.begin(), block.end(), data.begin() + i * 8),
+			           "kernel " << static_cast<int>(kernel) << ", block " << i);
+		}
+	}
+}
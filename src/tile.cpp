@@ -349,6 +349,8 @@ Thing* Tile::getTopVisibleThing(const Creature* creature)
 
 void Tile::onAddTileItem(Item* item)
 {
+	g_game.map.clearTileDescription(this);
+
 	if (item->hasProperty(CONST_PROP_MOVEABLE) || item->getContainer()) {
 		auto it = g_game.browseFields.find(this);
 		if (it != g_game.browseFields.end()) {
@@ -386,6 +388,8 @@ void Tile::onAddTileItem(Item* item)
 
 void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newItem, const ItemType& newType)
 {
+	g_game.map.clearTileDescription(this);
+
 	if (newItem->hasProperty(CONST_PROP_MOVEABLE) || newItem->getContainer()) {
 		auto it = g_game.browseFields.find(this);
 		if (it != g_game.browseFields.end()) {
@@ -424,6 +428,8 @@ void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newIte
 
 void Tile::onRemoveTileItem(const SpectatorVec& spectators, const std::vector<int32_t>& oldStackPosVector, Item* item)
 {
+	g_game.map.clearTileDescription(this);
+
 	if (item->hasProperty(CONST_PROP_MOVEABLE) || item->getContainer()) {
 		auto it = g_game.browseFields.find(this);
 		if (it != g_game.browseFields.end()) {
@@ -472,6 +478,8 @@ void Tile::onRemoveTileItem(const SpectatorVec& spectators, const std::vector<in
 
 void Tile::onUpdateTile(const SpectatorVec& spectators)
 {
+	g_game.map.clearTileDescription(this);
+
 	const Position& cylinderMapPos = getPosition();
 
 	// send to clients
@@ -845,10 +853,7 @@ void Tile::addThing(int32_t, Thing* thing)
 {
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		g_game.map.clearSpectatorCache();
-		if (creature->getPlayer()) {
-			g_game.map.clearPlayersSpectatorCache();
-		}
+		g_game.map.clearSpectatorCache(getPosition(), creature->getPlayer() != nullptr);
 
 		creature->setParent(this);
 		CreatureVector* creatures = makeCreatures();
@@ -1056,10 +1061,7 @@ void Tile::removeThing(Thing* thing, uint32_t count)
 		if (creatures) {
 			auto it = std::find(creatures->begin(), creatures->end(), thing);
 			if (it != creatures->end()) {
-				g_game.map.clearSpectatorCache();
-				if (creature->getPlayer()) {
-					g_game.map.clearPlayersSpectatorCache();
-				}
+				g_game.map.clearSpectatorCache(getPosition(), creature->getPlayer() != nullptr);
 
 				creatures->erase(it);
 			}
@@ -1430,10 +1432,7 @@ void Tile::internalAddThing(uint32_t, Thing* thing)
 
 	Creature* creature = thing->getCreature();
 	if (creature) {
-		g_game.map.clearSpectatorCache();
-		if (creature->getPlayer()) {
-			g_game.map.clearPlayersSpectatorCache();
-		}
+		g_game.map.clearSpectatorCache(getPosition(), creature->getPlayer() != nullptr);
 
 		CreatureVector* creatures = makeCreatures();
 		creatures->insert(creatures->begin(), creature);
@@ -1443,6 +1442,8 @@ void Tile::internalAddThing(uint32_t, Thing* thing)
 			return;
 		}
 
+		g_game.map.clearTileDescription(this);
+
 		const ItemType& itemType = Item::items[item->getID()];
 		if (itemType.isGroundTile()) {
 			if (!ground) {
@@ -0,0 +1,123 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "timingwheel.h"
+
+void TimingWheel::insert(TimerNode* node, uint64_t expiration)
+{
+	if (node->isScheduled()) {
+		unlink(node);
+	}
+
+	// the current tick has already been processed, and the top level only spans 32 bits of delay
+	static constexpr uint64_t maxDelay = (uint64_t{1} << levelShift(LEVELS - 1)) - 1;
+	node->expiration = std::clamp(expiration, currentTick + 1, currentTick + maxDelay);
+	link(node);
+}
+
+void TimingWheel::remove(TimerNode* node)
+{
+	if (node->isScheduled()) {
+		unlink(node);
+	}
+}
+
+uint64_t TimingWheel::getNextTick() const
+{
+	uint64_t next = std::numeric_limits<uint64_t>::max();
+	if (count == 0) {
+		return next;
+	}
+
+	for (uint64_t tick = currentTick + 1; tick <= currentTick + ROOT_SIZE; ++tick) {
+		if (root[tick & ROOT_MASK].head) {
+			next = tick;
+			break;
+		}
+	}
+
+	// a slot of an upper level is due when it gets cascaded down, which happens on a multiple of its span
+	for (size_t level = 0; level < levels.size(); ++level) {
+		const uint32_t shift = levelShift(level);
+		for (uint64_t index = (currentTick >> shift) + 1; index <= (currentTick >> shift) + LEVEL_SIZE; ++index) {
+			const uint64_t tick = index << shift;
+			if (tick >= next) {
+				break;
+			}
+
+			if (levels[level][index & LEVEL_MASK].head) {
+				next = tick;
+				break;
+			}
+		}
+	}
+	return next;
+}
+
+void TimingWheel::link(TimerNode* node)
+{
+	const uint64_t expiration = node->expiration;
+	const uint64_t delta = expiration > currentTick ? expiration - currentTick : 0;
+
+	TimerSlot* slot;
+	if (delta < ROOT_SIZE) {
+		slot = &root[expiration & ROOT_MASK];
+	} else {
+		size_t level = 0;
+		while (level + 1 < levels.size() && delta >= (uint64_t{1} << levelShift(level + 1))) {
+			++level;
+		}
+		slot = &levels[level][(expiration >> levelShift(level)) & LEVEL_MASK];
+	}
+
+	node->slot = slot;
+	node->prev = slot->tail;
+	node->next = nullptr;
+	if (slot->tail) {
+		slot->tail->next = node;
+	} else {
+		slot->head = node;
+	}
+	slot->tail = node;
+	++count;
+}
+
+void TimingWheel::unlink(TimerNode* node)
+{
+	TimerSlot* slot = node->slot;
+	if (node->prev) {
+		node->prev->next = node->next;
+	} else {
+		slot->head = node->next;
+	}
+
+	if (node->next) {
+		node->next->prev = node->prev;
+	} else {
+		slot->tail = node->prev;
+	}
+
+	node->slot = nullptr;
+	node->prev = nullptr;
+	node->next = nullptr;
+	--count;
+}
+
+void TimingWheel::cascade()
+{
+	// upper levels first, so timers moved into a lower slot that is due now are cascaded again right away
+	for (size_t level = levels.size(); level-- > 0;) {
+		const uint32_t shift = levelShift(level);
+		if ((currentTick & ((uint64_t{1} << shift) - 1)) != 0) {
+			continue;
+		}
+
+		TimerSlot& slot = levels[level][(currentTick >> shift) & LEVEL_MASK];
+		while (TimerNode* node = slot.head) {
+			unlink(node);
+			link(node);
+		}
+	}
+}
@@ -0,0 +1,118 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TIMINGWHEEL_H
+#define FS_TIMINGWHEEL_H
+
+class TimingWheel;
+struct TimerSlot;
+
+/**
+ * @brief Intrusive link for objects stored in a TimingWheel. Derive from it so the wheel never allocates.
+ */
+class TimerNode
+{
+public:
+	bool isScheduled() const { return slot != nullptr; }
+	uint64_t getExpiration() const { return expiration; }
+
+private:
+	TimerSlot* slot = nullptr;
+	TimerNode* prev = nullptr;
+	TimerNode* next = nullptr;
+	uint64_t expiration = 0;
+
+	friend class TimingWheel;
+};
+
+struct TimerSlot
+{
+	TimerNode* head = nullptr;
+	TimerNode* tail = nullptr;
+};
+
+/**
+ * @brief Hierarchical timing wheel (see Varghese & Lauck, "Hashed and Hierarchical Timing Wheels").
+ *
+ * The first level has one slot per tick, every next level covers 64 slots of the level below, so five levels span
+ * the whole 32-bit delay range. Insertion and removal are O(1); a timer is moved down a level at most four times
+ * before it expires. Timers due in the same tick expire in insertion order.
+ */
+class TimingWheel
+{
+public:
+	static constexpr uint32_t ROOT_BITS = 8;
+	static constexpr uint32_t LEVEL_BITS = 6;
+	static constexpr uint32_t LEVELS = 5;
+
+	explicit TimingWheel(uint64_t tick = 0) : currentTick{tick} {}
+
+	// non-copyable, the slots hold raw links to the scheduled nodes
+	TimingWheel(const TimingWheel&) = delete;
+	TimingWheel& operator=(const TimingWheel&) = delete;
+
+	/**
+	 * @brief Schedules a node to expire at the given tick. Ticks that already passed expire on the next one.
+	 */
+	void insert(TimerNode* node, uint64_t expiration);
+
+	/**
+	 * @brief Unschedules a node, does nothing if it is not scheduled.
+	 */
+	void remove(TimerNode* node);
+
+	/**
+	 * @brief Advances the wheel up to (and including) the given tick, calling onExpire for every node that expired.
+	 * The node is already unlinked when the callback runs, so it may be destroyed or inserted again.
+	 */
+	template <typename F>
+	void advance(uint64_t tick, F&& onExpire)
+	{
+		while (currentTick < tick) {
+			// jump straight over ticks that have nothing to expire or cascade
+			uint64_t next = getNextTick();
+			if (next > tick) {
+				currentTick = tick;
+				break;
+			}
+
+			currentTick = next;
+			cascade();
+
+			TimerSlot& slot = root[currentTick & ROOT_MASK];
+			while (TimerNode* node = slot.head) {
+				unlink(node);
+				onExpire(node);
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns the first tick at which the wheel has work to do, or std::numeric_limits<uint64_t>::max() if
+	 * it is empty. It never lies before the next expiration, so it is safe to sleep until then.
+	 */
+	uint64_t getNextTick() const;
+
+	uint64_t getCurrentTick() const { return currentTick; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+private:
+	static constexpr uint64_t ROOT_SIZE = 1 << ROOT_BITS;
+	static constexpr uint64_t ROOT_MASK = ROOT_SIZE - 1;
+	static constexpr uint64_t LEVEL_SIZE = 1 << LEVEL_BITS;
+	static constexpr uint64_t LEVEL_MASK = LEVEL_SIZE - 1;
+
+	static constexpr uint32_t levelShift(size_t level) { return ROOT_BITS + LEVEL_BITS * static_cast<uint32_t>(level); }
+
+	void link(TimerNode* node);
+	void unlink(TimerNode* node);
+	void cascade();
+
+	std::array<TimerSlot, ROOT_SIZE> root = {};
+	std::array<std::array<TimerSlot, LEVEL_SIZE>, LEVELS - 1> levels = {};
+	uint64_t currentTick;
+	size_t count = 0;
+};
+
+#endif // FS_TIMINGWHEEL_H
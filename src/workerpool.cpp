@@ -0,0 +1,88 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "workerpool.h"
+
+void WorkerPool::start(size_t threads)
+{
+	stopping = false;
+	workers.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		workers.emplace_back(&WorkerPool::threadMain, this);
+	}
+}
+
+void WorkerPool::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(mutex);
+		stopping = true;
+	}
+	workSignal.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+}
+
+void WorkerPool::run(size_t count, JobFunction function, void* context)
+{
+	if (workers.empty() || count <= 1) {
+		for (size_t index = 0; index < count; ++index) {
+			function(context, index);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockGuard(mutex);
+		jobFunction = function;
+		jobContext = context;
+		jobCount = count;
+		nextIndex.store(0, std::memory_order_relaxed);
+		busyWorkers = workers.size();
+		++batch;
+	}
+	workSignal.notify_all();
+
+	work();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	doneSignal.wait(lock, [this]() { return busyWorkers == 0; });
+	jobFunction = nullptr;
+	jobContext = nullptr;
+}
+
+void WorkerPool::work()
+{
+	size_t index;
+	while ((index = nextIndex.fetch_add(1, std::memory_order_relaxed)) < jobCount) {
+		jobFunction(jobContext, index);
+	}
+}
+
+void WorkerPool::threadMain()
+{
+	uint64_t lastBatch = 0;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		workSignal.wait(lock, [&]() { return stopping || batch != lastBatch; });
+		if (stopping) {
+			break;
+		}
+
+		lastBatch = batch;
+		lock.unlock();
+
+		work();
+
+		lock.lock();
+		if (--busyWorkers == 0) {
+			doneSignal.notify_one();
+		}
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_WORKERPOOL_H
+#define FS_WORKERPOOL_H
+
+/**
+ * @brief Fixed set of threads that split a batch of independent jobs with the thread submitting it.
+ *
+ * The submitting thread blocks until the whole batch is done, so jobs may read game state owned by the dispatcher
+ * as long as they do not modify anything shared.
+ */
+class WorkerPool
+{
+public:
+	WorkerPool() = default;
+	~WorkerPool() { shutdown(); }
+
+	// non-copyable
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	void start(size_t threads);
+	void shutdown();
+
+	size_t getThreadCount() const { return workers.size(); }
+
+	/**
+	 * @brief Calls job(index) for every index in [0, count), returns once every call finished. Without workers the
+	 * jobs run on the calling thread.
+	 */
+	template <typename F>
+	void parallelFor(size_t count, F&& job)
+	{
+		using Job = std::remove_reference_t<F>;
+		run(count, [](void* context, size_t index) { (*static_cast<Job*>(context))(index); }, std::addressof(job));
+	}
+
+private:
+	using JobFunction = void (*)(void*, size_t);
+
+	void run(size_t count, JobFunction function, void* context);
+	void work();
+	void threadMain();
+
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable workSignal;
+	std::condition_variable doneSignal;
+
+	JobFunction jobFunction = nullptr;
+	void* jobContext = nullptr;
+	size_t jobCount = 0;
+	std::atomic<size_t> nextIndex{0};
+
+	size_t busyWorkers = 0;
+	uint64_t batch = 0;
+	bool stopping = false;
+};
+
+#endif // FS_WORKERPOOL_H
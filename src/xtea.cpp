@@ -7,23 +7,22 @@
 
 #include <cstring>
 
-namespace xtea {
-
-round_keys expand_key(const key& k)
-{
-	constexpr uint32_t delta = 0x9E3779B9;
-	round_keys expanded;
+#if defined(__x86_64__) || defined(_M_X64)
+#define XTEA_X86_64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define XTEA_TARGET_AVX2
+#else
+#define XTEA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
 
-	for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < expanded.size();
-	     i += 2, sum = next_sum, next_sum += delta) {
-		expanded[i] = sum + k[sum & 3];
-		expanded[i + 1] = next_sum + k[(next_sum >> 11) & 3];
-	}
+namespace xtea {
 
-	return expanded;
-}
+namespace {
 
-void encrypt(uint8_t* data, size_t length, const round_keys& k)
+void encrypt_scalar(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (auto i = 0u; i < k.size(); i += 2) {
 		for (auto it = data, last = data + length; it < last; it += 8) {
@@ -40,7 +39,7 @@ void encrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
-void decrypt(uint8_t* data, size_t length, const round_keys& k)
+void decrypt_scalar(uint8_t* data, size_t length, const round_keys& k)
 {
 	for (auto i = k.size(); i > 0; i -= 2) {
 		for (auto it = data, last = data + length; it < last; it += 8) {
@@ -57,4 +56,195 @@ void decrypt(uint8_t* data, size_t length, const round_keys& k)
 	}
 }
 
+#ifdef XTEA_X86_64
+
+// Blocks are independent, so each group of blocks runs all its rounds in registers. The halves are split into one
+// register of left and one of right halves, in whatever order the shuffles leave them, and put back the same way.
+
+__m128i mix_sse2(__m128i v) { return _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v); }
+
+void encrypt_sse2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{31};
+	for (size_t offset = 0; offset < vectorLength; offset += 32) {
+		const auto a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset)));
+		const auto b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset + 16)));
+		auto left = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		auto right = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (size_t i = 0; i < k.size(); i += 2) {
+			left = _mm_add_epi32(left, _mm_xor_si128(mix_sse2(right), _mm_set1_epi32(k[i])));
+			right = _mm_add_epi32(right, _mm_xor_si128(mix_sse2(left), _mm_set1_epi32(k[i + 1])));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), _mm_unpacklo_epi32(left, right));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset + 16), _mm_unpackhi_epi32(left, right));
+	}
+	encrypt_scalar(data + vectorLength, length - vectorLength, k);
+}
+
+void decrypt_sse2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{31};
+	for (size_t offset = 0; offset < vectorLength; offset += 32) {
+		const auto a = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset)));
+		const auto b = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset + 16)));
+		auto left = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		auto right = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (size_t i = k.size(); i > 0; i -= 2) {
+			right = _mm_sub_epi32(right, _mm_xor_si128(mix_sse2(left), _mm_set1_epi32(k[i - 1])));
+			left = _mm_sub_epi32(left, _mm_xor_si128(mix_sse2(right), _mm_set1_epi32(k[i - 2])));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), _mm_unpacklo_epi32(left, right));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset + 16), _mm_unpackhi_epi32(left, right));
+	}
+	decrypt_scalar(data + vectorLength, length - vectorLength, k);
+}
+
+XTEA_TARGET_AVX2 __m256i mix_avx2(__m256i v)
+{
+	return _mm256_add_epi32(_mm256_xor_si256(_mm256_slli_epi32(v, 4), _mm256_srli_epi32(v, 5)), v);
+}
+
+XTEA_TARGET_AVX2 void encrypt_avx2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{63};
+	for (size_t offset = 0; offset < vectorLength; offset += 64) {
+		const auto a = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset)));
+		const auto b = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset + 32)));
+		auto left = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		auto right = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (size_t i = 0; i < k.size(); i += 2) {
+			left = _mm256_add_epi32(left, _mm256_xor_si256(mix_avx2(right), _mm256_set1_epi32(k[i])));
+			right = _mm256_add_epi32(right, _mm256_xor_si256(mix_avx2(left), _mm256_set1_epi32(k[i + 1])));
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset), _mm256_unpacklo_epi32(left, right));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset + 32), _mm256_unpackhi_epi32(left, right));
+	}
+	encrypt_sse2(data + vectorLength, length - vectorLength, k);
+}
+
+XTEA_TARGET_AVX2 void decrypt_avx2(uint8_t* data, size_t length, const round_keys& k)
+{
+	const size_t vectorLength = length & ~size_t{63};
+	for (size_t offset = 0; offset < vectorLength; offset += 64) {
+		const auto a = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset)));
+		const auto b = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + offset + 32)));
+		auto left = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		auto right = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		for (size_t i = k.size(); i > 0; i -= 2) {
+			right = _mm256_sub_epi32(right, _mm256_xor_si256(mix_avx2(left), _mm256_set1_epi32(k[i - 1])));
+			left = _mm256_sub_epi32(left, _mm256_xor_si256(mix_avx2(right), _mm256_set1_epi32(k[i - 2])));
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset), _mm256_unpacklo_epi32(left, right));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset + 32), _mm256_unpackhi_epi32(left, right));
+	}
+	decrypt_sse2(data + vectorLength, length - vectorLength, k);
+}
+
+bool has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// the OS has to save the ymm registers as well
+	__cpuid(info, 1);
+	constexpr int osxsave = 1 << 27;
+	constexpr int avx = 1 << 28;
+	if ((info[2] & osxsave) == 0 || (info[2] & avx) == 0 || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+kernel best_kernel()
+{
+	static const kernel best = supported_kernels().back();
+	return best;
+}
+
+} // namespace
+
+round_keys expand_key(const key& k)
+{
+	constexpr uint32_t delta = 0x9E3779B9;
+	round_keys expanded;
+
+	for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < expanded.size();
+	     i += 2, sum = next_sum, next_sum += delta) {
+		expanded[i] = sum + k[sum & 3];
+		expanded[i + 1] = next_sum + k[(next_sum >> 11) & 3];
+	}
+
+	return expanded;
+}
+
+void encrypt(uint8_t* data, size_t length, const round_keys& k) { encrypt(best_kernel(), data, length, k); }
+
+void decrypt(uint8_t* data, size_t length, const round_keys& k) { decrypt(best_kernel(), data, length, k); }
+
+std::vector<kernel> supported_kernels()
+{
+	std::vector<kernel> kernels{kernel::scalar};
+#ifdef XTEA_X86_64
+	// every x86-64 CPU has SSE2
+	kernels.push_back(kernel::sse2);
+	if (has_avx2()) {
+		kernels.push_back(kernel::avx2);
+	}
+#endif
+	return kernels;
+}
+
+void encrypt(kernel impl, uint8_t* data, size_t length, const round_keys& k)
+{
+	switch (impl) {
+#ifdef XTEA_X86_64
+		case kernel::avx2:
+			encrypt_avx2(data, length, k);
+			break;
+		case kernel::sse2:
+			encrypt_sse2(data, length, k);
+			break;
+#endif
+		default:
+			encrypt_scalar(data, length, k);
+			break;
+	}
+}
+
+void decrypt(kernel impl, uint8_t* data, size_t length, const round_keys& k)
+{
+	switch (impl) {
+#ifdef XTEA_X86_64
+		case kernel::avx2:
+			decrypt_avx2(data, length, k);
+			break;
+		case kernel::sse2:
+			decrypt_sse2(data, length, k);
+			break;
+#endif
+		default:
+			decrypt_scalar(data, length, k);
+			break;
+	}
+}
+
 } // namespace xtea
@@ -50,6 +50,33 @@ void encrypt(uint8_t* data, size_t length, const round_keys& k);
  */
 void decrypt(uint8_t* data, size_t length, const round_keys& k);
 
+/**
+ * @enum kernel
+ * @brief Implementations of encrypt and decrypt. The scalar one runs everywhere, sse2 processes 4 blocks at once and
+ * avx2 8 blocks, the remaining blocks go through the scalar one.
+ */
+enum class kernel
+{
+	scalar,
+	sse2,
+	avx2,
+};
+
+/**
+ * @brief Lists the kernels this CPU can run, the last one is the one encrypt and decrypt use.
+ */
+std::vector<kernel> supported_kernels();
+
+/**
+ * @brief Encrypts data like encrypt does, with the given kernel, which has to be supported by this CPU.
+ */
+void encrypt(kernel impl, uint8_t* data, size_t length, const round_keys& k);
+
+/**
+ * @brief Decrypts data like decrypt does, with the given kernel, which has to be supported by this CPU.
+ */
+void decrypt(kernel impl, uint8_t* data, size_t length, const round_keys& k);
+
 } // namespace xtea
 
 #endif // FS_XTEA_H